@@ -309,21 +309,6 @@ struct FunctionTable {
 
 using symbols_map_t = bela::flat_hash_map<std::string, std::vector<Function>>;
 
-struct Version {
-  std::wstring CompanyName;
-  std::wstring FileDescription;
-  std::wstring FileVersion;
-  std::wstring InternalName;
-  std::wstring LegalCopyright;
-  std::wstring OriginalFileName;
-  std::wstring ProductName;
-  std::wstring ProductVersion;
-  std::wstring Comments;
-  std::wstring LegalTrademarks;
-  std::wstring PrivateBuild;
-  std::wstring SpecialBuild;
-};
-
 struct FileInfo {
   DWORD dwSignature;        /* e.g. 0xfeef04bd */
   DWORD dwStrucVersion;     /* e.g. 0x00000042 = "0.42" */
@@ -340,6 +325,22 @@ struct FileInfo {
   DWORD dwFileDateLS;       /* e.g. 0 */
 };
 
+struct Version {
+  std::wstring CompanyName;
+  std::wstring FileDescription;
+  std::wstring FileVersion;
+  std::wstring InternalName;
+  std::wstring LegalCopyright;
+  std::wstring OriginalFileName;
+  std::wstring ProductName;
+  std::wstring ProductVersion;
+  std::wstring Comments;
+  std::wstring LegalTrademarks;
+  std::wstring PrivateBuild;
+  std::wstring SpecialBuild;
+  FileInfo Fixed{}; // VS_FIXEDFILEINFO, dwSignature is 0 when missing
+};
+
 struct DotNetMetadata {
   std::string version;
   std::string flags;
@@ -79,7 +79,7 @@ public:
     if (offset > size_) {
       return std::string_view();
     }
-    cslength = (std::min)(cslength, size_);
+    cslength = (std::min)(cslength, size_ - offset);
     auto p = data_ + offset;
     if (auto end = memchr(p, 0, cslength); end != nullptr) {
       return std::string_view(reinterpret_cast<const char *>(p), reinterpret_cast<const uint8_t *>(end) - p);
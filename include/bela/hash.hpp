@@ -3,7 +3,17 @@
 #include <cstdint>
 #include <string>
 #include <cstddef>
+#include <span>
+#include <vector>
+#include <array>
+#include <compare>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include "base.hpp"
 
+// same declarations as blake3/blake3.h, skipped when belahash sources have included it first
+#ifndef BLAKE3_H
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -48,17 +58,62 @@ void blake3_hasher_finalize_seek(const blake3_hasher *self, uint64_t seek, uint8
 #ifdef __cplusplus
 }
 #endif
+#endif
 
 namespace bela::hash {
+// HexEncode write 2 * len lower case hex digits of b to out, no terminator. vectorized with AVX2
+void HexEncode(const uint8_t *b, size_t len, char *out);
+void HexEncode(const uint8_t *b, size_t len, wchar_t *out);
+// HexDecode read 2 * len hex digits of either case from in to len bytes at out, false on a non-hex digit
+bool HexDecode(const char *in, size_t len, uint8_t *out);
+bool HexDecode(const wchar_t *in, size_t len, uint8_t *out);
+
 inline void HashEncode(const uint8_t *b, size_t len, std::wstring &hv) {
   hv.resize(len * 2);
-  auto p = hv.data();
-  constexpr char hex[] = "0123456789abcdef";
-  for (size_t i = 0; i < len; i++) {
-    uint32_t val = b[i];
-    *p++ = hex[val >> 4];
-    *p++ = hex[val & 0xf];
+  HexEncode(b, len, hv.data());
+}
+
+// Checksum fixed-size digest value, ordered and hashable: a key of phmap and std::unordered_map without allocation
+template <size_t N> struct Checksum {
+  std::array<uint8_t, N> Bytes{};
+  static constexpr size_t size() { return N; }
+  const uint8_t *data() const { return Bytes.data(); }
+  uint8_t *data() { return Bytes.data(); }
+  auto operator<=>(const Checksum &) const = default;
+  // Hex write 2 * N hex digits to out
+  template <typename CharT> void Hex(CharT *out) const { HexEncode(Bytes.data(), N, out); }
+  template <typename CharT = char> std::basic_string<CharT> Hex() const {
+    std::basic_string<CharT> s;
+    s.resize(N * 2);
+    HexEncode(Bytes.data(), N, s.data());
+    return s;
   }
+  // Parse exactly 2 * N hex digits. not a template: std::string, std::wstring and string literals convert implicitly
+  static bool Parse(std::string_view sv, Checksum &c) {
+    return sv.size() == N * 2 && HexDecode(sv.data(), N, c.Bytes.data());
+  }
+  static bool Parse(std::wstring_view sv, Checksum &c) {
+    return sv.size() == N * 2 && HexDecode(sv.data(), N, c.Bytes.data());
+  }
+  // hash_value used by phmap::Hash, digests are uniformly distributed so the first bytes are enough
+  friend size_t hash_value(const Checksum &c) {
+    size_t h = 0;
+    std::memcpy(&h, c.Bytes.data(), (std::min)(sizeof(h), N));
+    return h;
+  }
+};
+using SHA224Checksum = Checksum<28>;
+using SHA256Checksum = Checksum<32>;
+using SHA384Checksum = Checksum<48>;
+using SHA512Checksum = Checksum<64>;
+using BLAKE3Checksum = Checksum<BLAKE3_OUT_LEN>;
+using SM3Checksum = Checksum<32>;
+
+// Sum finalize h to a Checksum, N must be the digest size of h
+template <size_t N, typename Hasher> Checksum<N> Sum(Hasher &h) {
+  Checksum<N> c;
+  h.Finalize(c.Bytes.data(), N);
+  return c;
 }
 
 namespace sha256 {
@@ -75,6 +130,10 @@ struct Hasher {
   void Initialize(HashBits hb_ = HashBits::SHA256);
   void Update(const void *input, size_t input_len);
   void Finalize(uint8_t *out, size_t out_len);
+  // MarshalBinary versioned little endian snapshot of the running state, see UnmarshalBinary. call before Finalize
+  std::vector<uint8_t> MarshalBinary() const;
+  // UnmarshalBinary restore a state from MarshalBinary, Update continues where the snapshot was taken
+  bool UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec);
   std::wstring Finalize() {
     uint8_t buf[sha256_hash_size];
     std::wstring s;
@@ -88,6 +147,16 @@ struct Hasher {
     return s;
   }
 };
+
+// MultiHasher hash independent messages in lockstep SIMD lanes, 8 with AVX2 and 16 with AVX-512. a lane takes the
+// next message as soon as its message ends, so uneven lengths keep lanes busy. without AVX2 it loops over Hasher
+struct MultiHasher {
+  HashBits hb{HashBits::SHA256};
+  // Lanes messages hashed in parallel on this CPU
+  static size_t Lanes();
+  // Sum write the digest of messages[i] to digests[i * digest size], returns count of digests written
+  size_t Sum(std::span<const std::span<const uint8_t>> messages, std::span<uint8_t> digests) const;
+};
 } // namespace sha256
 namespace sha512 {
 constexpr auto sha512_block_size = 128;
@@ -103,6 +172,8 @@ struct Hasher {
   void Initialize(HashBits hb_ = HashBits::SHA512);
   void Update(const void *input, size_t input_len);
   void Finalize(uint8_t *out, size_t out_len);
+  std::vector<uint8_t> MarshalBinary() const;
+  bool UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec);
   std::wstring Finalize() {
     uint8_t buf[sha512_hash_size];
     std::wstring s;
@@ -116,6 +187,13 @@ struct Hasher {
     return s;
   }
 };
+
+// MultiHasher SHA-512/384 of independent messages, 4 lanes with AVX2 and 8 with AVX-512
+struct MultiHasher {
+  HashBits hb{HashBits::SHA512};
+  static size_t Lanes();
+  size_t Sum(std::span<const std::span<const uint8_t>> messages, std::span<uint8_t> digests) const;
+};
 } // namespace sha512
 
 namespace sha3 {
@@ -139,6 +217,8 @@ struct Hasher {
   void Initialize(HashBits hb_ = HashBits::SHA3256);
   void Update(const void *input, size_t input_len);
   void Finalize(uint8_t *out, size_t out_len);
+  std::vector<uint8_t> MarshalBinary() const;
+  bool UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec);
   std::wstring Finalize() {
     uint8_t buf[sha3_512_hash_size];
     std::wstring s;
@@ -165,6 +245,13 @@ struct Hasher {
     return s;
   }
 };
+
+// MultiHasher SHA-3 of independent messages, 4 lanes with AVX2, 8 with AVX-512 and 2 with ARMv8.2 SHA3
+struct MultiHasher {
+  HashBits hb{HashBits::SHA3256};
+  static size_t Lanes();
+  size_t Sum(std::span<const std::span<const uint8_t>> messages, std::span<uint8_t> digests) const;
+};
 } // namespace sha3
 
 namespace blake3 {
@@ -183,12 +270,18 @@ struct Hasher {
     blake3_hasher_init_derive_key_raw(&h, context, len);
   }
   inline void Update(const void *input, size_t input_len) { blake3_hasher_update(&h, input, input_len); }
+  // UpdateParallel same result as Update, subtrees of large inputs are hashed on up to concurrency threads (0: one
+  // per core). pays off from a few MiB per call
+  void UpdateParallel(const void *input, size_t input_len, uint32_t concurrency = 0);
   inline void Finalize(uint8_t *out, size_t out_len) { //
     blake3_hasher_finalize(&h, out, out_len);
   }
   inline void FinalizeSeek(uint64_t seek, uint8_t *out, size_t out_len) { //
     blake3_hasher_finalize_seek(&h, seek, out, out_len);
   }
+  // MarshalBinary the snapshot of a keyed hasher contains its key
+  std::vector<uint8_t> MarshalBinary() const;
+  bool UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec);
   std::wstring Finalize() {
     uint8_t buf[BLAKE3_OUT_LEN];
     Finalize(buf, sizeof(buf));
@@ -210,6 +303,8 @@ struct Hasher {
   void Initialize();
   void Update(const void *input, size_t input_len);
   void Finalize(uint8_t *out, size_t out_len);
+  std::vector<uint8_t> MarshalBinary() const;
+  bool UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec);
   std::wstring Finalize() {
     uint8_t buf[sm3_digest_length];
     Finalize(buf, sizeof(buf));
@@ -222,4 +317,8 @@ struct Hasher {
 
 } // namespace bela::hash
 
-#endif
\ No newline at end of file
+template <size_t N> struct std::hash<bela::hash::Checksum<N>> {
+  size_t operator()(const bela::hash::Checksum<N> &c) const noexcept { return hash_value(c); }
+};
+
+#endif
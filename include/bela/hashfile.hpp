@@ -0,0 +1,120 @@
+// hash files
+#ifndef BELA_HASHFILE_HPP
+#define BELA_HASHFILE_HPP
+#include <vector>
+#include <chrono>
+#include <functional>
+#include "base.hpp"
+#include "hash.hpp"
+
+namespace bela::hash {
+enum class Algorithm : uint8_t { SHA224, SHA256, SHA384, SHA512, SHA3_224, SHA3_256, SHA3_384, SHA3_512, BLAKE3, SM3 };
+// AlgorithmName display name, SHA3-256 etc
+std::wstring_view AlgorithmName(Algorithm a);
+
+struct Digest {
+  Algorithm algorithm;
+  std::wstring hex;
+};
+
+// MultiDigest digests of one stream with several algorithms, input is read once. the reader fills a ring of buffers
+// while every algorithm consumes it on its own thread, so the wall time is close to the slowest algorithm
+class MultiDigest {
+public:
+  MultiDigest(std::initializer_list<Algorithm> algorithms_) : algorithms(algorithms_) {}
+  MultiDigest(std::span<const Algorithm> algorithms_) : algorithms(algorithms_.begin(), algorithms_.end()) {}
+  MultiDigest(const MultiDigest &) = delete;
+  MultiDigest &operator=(const MultiDigest &) = delete;
+  // Sum read fd from the current position to EOF, digests are in algorithm order
+  bool Sum(HANDLE fd, std::vector<Digest> &digests, bela::error_code &ec) const;
+  bool SumFile(std::wstring_view file, std::vector<Digest> &digests, bela::error_code &ec) const;
+
+private:
+  std::vector<Algorithm> algorithms;
+};
+
+enum class ReadMode : uint8_t {
+  Auto,       // Map, Unbuffered from UnbufferedThreshold
+  Map,        // file mapping, the next window is prefetched while the current one is hashed
+  Buffered,   // overlapped double-buffered reads through the cache with sequential scan hint
+  Unbuffered, // overlapped double-buffered reads with FILE_FLAG_NO_BUFFERING, does not pollute the cache
+};
+
+struct HashFileOptions {
+  ReadMode Mode{ReadMode::Auto};
+  size_t BufferSize{4 * 1024 * 1024}; // read or window size, rounded up to 64 KiB
+  int64_t UnbufferedThreshold{1024LL * 1024 * 1024};
+};
+
+struct HashFileStats {
+  int64_t Bytes{0};
+  uint32_t Reads{0}; // reads or mapped windows
+  ReadMode Mode{ReadMode::Auto};
+  std::chrono::nanoseconds Elapsed{0};
+  double BytesPerSecond() const {
+    return Elapsed.count() == 0 ? 0 : static_cast<double>(Bytes) * 1e9 / static_cast<double>(Elapsed.count());
+  }
+};
+
+// ReadBlocks call fn on the content of file in order, blocks are only valid during the call
+bool ReadBlocks(std::wstring_view file, const HashFileOptions &opts,
+                const std::function<void(const void *data, size_t len)> &fn, HashFileStats *stats,
+                bela::error_code &ec);
+
+// HashFile feed file to an initialized hasher, h.Update receives large blocks
+template <typename Hasher>
+bool HashFile(std::wstring_view file, Hasher &h, const HashFileOptions &opts, HashFileStats *stats,
+              bela::error_code &ec) {
+  return ReadBlocks(file, opts, [&](const void *data, size_t len) { h.Update(data, len); }, stats, ec);
+}
+
+template <typename Hasher> bool HashFile(std::wstring_view file, Hasher &h, bela::error_code &ec) {
+  return HashFile(file, h, HashFileOptions{}, nullptr, ec);
+}
+
+// ChunkOptions content-defined chunk sizes, AvgSize is rounded down to a power of two
+struct ChunkOptions {
+  uint32_t MinSize{16 * 1024};
+  uint32_t AvgSize{64 * 1024};
+  uint32_t MaxSize{256 * 1024};
+};
+
+struct Chunk {
+  int64_t Offset{0};
+  uint32_t Length{0};
+  uint8_t Digest[BLAKE3_OUT_LEN];
+};
+
+// Chunker FastCDC content-defined chunking, every chunk is hashed with BLAKE3 in the same pass. a boundary only
+// depends on the 32 bytes before it, so an edit moves the boundaries around it and the chunks after it dedupe
+class Chunker {
+public:
+  bool Initialize(const ChunkOptions &opts, bela::error_code &ec);
+  // Update append the chunks completed by data
+  void Update(const void *data, size_t len, std::vector<Chunk> &chunks);
+  // Finalize append the last chunk and reset to an empty stream
+  void Finalize(std::vector<Chunk> &chunks);
+
+private:
+  void cut(std::vector<Chunk> &chunks);
+  blake3::Hasher h;
+  ChunkOptions options;
+  uint32_t maskSmall{0}; // before AvgSize, harder to match
+  uint32_t maskLarge{0}; // from AvgSize, easier to match
+  uint32_t fp{0};
+  bool fpValid{false};
+  int64_t offset{0}; // start of the current chunk
+  uint32_t length{0};
+  uint8_t history[32]; // bytes before the current Update
+};
+
+// ChunkFile chunks of file and their BLAKE3 digests
+bool ChunkFile(std::wstring_view file, const ChunkOptions &opts, std::vector<Chunk> &chunks, bela::error_code &ec);
+
+namespace blake3 {
+// HashFileParallel maps file and feeds it to h with Hasher::UpdateParallel, h may already hold a prefix
+bool HashFileParallel(std::wstring_view file, Hasher &h, uint32_t concurrency, bela::error_code &ec);
+} // namespace blake3
+} // namespace bela::hash
+
+#endif
@@ -0,0 +1,59 @@
+// BLAKE3 verified streaming, Bao outboard tree and slices
+#ifndef BELA_HASHTREE_HPP
+#define BELA_HASHTREE_HPP
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "base.hpp"
+
+namespace bela::hash::blake3 {
+constexpr size_t tree_hash_size = 32;
+// Bao encoding: 8-byte little endian content length, then the 64-byte parent nodes (left and right chaining
+// values) in pre-order. the outboard tree has no chunk data, a slice interleaves the nodes and 1 KiB chunks on the
+// paths to the requested range. the root hash is the BLAKE3 hash of the content
+
+// OutboardSize bytes of the outboard tree of length bytes of content
+uint64_t OutboardSize(uint64_t length);
+// EncodeOutboard build the outboard tree of content, root receives the BLAKE3 hash
+void EncodeOutboard(std::span<const uint8_t> content, std::vector<uint8_t> &outboard, uint8_t root[tree_hash_size]);
+// ExtractSlice slice of content[start, start + len) for SliceDecoder. the final chunk is always included, it proves
+// the length in the header
+bool ExtractSlice(std::span<const uint8_t> content, std::span<const uint8_t> outboard, uint64_t start, uint64_t len,
+                  std::vector<uint8_t> &slice, bela::error_code &ec);
+
+// SliceDecoder verify a slice from an untrusted source against the root hash as it arrives, only verified content
+// is returned. full subtrees are verified with the SIMD multi-chunk BLAKE3 kernels
+class SliceDecoder {
+public:
+  SliceDecoder(const uint8_t root[tree_hash_size], uint64_t start_, uint64_t len_);
+  // Write feed slice bytes in any pieces, verified content of the range is appended to out
+  bool Write(const void *data, size_t len, std::vector<uint8_t> &out, bela::error_code &ec);
+  // Finish the whole range has been verified
+  bool Finish(bela::error_code &ec) const;
+  // Length content length of the slice header, proven by the final chunk once Finish succeeds
+  uint64_t Length() const { return length; }
+
+private:
+  struct node {
+    uint64_t start;
+    uint64_t count;
+    uint8_t cv[tree_hash_size];
+    bool root;
+  };
+  bool step(const uint8_t *p, size_t avail, size_t &used, std::vector<uint8_t> &out, bela::error_code &ec);
+  bool run(const uint8_t *p, size_t avail, size_t &used, std::vector<uint8_t> &out, bela::error_code &ec);
+  void emit(uint64_t chunk, const uint8_t *data, size_t len, std::vector<uint8_t> &out) const;
+  std::vector<node> stack;
+  std::vector<uint8_t> pending; // start of a node split across writes
+  size_t need{0};               // bytes of the next node
+  uint8_t rootHash[tree_hash_size];
+  uint64_t start{0};
+  uint64_t end{0};
+  uint64_t length{0};
+  uint64_t first{0}; // chunks of the range
+  uint64_t last{0};
+  bool header{false};
+};
+} // namespace bela::hash::blake3
+
+#endif
@@ -179,6 +179,114 @@ private:
   bool needClosed{true};
 };
 
+// MemView read-only file mapping, data is immutable and can be shared between threads
+class MemView {
+private:
+  void Free() {
+    if (base != nullptr) {
+      UnmapViewOfFile(base);
+      base = nullptr;
+    }
+    if (hMap != nullptr) {
+      CloseHandle(hMap);
+      hMap = nullptr;
+    }
+    len = 0;
+  }
+  void MoveFrom(MemView &&o) {
+    Free();
+    hMap = o.hMap;
+    base = o.base;
+    len = o.len;
+    o.hMap = nullptr;
+    o.base = nullptr;
+    o.len = 0;
+  }
+
+public:
+  MemView() = default;
+  MemView(const MemView &) = delete;
+  MemView &operator=(const MemView &) = delete;
+  MemView(MemView &&o) { MoveFrom(std::move(o)); }
+  MemView &operator=(MemView &&o) {
+    MoveFrom(std::move(o));
+    return *this;
+  }
+  ~MemView() { Free(); }
+  // Map maps the first size bytes of fd, size == bela::SizeUnInitialized maps the whole file. fd can be closed after
+  // Map returns
+  bool Map(HANDLE fd, int64_t size, bela::error_code &ec) {
+    Free();
+    if (size == bela::SizeUnInitialized) {
+      if (size = bela::io::Size(fd, ec); size == bela::SizeUnInitialized) {
+        return false;
+      }
+    }
+    if (size == 0) {
+      // empty file cannot be mapped
+      return true;
+    }
+    if (static_cast<uint64_t>(size) > static_cast<uint64_t>(SIZE_MAX)) {
+      ec = bela::make_error_code(ErrGeneral, L"file too large to map: ", size);
+      return false;
+    }
+    LARGE_INTEGER li{.QuadPart = size};
+    if (hMap = CreateFileMappingW(fd, nullptr, PAGE_READONLY, static_cast<DWORD>(li.HighPart), li.LowPart, nullptr);
+        hMap == nullptr) {
+      ec = bela::make_system_error_code(L"CreateFileMappingW(): ");
+      return false;
+    }
+    if (base = static_cast<const uint8_t *>(MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size)));
+        base == nullptr) {
+      ec = bela::make_system_error_code(L"MapViewOfFile(): ");
+      Free();
+      return false;
+    }
+    len = static_cast<size_t>(size);
+    return true;
+  }
+  explicit operator bool() const { return base != nullptr; }
+  bool Map(std::wstring_view file, bela::error_code &ec) {
+    auto fd = CreateFileW(file.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fd == INVALID_HANDLE_VALUE) {
+      ec = bela::make_system_error_code(L"CreateFileW() ");
+      return false;
+    }
+    auto result = Map(fd, bela::SizeUnInitialized, ec);
+    CloseHandle(fd);
+    return result;
+  }
+  const uint8_t *data() const { return base; }
+  size_t size() const { return len; }
+  std::span<const uint8_t> make_const_span() const { return std::span{base, len}; }
+  auto as_bytes_view() const { return bytes_view(base, len); }
+  // ReadAt copy buffer.size() bytes starting at offset pos, same as FD::ReadAt without syscall
+  bool ReadAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const {
+    if (pos < 0 || static_cast<uint64_t>(pos) > len || buffer.size() > len - static_cast<size_t>(pos)) {
+      ec = bela::make_error_code(ErrEOF, L"unexpected EOF");
+      return false;
+    }
+    memcpy(buffer.data(), base + pos, buffer.size());
+    return true;
+  }
+
+private:
+  HANDLE hMap{nullptr};
+  const uint8_t *base{nullptr};
+  size_t len{0};
+};
+
+// ReaderAt positional reader for parsing files that are not on disk (archive members, memory dumps, network buffers).
+// ReadAt must not depend on a file position, so one reader can serve concurrent parsers
+class ReaderAt {
+public:
+  virtual ~ReaderAt() = default;
+  // ReadAt reads exactly buffer.size() bytes starting at pos, short read is an error
+  virtual bool ReadAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const = 0;
+  virtual int64_t Size() const = 0;
+};
+
 std::optional<FD> NewFile(std::wstring_view file, bela::error_code &ec);
 std::optional<FD> NewFile(std::wstring_view file, DWORD dwDesiredAccess, DWORD dwShareMode,
                           LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition,
@@ -6,6 +6,10 @@
 #include <string>
 #include <optional>
 #include <span>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <array>
 #include "base.hpp"
 #include "types.hpp"
 #include "ascii.hpp"
@@ -16,11 +20,33 @@
 #include "__windows/image.hpp"
 
 namespace bela::pe {
+// ExportSymbolView result of File::FindExport, ForwardName is a view of the export section valid as long as File
+struct ExportSymbolView {
+  std::string_view ForwardName;
+  uint32_t Address{0};
+  uint16_t Ordinal{0};
+  int Hint{-1};
+};
+
 // PE File resolve
 // https://docs.microsoft.com/en-us/windows/win32/debug/pe-format
 class File {
 private:
   bool parseFile(bela::error_code &ec);
+  // reset drop the source and everything derived from it before a File is reused
+  void reset() {
+    mv = bela::io::MemView();
+    image = bela::bytes_view();
+    reader = nullptr;
+    sectionCache.clear();
+    size = SizeUnInitialized;
+    fh = FileHeader{};
+    oh = OptionalHeader{};
+    sections.clear();
+    stringTable.buffer = bela::Buffer();
+    overlayOffset = SizeUnInitialized;
+    ohOffset = 0;
+  }
   std::string sectionFullName(SectionHeader32 &sh) const;
   const DataDirectory *getDataDirectory(uint32_t dirIndex) const {
     if (dirIndex >= DataDirEntries) {
@@ -53,7 +79,23 @@ private:
     }
     return nullptr;
   }
-  std::optional<Buffer> readSectionData(const Section &sec, bela::error_code &ec) const;
+  // readAt reads from the in-memory image, ReaderAt or fd
+  bool readAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const;
+  template <typename T>
+    requires bela::io::exclude_buffer_derived<T>
+  bool readAt(T &t, int64_t pos, bela::error_code &ec) const {
+    return readAt({reinterpret_cast<uint8_t *>(&t), sizeof(T)}, pos, ec);
+  }
+  template <typename T>
+    requires bela::io::vectorizable_derived<T>
+  bool readAt(std::vector<T> &tv, int64_t pos, bela::error_code &ec) const {
+    return readAt({reinterpret_cast<uint8_t *>(tv.data()), sizeof(T) * tv.size()}, pos, ec);
+  }
+  // readSectionData returns immutable section contents valid as long as File: a view of the in-memory image, or a
+  // section read once and cached
+  std::optional<bela::bytes_view> readSectionData(const Section &sec, bela::error_code &ec) const;
+  // readExportDirectory returns the section holding the export directory, nullptr when image has no exports or on error
+  const Section *readExportDirectory(IMAGE_EXPORT_DIRECTORY &ied, bela::bytes_view &bv, bela::error_code &ec) const;
   bool readCOFFSymbols(std::vector<COFFSymbol> &symbols, bela::error_code &ec) const;
   bool readRelocs(Section &sec) const;
   bool readStringTable(bela::error_code &ec);
@@ -85,51 +127,329 @@ public:
   int64_t OverlayLength() const { return size - overlayOffset; }
   int64_t ReadOverlay(std::span<uint8_t> overlayData, bela::error_code &ec) const;
   bool LookupExports(std::vector<ExportedSymbol> &exports, bela::error_code &ec) const;
+  // FindExport binary search the sorted export name table without building the export list. std::nullopt and empty
+  // ec: name not exported
+  std::optional<ExportSymbolView> FindExport(std::string_view name, bela::error_code &ec) const;
   bool LookupFunctionTable(FunctionTable &ft, bela::error_code &ec) const;
   bool LookupSymbols(std::vector<Symbol> &syms, bela::error_code &ec) const;
   std::optional<DotNetMetadata> LookupDotNetMetadata(bela::error_code &ec) const;
-  std::optional<Version> LookupVersion(bela::error_code &ec) const; // WIP
+  // LookupVersion decode RT_VERSION resource, does not call Win32 version API. unless the File is mapped or in memory
+  // the whole resource section is read once
+  std::optional<Version> LookupVersion(bela::error_code &ec) const;
+  // DigestWriter receives the Authenticode hashed ranges in file order
+  using DigestWriter = std::function<void(const void *data, size_t len)>;
+  // Authenticode reads the file once, computes the optional header CheckSum (as CheckSumMappedFile) and writes every
+  // byte except CheckSum, the security directory entry and the certificate table to w. w may be empty
+  bool Authenticode(const DigestWriter &w, uint32_t &checksum, bela::error_code &ec) const;
+  bool Checksum(uint32_t &checksum, bela::error_code &ec) const { return Authenticode(nullptr, checksum, ec); }
+  // AuthenticodeDigest feeds the hashed ranges to a bela::hash hasher, eg: bela::hash::sha256::Hasher
+  template <typename Hasher> bool AuthenticodeDigest(Hasher &h, uint32_t &checksum, bela::error_code &ec) const {
+    return Authenticode([&](const void *data, size_t len) { h.Update(data, len); }, checksum, ec);
+  }
   const FileHeader &Fh() const { return fh; }
   const auto &Header() const { return oh; }
   const auto &Sections() const { return sections; }
+  // SectionData returns contents of a section of this File, valid as long as File
+  std::optional<bela::bytes_view> SectionData(const Section &sec, bela::error_code &ec) const {
+    return readSectionData(sec, ec);
+  }
   bool Is64Bit() const { return oh.Is64Bit; }
   bela::pe::Machine Machine() const { return static_cast<bela::pe::Machine>(fh.Machine); }
   bela::pe::Subsystem Subsystem() const { return static_cast<bela::pe::Subsystem>(oh.Subsystem); }
-  // NewFile resolve pe file
-  bool NewFile(std::wstring_view p, bela::error_code &ec);
-  bool NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec);
+  // NewFile resolve pe file. mapped: map the whole image once, all lookups become zero-copy views of the mapping
+  bool NewFile(std::wstring_view p, bela::error_code &ec, bool mapped = false);
+  bool NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec, bool mapped = false);
+  // NewFile parse PE image in memory without copy, image must outlive File. parsing does not call Win32 API
+  bool NewFile(bela::bytes_view image_, bela::error_code &ec);
+  // NewFile parse PE from a positional reader, reader must outlive File. parsing does not call Win32 API
+  bool NewFile(const bela::io::ReaderAt &reader_, bela::error_code &ec);
   //
   const auto &FD() const { return fd; }
 
 private:
   bela::io::FD fd;
+  bela::io::MemView mv;
+  bela::bytes_view image; // mapped image or caller memory
+  const bela::io::ReaderAt *reader{nullptr};
+  mutable std::vector<bela::Buffer> sectionCache;
+  mutable std::mutex cacheMutex;
   int64_t size{SizeUnInitialized};
   FileHeader fh;
   OptionalHeader oh;
   std::vector<Section> sections;
   StringTable stringTable;
   int64_t overlayOffset{SizeUnInitialized};
+  int64_t ohOffset{0}; // optional header file offset, 0: no optional header
+};
+
+// ExportTable exports of one DLL, indexed by ordinal (dense, Symbols[ordinal - Base]) and by name
+class ExportTable {
+public:
+  ExportTable() = default;
+  ExportTable(std::vector<ExportedSymbol> &&symbols);
+  ExportTable(const ExportTable &) = delete;
+  ExportTable &operator=(const ExportTable &) = delete;
+  const ExportedSymbol *LookupOrdinal(int ordinal) const {
+    if (ordinal < static_cast<int>(base)) {
+      return nullptr;
+    }
+    auto i = static_cast<size_t>(ordinal) - base;
+    return i < symbols.size() ? &symbols[i] : nullptr;
+  }
+  const ExportedSymbol *LookupName(std::string_view name) const {
+    if (auto it = names.find(name); it != names.end()) {
+      return &symbols[it->second];
+    }
+    return nullptr;
+  }
+  const auto &Symbols() const { return symbols; }
+  uint32_t Base() const { return base; }
+
+private:
+  std::vector<ExportedSymbol> symbols;
+  bela::flat_hash_map<std::string_view, uint32_t> names; // views of symbols[i].Name
+  uint32_t base{0};
+};
+
+// ResourceID matches a resource directory entry by integer id or by name (case insensitive), default matches the
+// first entry
+struct ResourceID {
+  std::wstring_view Name;
+  uint16_t ID{0};
+  bool Any{true};
+  ResourceID() = default;
+  ResourceID(uint16_t id) : ID(id), Any(false) {}
+  ResourceID(std::wstring_view name) : Name(name), Any(false) {}
+  // accepts MAKEINTRESOURCEW ids, eg: RT_MANIFEST
+  ResourceID(const wchar_t *name) : Any(false) {
+    if (auto v = reinterpret_cast<uintptr_t>(name); (v >> 16) == 0) {
+      ID = static_cast<uint16_t>(v);
+      return;
+    }
+    Name = name;
+  }
+};
+
+// Resource data found by ResourceNavigator::Find, Data is a view of the image valid as long as File
+struct Resource {
+  bela::bytes_view Data;
+  uint32_t RVA{0};
+  uint32_t CodePage{0};
+  uint16_t Language{0};
+};
+
+// ResourceNavigator lazy view of the resource directory tree. Find descends only the matched type, name and language
+// directories, no entry is decoded ahead. with a mapped File returned data is not copied
+class ResourceNavigator {
+public:
+  bool Open(const File &file_, bela::error_code &ec);
+  // Find returns std::nullopt and empty ec when resource not found. eg: Find(RT_MANIFEST, CREATEPROCESS_MANIFEST_RESOURCE_ID)
+  std::optional<Resource> Find(const ResourceID &type, const ResourceID &name, const ResourceID &lang,
+                               bela::error_code &ec) const;
+  std::optional<Resource> Find(const ResourceID &type, const ResourceID &name, bela::error_code &ec) const {
+    return Find(type, name, ResourceID{}, ec);
+  }
+
+private:
+  bool lookupEntry(uint32_t offset, const ResourceID &key, uint32_t &next, uint16_t &id, bela::error_code &ec) const;
+  const File *file{nullptr};
+  bela::bytes_view root; // resource section from the root directory, offsets in the tree are relative to it
+  uint32_t rootRVA{0};
+};
+
+// ECMA-335 II.22 metadata tables, value is the table number
+enum class ClrTable : uint8_t {
+  Module,
+  TypeRef,
+  TypeDef,
+  FieldPtr,
+  Field,
+  MethodPtr,
+  MethodDef,
+  ParamPtr,
+  Param,
+  InterfaceImpl,
+  MemberRef,
+  Constant,
+  CustomAttribute,
+  FieldMarshal,
+  DeclSecurity,
+  ClassLayout,
+  FieldLayout,
+  StandAloneSig,
+  EventMap,
+  EventPtr,
+  Event,
+  PropertyMap,
+  PropertyPtr,
+  Property,
+  MethodSemantics,
+  MethodImpl,
+  ModuleRef,
+  TypeSpec,
+  ImplMap,
+  FieldRVA,
+  ENCLog,
+  ENCMap,
+  Assembly,
+  AssemblyProcessor,
+  AssemblyOS,
+  AssemblyRef,
+  AssemblyRefProcessor,
+  AssemblyRefOS,
+  File,
+  ExportedType,
+  ManifestResource,
+  NestedClass,
+  GenericParam,
+  MethodSpec,
+  GenericParamConstraint,
+};
+constexpr size_t ClrTableCount = static_cast<size_t>(ClrTable::GenericParamConstraint) + 1;
+
+// ClrAssemblyName decoded Assembly or AssemblyRef row, views of metadata heaps
+struct ClrAssemblyName {
+  std::string_view Name;
+  std::string_view Culture;
+  bela::bytes_view PublicKeyOrToken;
+  uint32_t Flags{0};
+  uint16_t Major{0};
+  uint16_t Minor{0};
+  uint16_t Build{0};
+  uint16_t Revision{0};
+};
+
+// ClrMetadata zero-copy reader of .NET metadata: root, heaps and the #~ (or #-) table stream. row sizes and table
+// offsets are computed once by Open, rows are decoded only when asked. views are valid as long as File
+class ClrMetadata {
+public:
+  bool Open(const File &file, bela::error_code &ec);
+  std::string_view Version() const { return version; }
+  uint32_t Rows(ClrTable t) const { return tables[static_cast<size_t>(t)].rows; }
+  // Column value of column (0-based) in row (1-based), heap and table indexes are not resolved
+  std::optional<uint32_t> Column(ClrTable t, uint32_t row, size_t column) const;
+  // String #Strings heap entry at index
+  std::string_view String(uint32_t index) const { return strings.make_cstring_view(index); }
+  // Blob #Blob heap entry at index without its compressed length
+  bela::bytes_view Blob(uint32_t index) const;
+  // GUID #GUID heap entry, index is 1-based. empty when out of range
+  bela::bytes_view GUID(uint32_t index) const;
+  std::optional<ClrAssemblyName> Assembly() const;
+  // AssemblyRef row (1-based), see Rows(ClrTable::AssemblyRef)
+  std::optional<ClrAssemblyName> AssemblyRef(uint32_t row) const;
+
+private:
+  struct table {
+    bela::bytes_view data;
+    uint32_t rows{0};
+    uint32_t rowSize{0};
+    uint8_t columns{0};
+    uint8_t offsets[9]{0};
+    uint8_t sizes[9]{0};
+  };
+  bool parseTables(bela::bytes_view ts, bela::error_code &ec);
+  std::array<table, ClrTableCount> tables;
+  bela::bytes_view strings;
+  bela::bytes_view blob;
+  bela::bytes_view guid;
+  std::string_view version;
 };
 
 class SymbolSearcher {
 private:
-  using SymbolTable = bela::flat_hash_map<std::string, std::vector<bela::pe::ExportedSymbol>>;
+  // nullptr: dll not found in Paths, cached so import tables that reference it do not probe again
+  using SymbolTable = bela::flat_hash_map<std::string, std::shared_ptr<const ExportTable>>;
+  struct CachedExports {
+    uint64_t LastWriteTime{0};
+    uint64_t Size{0};
+    std::shared_ptr<const ExportTable> Exports;
+  };
+  // key: volume serial number, file index
+  using PersistentTable = bela::flat_hash_map<std::pair<uint64_t, uint64_t>, CachedExports>;
   SymbolTable table;
+  PersistentTable persistent;
   std::vector<std::wstring> Paths;
-  std::optional<std::string> LoadOrdinalFunctionName(std::string_view dllname, int ordinal, bela::error_code &ec);
+  std::shared_ptr<const ExportTable> loadExportTable(std::string_view dllname, bela::error_code &ec);
 
 public:
   SymbolSearcher(std::wstring_view exe, Machine machine);
   SymbolSearcher(std::vector<std::wstring> &&paths) : Paths(std::move(paths)) {}
   SymbolSearcher(const SymbolSearcher &) = delete;
   SymbolSearcher &operator=(const SymbolSearcher &) = delete;
+  // LookupExportTable returns exports of dllname (case insensitive), valid as long as SymbolSearcher
+  const ExportTable *LookupExportTable(std::string_view dllname, bela::error_code &ec);
   std::optional<std::string> LookupOrdinalFunctionName(std::string_view dllname, int ordinal, bela::error_code &ec);
+  std::optional<int> LookupFunctionOrdinal(std::string_view dllname, std::string_view name, bela::error_code &ec);
+  // LoadCache/SaveCache persistent export tables keyed by file identity, entries whose size or last write time
+  // changed are parsed again. a missing cache file is not an error
+  bool LoadCache(std::wstring_view file, bela::error_code &ec);
+  bool SaveCache(std::wstring_view file, bela::error_code &ec) const;
+};
+
+// ApiSetSchema maps api set contracts (api-ms-*, ext-ms-*) to host dlls, from the .apiset section of
+// apisetschema.dll. only schema version 6 (Windows 10 and later) is supported
+class ApiSetSchema {
+public:
+  bool Load(std::wstring_view file, bela::error_code &ec);
+  bool Parse(bela::bytes_view data, bela::error_code &ec);
+  bool Empty() const { return contracts.empty(); }
+  // Resolve returns lower case host dll of contract name for importer, empty string: contract has no host.
+  // std::nullopt: unknown contract
+  std::optional<std::string> Resolve(std::string_view name, std::string_view importer = {}) const;
+  static bool IsApiSetName(std::string_view name);
+
+private:
+  struct contract {
+    std::string host;
+    std::vector<std::pair<std::string, std::string>> exceptions; // importer, host
+  };
+  bela::flat_hash_map<std::string, contract> contracts; // lower case name without the last '-' version part
+};
+
+struct ImportEdge {
+  uint32_t Target{0};               // ImportGraph::Nodes index
+  bool Delay{false};                // delay-load import
+  std::string ApiSet;               // api set contract resolved to Target
+  std::vector<std::string> Missing; // names or #ordinal not exported by target, only checked when target is found
+};
+
+struct ImportNode {
+  std::string Name;  // lower case module name
+  std::wstring Path; // empty: not found in tree or search paths
+  bela::pe::Machine Machine{bela::pe::Machine::UNKNOWN};
+  std::vector<ImportEdge> Imports;
+  bool ApiSet{false}; // api set contract without host
+  bela::error_code Error; // parse error
+};
+
+struct ImportGraph {
+  std::vector<ImportNode> Nodes;
+  std::vector<uint32_t> Missing; // nodes imported but not found, sorted by name
+};
+
+// ImportGraphBuilder parse every PE file under a directory on a thread pool and link their imports and delay imports.
+// a module resolves to a file in the importer's directory, then the tree (same machine first), then Paths
+class ImportGraphBuilder {
+public:
+  // concurrency == 0 use hardware concurrency
+  ImportGraphBuilder(uint32_t concurrency_ = 0);
+  ImportGraphBuilder(const ImportGraphBuilder &) = delete;
+  ImportGraphBuilder &operator=(const ImportGraphBuilder &) = delete;
+  bool Build(std::wstring_view root, ImportGraph &graph, bela::error_code &ec) const;
+  // Paths searched for modules not in tree (eg: %SystemRoot%\System32), only their exports are read
+  std::vector<std::wstring> Paths;
+  // ApiSet resolve api set imports to host modules, unresolved contracts are api set nodes never reported missing
+  ApiSetSchema ApiSet;
+
+private:
+  uint32_t concurrency{0};
 };
 
-// https://docs.microsoft.com/en-us/windows/win32/api/winver/nf-winver-getfileversioninfoexw
-// https://docs.microsoft.com/zh-cn/windows/win32/api/winver/nf-winver-getfileversioninfosizeexw
-// https://docs.microsoft.com/zh-cn/windows/win32/api/winver/nf-winver-verqueryvaluew
-// version.lib
+// https://learn.microsoft.com/en-us/windows/win32/menurc/vs-versioninfo
+// ParseVersionInfo decode VS_VERSIONINFO resource data: VS_FIXEDFILEINFO and the StringFileInfo table matching
+// \VarFileInfo\Translation (or the first table)
+bool ParseVersionInfo(bela::bytes_view data, Version &vi, bela::error_code &ec);
+// Lookup version of PE file from its RT_VERSION resource
 std::optional<Version> Lookup(std::wstring_view file, bela::error_code &ec);
 
 inline bool IsSubsystemConsole(std::wstring_view p) {
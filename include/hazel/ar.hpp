@@ -0,0 +1,78 @@
+//
+#ifndef HAZEL_AR_HPP
+#define HAZEL_AR_HPP
+#include <optional>
+#include <bela/base.hpp>
+#include <bela/phmap.hpp>
+#include <bela/io.hpp>
+#include <bela/pe.hpp>
+#include "elf.hpp"
+
+namespace hazel::ar {
+// https://en.wikipedia.org/wiki/Ar_(Unix)
+// https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#archive-library-file-format
+
+// SymbolFormat archive symbol table flavour
+enum class SymbolFormat : uint8_t {
+  None,  // archive has no symbol table
+  GNU,   // '/' big endian 32-bit offsets (System V, also the first linker member of COFF)
+  GNU64, // '/SYM64/' big endian 64-bit offsets
+  BSD,   // '__.SYMDEF' ranlib
+  BSD64, // '__.SYMDEF_64' ranlib
+  COFF,  // second '/' linker member of COFF import and static libraries
+};
+
+struct Member {
+  std::string Name;
+  int64_t HeaderOffset{0}; // offset of member header, symbol table offsets point here
+  int64_t Offset{0};       // offset of member data
+  int64_t Size{0};
+  int64_t Time{0};
+  uint32_t Mode{0};
+};
+
+// Archive reader of Unix ar (GNU, BSD) and COFF library (.lib) files. the archive is mapped, the symbol index is built
+// from the linker member once, members are located on demand and parsed without copy
+class Archive {
+public:
+  Archive() = default;
+  Archive(const Archive &) = delete;
+  Archive &operator=(const Archive &) = delete;
+  // NewArchive map archive file
+  bool NewArchive(std::wstring_view p, bela::error_code &ec);
+  // NewArchive parse archive in memory without copy, image must outlive Archive
+  bool NewArchive(bela::bytes_view image_, bela::error_code &ec);
+  int64_t Size() const { return static_cast<int64_t>(image.size()); }
+  SymbolFormat Format() const { return format; }
+  size_t SymbolCount() const { return symbols.size(); }
+  // LookupSymbol returns the member defining symbol, std::nullopt and empty ec: symbol not in archive symbol table.
+  // the first definition wins as with linkers
+  std::optional<Member> LookupSymbol(std::string_view symbol, bela::error_code &ec) const;
+  // ReadMember decode member header at headerOffset
+  std::optional<Member> ReadMember(int64_t headerOffset, bela::error_code &ec) const;
+  // Members returns regular members in archive order, symbol tables and the long name table are skipped
+  bool Members(std::vector<Member> &members, bela::error_code &ec) const;
+  // MemberData view of member data, valid as long as Archive
+  bela::bytes_view MemberData(const Member &m) const {
+    return image.subview(static_cast<size_t>(m.Offset), static_cast<size_t>(m.Size));
+  }
+  // OpenPE parse COFF object member, short import objects of import libraries are not COFF objects
+  bool OpenPE(const Member &m, bela::pe::File &file, bela::error_code &ec) const;
+  bool OpenELF(const Member &m, hazel::elf::File &file, bela::error_code &ec) const {
+    return file.NewFile(MemberData(m), ec);
+  }
+
+private:
+  bool parseArchive(bela::error_code &ec);
+  bool parseSymbolTable(std::string_view name, bela::bytes_view data, bela::error_code &ec);
+  bela::io::MemView mv;
+  bela::bytes_view image;
+  bela::bytes_view longNames;                            // '//' member
+  bela::flat_hash_map<std::string_view, int64_t> symbols; // views of the linker member, member header offset
+  int64_t firstMember{0};
+  SymbolFormat format{SymbolFormat::None};
+};
+
+} // namespace hazel::ar
+
+#endif
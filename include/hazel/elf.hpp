@@ -1,6 +1,7 @@
 //
 #ifndef HAZEL_ELF_HPP
 #define HAZEL_ELF_HPP
+#include <functional>
 #include <bela/endian.hpp>
 #include "hazel.hpp"
 #include "details/elf.h"
@@ -8,6 +9,7 @@
 namespace hazel::elf {
 using namespace llvm::ELF;
 constexpr int COMPRESS_ZLIB = 1;            /* ZLIB compression. */
+constexpr int COMPRESS_ZSTD = 2;            /* Zstandard compression. */
 constexpr int COMPRESS_LOOS = 0x60000000;   /* First OS-specific. */
 constexpr int COMPRESS_HIOS = 0x6fffffff;   /* Last OS-specific. */
 constexpr int COMPRESS_LOPROC = 0x70000000; /* First processor-specific type. */
@@ -71,6 +73,11 @@ struct Section {
   uint32_t nameIndex;
 };
 
+// Writer receives section data chunk by chunk, return false to stop reading
+using Writer = std::function<bool(const void *data, size_t len)>;
+// SectionBytes immutable section contents shared with File section cache, it stays valid after eviction
+using SectionBytes = std::shared_ptr<const bela::Buffer>;
+
 struct verneed {
   std::string file;
   std::string name;
@@ -79,12 +86,33 @@ struct verneed {
 class File {
 private:
   bool parseFile(bela::error_code &ec);
+  // reset drop the source and everything derived from it before a File is reused, cacheLimit is a setting and stays
+  void reset() {
+    image = bela::bytes_view();
+    size = bela::SizeUnInitialized;
+    sections.clear();
+    progs.clear();
+    gnuNeed.clear();
+    gnuVersym.reset();
+    sectionCache.clear();
+    cacheOrder.clear();
+    cacheBytes = 0;
+  }
   void MoveFrom(File &&r) {
     fd = std::move(r.fd);
+    image = r.image;
+    r.image = bela::bytes_view();
     size = r.size;
     r.size = 0;
     sections = std::move(r.sections);
     progs = std::move(r.progs);
+    gnuNeed = std::move(r.gnuNeed);
+    gnuVersym = std::move(r.gnuVersym);
+    sectionCache = std::move(r.sectionCache);
+    cacheOrder = std::move(r.cacheOrder);
+    cacheBytes = r.cacheBytes;
+    cacheLimit = r.cacheLimit;
+    r.cacheBytes = 0;
     memcpy(&fh, &r.fh, sizeof(fh));
     memset(&r.fh, 0, sizeof(r.fh));
   }
@@ -114,42 +142,47 @@ private:
     }
     return nullptr;
   }
-  bool sectionData(const Section &sec, bela::Buffer &buffer, bela::error_code &ec) const {
-    if (bela::narrow_cast<int64_t>(sec.Offset + sec.Size) > size) {
-      ec = bela::make_error_code(bela::ErrFileTooSmall, L"corrupted ELF file, section overflow file: ", size,
-                                 L" section end: ", sec.Offset + sec.Size);
-      return false;
-    }
-    buffer.grow(static_cast<size_t>(sec.Size));
-    if (!fd.ReadAt(buffer, static_cast<size_t>(sec.Size), sec.Offset, ec)) {
-      return false;
+  // readAt reads from the in-memory image or fd
+  bool readAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const;
+  bool readAt(bela::Buffer &buffer, size_t nbytes, int64_t pos, bela::error_code &ec) const {
+    if (auto p = buffer.make_span(nbytes); readAt(p, pos, ec)) {
+      buffer.size() = p.size();
+      return true;
     }
-    return true;
+    return false;
   }
+  template <typename T>
+    requires bela::io::exclude_buffer_derived<T>
+  bool readAt(T &t, int64_t pos, bela::error_code &ec) const {
+    return readAt({reinterpret_cast<uint8_t *>(&t), sizeof(T)}, pos, ec);
+  }
+  bool readRawSection(const Section &sec, const Writer &w, bela::error_code &ec) const;
+  bool sectionData(const Section &sec, bela::Buffer &buffer, bela::error_code &ec) const;
 
-  bool stringTable(uint32_t link, bela::Buffer &buf, bela::error_code &ec) const {
+  bool cachedSection(const Section &sec, SectionBytes &view, bela::error_code &ec) const;
+  bool stringTable(uint32_t link, SectionBytes &view, bela::error_code &ec) const {
     if (link <= 0 || link >= static_cast<uint32_t>(sections.size())) {
       ec = bela::make_error_code(L"section has invalid string table link");
       return false;
     }
-    return sectionData(sections[link], buf, ec);
+    return cachedSection(sections[link], view, ec);
   }
-  bool gnuVersionInit(std::span<const uint8_t> str);
+  bool gnuVersionInit(bela::bytes_view str);
   void gnuVersion(int i, std::string &lib, std::string &ver) {
     i = (i + 1) * 2;
-    if (i >= static_cast<int>(gnuVersym.size())) {
+    if (!gnuVersym || i + 2 > static_cast<int>(gnuVersym->size())) {
       return;
     }
-    auto j = static_cast<size_t>(cast_from<uint16_t>(gnuVersym.data() + i));
+    auto j = static_cast<size_t>(cast_from<uint16_t>(gnuVersym->data() + i));
     if (j < 2 || j >= gnuNeed.size()) {
       return;
     }
     lib = gnuNeed[j].file;
     ver = gnuNeed[j].name;
   }
-  bool getSymbols64(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &strdata, bela::error_code &ec) const;
-  bool getSymbols32(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &strdata, bela::error_code &ec) const;
-  bool getSymbols(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &strdata, bela::error_code &ec) const {
+  bool getSymbols64(uint32_t st, std::vector<Symbol> &syms, SectionBytes &strdata, bela::error_code &ec) const;
+  bool getSymbols32(uint32_t st, std::vector<Symbol> &syms, SectionBytes &strdata, bela::error_code &ec) const;
+  bool getSymbols(uint32_t st, std::vector<Symbol> &syms, SectionBytes &strdata, bela::error_code &ec) const {
     if (is64bit) {
       return getSymbols64(st, syms, strdata, ec);
     }
@@ -164,11 +197,33 @@ public:
   // NewFile resolve pe file
   bool NewFile(std::wstring_view p, bela::error_code &ec);
   bool NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec);
+  // NewFile parse ELF image in memory without copy (eg: an archive member), image must outlive File
+  bool NewFile(bela::bytes_view image_, bela::error_code &ec);
   bool Is64Bit() const { return is64bit; }
   int64_t Size() const { return size; }
   const auto &Sections() const { return sections; }
   const auto &Progs() const { return progs; }
   const auto &Fh() const { return fh; }
+  // SectionData returns the contents of section, SHF_COMPRESSED section is decompressed transparently
+  bool SectionData(const Section &sec, bela::Buffer &buffer, bela::error_code &ec) const {
+    return sectionData(sec, buffer, ec);
+  }
+  // SectionStream feeds the (decompressed) contents of section to writer chunk by chunk without allocating the whole
+  // section, suitable for large .debug_* sections
+  bool SectionStream(const Section &sec, const Writer &w, bela::error_code &ec) const;
+  // CachedSection returns immutable contents of section, each section is read from disk once and shared by later
+  // calls until evicted by cache limit
+  bool CachedSection(const Section &sec, SectionBytes &view, bela::error_code &ec) const {
+    return cachedSection(sec, view, ec);
+  }
+  // SetCacheLimit limit section cache memory, 0 is unlimited. sections larger than limit are never cached
+  void SetCacheLimit(size_t limit);
+  size_t CacheSize() const { return cacheBytes; }
+  void ClearCache() {
+    sectionCache.clear();
+    cacheOrder.clear();
+    cacheBytes = 0;
+  }
   bool DynString(int tag, std::vector<std::string> &sv, bela::error_code &ec) const;
   std::optional<std::string> DynString(int tag, bela::error_code &ec) const {
     std::vector<std::string> so;
@@ -184,7 +239,7 @@ public:
   bool DynamicSymbols(std::vector<Symbol> &syms, bela::error_code &ec);
   bool ImportedSymbols(std::vector<ImportedSymbol> &symbols, bela::error_code &ec);
   bool Symbols(std::vector<Symbol> &syms, bela::error_code &ec) const {
-    bela::Buffer strdata;
+    SectionBytes strdata;
     return getSymbols(SHT_SYMTAB, syms, strdata, ec);
   }
   // depend libs
@@ -193,19 +248,62 @@ public:
   // https://www.qt.io/blog/2011/10/28/rpath-and-runpath
   // https://wiki.debian.org/RpathIssue
   std::optional<std::string> Rpath(bela::error_code &ec) const { return DynString(DT_RPATH, ec); };
-  std::optional<std::string> Rupath(bela::error_code &ec) const { return DynString(DT_RPATH, ec); };
+  std::optional<std::string> Rupath(bela::error_code &ec) const { return DynString(DT_RUNPATH, ec); };
 
 private:
   bela::io::FD fd;
+  bela::bytes_view image; // caller memory
   int64_t size{bela::SizeUnInitialized};
   std::endian en{std::endian::native};
   FileHeader fh;
   std::vector<Section> sections;
   std::vector<ProgHeader> progs;
   std::vector<verneed> gnuNeed;
-  bela::Buffer gnuVersym;
+  SectionBytes gnuVersym;
+  // section cache index by section number, not thread safe as File
+  mutable std::vector<SectionBytes> sectionCache;
+  mutable std::vector<size_t> cacheOrder;
+  mutable size_t cacheBytes{0};
+  size_t cacheLimit{0};
   bool is64bit{false};
 };
+
+struct DependencyNode {
+  std::string Name;                 // DT_NEEDED name, root node is the input path
+  std::string Path;                 // POSIX path inside sysroot
+  std::string SoName;               // DT_SONAME
+  std::vector<std::string> Needed;  // DT_NEEDED
+  std::vector<int> Edges;           // Nodes index of each Needed, -1 not found
+};
+
+struct DependencyGraph {
+  std::vector<DependencyNode> Nodes; // Nodes[0] is root
+  std::vector<std::string> Missing;  // DT_NEEDED names not found, sorted
+  bela::error_code Error;            // root parse error
+};
+
+struct DependencyCache;
+// DependencyResolver resolve DT_NEEDED transitive closure like ldd against a sysroot (container image rootfs)
+// search order: DT_RPATH (when no DT_RUNPATH), LD_LIBRARY_PATH (not support), DT_RUNPATH, /etc/ld.so.conf, default dirs
+// parsed libraries are memoized by (volume serial, file index) and shared across Resolve calls
+class DependencyResolver {
+public:
+  // concurrency == 0 use hardware concurrency
+  DependencyResolver(std::wstring_view sysroot_, uint32_t concurrency_ = 0);
+  DependencyResolver(const DependencyResolver &) = delete;
+  DependencyResolver &operator=(const DependencyResolver &) = delete;
+  ~DependencyResolver();
+  // Resolve resolve file (POSIX path inside sysroot)
+  bool Resolve(std::string_view path, DependencyGraph &graph, bela::error_code &ec);
+  // Resolve resolve files on thread pool, per file error is saved to DependencyGraph::Error. an exception thrown by a
+  // worker stops the pool and is rethrown here
+  bool Resolve(const std::vector<std::string> &paths, std::vector<DependencyGraph> &graphs, bela::error_code &ec);
+
+private:
+  std::wstring sysroot;
+  uint32_t concurrency{0};
+  std::unique_ptr<DependencyCache> cache;
+};
 } // namespace hazel::elf
 
 #endif
\ No newline at end of file
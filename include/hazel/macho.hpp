@@ -1,6 +1,7 @@
 //
 #ifndef HAZEL_MACHO_HPP
 #define HAZEL_MACHO_HPP
+#include <functional>
 #include <bela/endian.hpp>
 #include "hazel.hpp"
 #include "details/macho.h"
@@ -351,6 +352,16 @@ struct Load {
   };
 };
 
+// ExportInfo a terminal node of the dyld export trie, views point into the trie and live as long as File
+struct ExportInfo {
+  uint64_t Flags{0};   // EXPORT_SYMBOL_FLAGS_*
+  uint64_t Address{0}; // image offset, stub offset when EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER
+  uint64_t Other{0};   // resolver offset or re-exported dylib ordinal
+  std::string_view ImportName; // EXPORT_SYMBOL_FLAGS_REEXPORT, empty means same name
+};
+// ExportWalker receives every exported name, name is only valid during the call. return false to stop
+using ExportWalker = std::function<bool(std::string_view name, const ExportInfo &info)>;
+
 class FatFile;
 
 constexpr auto ErrNotFat = static_cast<long>(MagicFat);
@@ -360,6 +371,7 @@ private:
   bool parseFile(bela::error_code &ec);
   void MoveFrom(File &&r) {
     fd = std::move(r.fd);
+    mv = std::move(r.mv);
     size = r.size;
     r.size = 0;
     baseOffset = r.baseOffset;
@@ -368,6 +380,9 @@ private:
     dysymtab = std::move(r.dysymtab);
     symtab = std::move(r.symtab);
     sections = std::move(r.sections);
+    exportHolder = std::move(r.exportHolder);
+    exportTrie = r.exportTrie;
+    r.exportTrie = {};
     memcpy(&fh, &r.fh, sizeof(fh));
     memset(&r.fh, 0, sizeof(r.fh));
   }
@@ -389,10 +404,20 @@ private:
     }
     return bela::bswap(v);
   }
+  // readAt read from slice relative offset, from the shared mapping when parsed by FatFile in parallel mode
+  bool readAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const;
+  template <typename T>
+    requires bela::io::exclude_buffer_derived<T>
+  bool readAt(T &t, int64_t pos, bela::error_code &ec) const {
+    return readAt({reinterpret_cast<uint8_t *>(&t), sizeof(T)}, pos, ec);
+  }
+  // viewAt returns len bytes at pos, zero-copy from mapping, otherwise read into holder
+  bool viewAt(int64_t pos, size_t len, bela::Buffer &holder, std::string_view &sv, bela::error_code &ec) const;
   bool readFileHeader(int64_t &offset, bela::error_code &ec);
   bool parseSymtab(std::string_view symdat, std::string_view strtab, std::string_view cmddat, const SymtabCmd &hdr,
                    int64_t offset, bela::error_code &ec);
   bool pushSection(hazel::macho::Section *sh, bela::error_code &ec);
+  bool loadExportTrie(uint32_t off, uint32_t len, bela::error_code &ec);
 
 public:
   File() = default;
@@ -412,6 +437,16 @@ public:
   const auto &Fh() { return fh; }
   bool Depends(std::vector<std::string> &libs, bela::error_code &ec);
   bool ImportedSymbols(std::vector<std::string> &symbols, bela::error_code &ec);
+  // LookupExport walk the export trie (LC_DYLD_INFO_ONLY or LC_DYLD_EXPORTS_TRIE), O(len(name))
+  bool LookupExport(std::string_view name, ExportInfo &info, bela::error_code &ec) const;
+  bool HasExport(std::string_view name) const {
+    ExportInfo info;
+    bela::error_code ec;
+    return LookupExport(name, info, ec);
+  }
+  // Exports enumerate export trie depth first without allocating per name
+  bool Exports(const ExportWalker &walker, bela::error_code &ec) const;
+  bool HasExportTrie() const { return !exportTrie.empty(); }
   const hazel::macho::Section *Section(std::string_view name) const {
     for (const auto &s : sections) {
       if (s.Name == name) {
@@ -434,11 +469,14 @@ public:
 private:
   friend class FatFile;
   bela::io::FD fd;
-  int64_t baseOffset{0}; // when support fat
+  std::shared_ptr<const bela::io::MemView> mv; // shared with FatFile
+  int64_t baseOffset{0}; // slice offset in fat file
   int64_t size{bela::SizeUnInitialized};
   std::endian en{std::endian::native};
   std::vector<Load> loads;
   std::vector<hazel::macho::Section> sections;
+  bela::Buffer exportHolder;   // export trie copy when not mapped
+  std::string_view exportTrie; // view of mapping or exportHolder
   FileHeader fh;
   Symtab symtab;
   Dysymtab dysymtab;
@@ -460,21 +498,24 @@ struct FatArch {
 
 class FatFile {
 private:
-  bool parseFile(bela::error_code &ec);
+  bool parseFile(bool parallel, bela::error_code &ec);
+  bool parseArches(bool parallel, bela::error_code &ec);
 
 public:
   FatFile() = default;
   FatFile(const FatFile &) = delete;
   FatFile &operator=(const FatFile &) = delete;
   ~FatFile() = default;
-  // NewFile resolve pe file
-  bool NewFile(std::wstring_view p, bela::error_code &ec);
-  bool NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec);
+  // NewFile resolve fat file. parallel: map the file once, every slice shares the mapping and slices are parsed
+  // concurrently; otherwise slices are parsed one by one through the parent FD
+  bool NewFile(std::wstring_view p, bela::error_code &ec, bool parallel = false);
+  bool NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec, bool parallel = false);
   const auto &Arches() const { return arches; }
   auto &Arches() { return arches; }
 
 private:
   bela::io::FD fd;
+  std::shared_ptr<const bela::io::MemView> mv;
   int64_t size{bela::SizeUnInitialized};
   std::vector<FatArch> arches;
 };
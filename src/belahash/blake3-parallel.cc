@@ -0,0 +1,74 @@
+// multithreaded BLAKE3, subtrees of one update are compressed on separate threads
+// blake3.c is built with BLAKE3_USE_TBB, its subtree join hook is served by std::thread instead of oneTBB. the hook
+// and the functions it calls are declared by blake3_impl.h, which must come before bela/hash.hpp
+#include "blake3/blake3_impl.h"
+#include <bela/hash.hpp>
+#include <bela/hashfile.hpp>
+#include <bela/io.hpp>
+#include <algorithm>
+#include <thread>
+
+namespace bela::hash::blake3 {
+namespace {
+// smaller right subtrees are not worth a thread
+constexpr size_t forkMinLength = 1024 * 1024;
+// threads the current subtree may still start
+thread_local uint32_t forkBudget = 0;
+} // namespace
+
+void Hasher::UpdateParallel(const void *input, size_t input_len, uint32_t concurrency) {
+  if (concurrency == 0) {
+    concurrency = (std::max)(std::thread::hardware_concurrency(), 1u);
+  }
+  auto saved = forkBudget;
+  forkBudget = concurrency - 1;
+  blake3_hasher_update_tbb(&h, input, input_len);
+  forkBudget = saved;
+}
+
+bool HashFileParallel(std::wstring_view file, Hasher &h, uint32_t concurrency, bela::error_code &ec) {
+  bela::io::MemView mv;
+  if (!mv.Map(file, ec)) {
+    return false;
+  }
+  h.UpdateParallel(mv.data(), mv.size(), concurrency);
+  return true;
+}
+} // namespace bela::hash::blake3
+
+using bela::hash::blake3::forkBudget;
+using bela::hash::blake3::forkMinLength;
+
+extern "C" void blake3_compress_subtree_wide_join_tbb(const uint32_t key[8], uint8_t flags, bool use_tbb,
+                                                      const uint8_t *l_input, size_t l_input_len,
+                                                      uint64_t l_chunk_counter, uint8_t *l_cvs, size_t *l_n,
+                                                      const uint8_t *r_input, size_t r_input_len,
+                                                      uint64_t r_chunk_counter, uint8_t *r_cvs, size_t *r_n) noexcept {
+  auto serial = [&] {
+    *l_n = blake3_compress_subtree_wide(l_input, l_input_len, key, l_chunk_counter, flags, l_cvs, use_tbb);
+    *r_n = blake3_compress_subtree_wide(r_input, r_input_len, key, r_chunk_counter, flags, r_cvs, use_tbb);
+  };
+  if (!use_tbb || forkBudget == 0 || r_input_len < forkMinLength) {
+    serial();
+    return;
+  }
+  // one thread for the right subtree, the rest is shared by size. the left subtree is never the smaller one
+  auto budget = forkBudget - 1;
+  auto rightBudget = static_cast<uint32_t>(static_cast<uint64_t>(budget) * r_input_len / (l_input_len + r_input_len));
+  std::thread right;
+  try {
+    right = std::thread([&, rightBudget] {
+      forkBudget = rightBudget;
+      *r_n = blake3_compress_subtree_wide(r_input, r_input_len, key, r_chunk_counter, flags, r_cvs, use_tbb);
+    });
+  } catch (...) {
+    // no thread or no memory for it, nothing may propagate into blake3.c
+    serial();
+    return;
+  }
+  auto saved = forkBudget;
+  forkBudget = budget - rightBudget;
+  *l_n = blake3_compress_subtree_wide(l_input, l_input_len, key, l_chunk_counter, flags, l_cvs, use_tbb);
+  forkBudget = saved;
+  right.join();
+}
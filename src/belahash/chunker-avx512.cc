@@ -0,0 +1,115 @@
+// gear hash boundary search with AVX-512 VBMI, 64 bytes per iteration: table lookup with vpermi2b, hashes of 16
+// consecutive bytes by a log-step prefix sum in each zmm
+#include <bela/hash.hpp>
+#include <bit>
+#include "hashinternal.hpp"
+
+#if defined(BELA_HASH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace bela::hash::cdc {
+namespace {
+// byte k of gear[] as four 64-byte quarters for vpermi2b
+struct gearPlanes {
+  alignas(64) uint8_t planes[4][256];
+  gearPlanes() {
+    for (int k = 0; k < 4; k++) {
+      for (int i = 0; i < 256; i++) {
+        planes[k][i] = static_cast<uint8_t>(gear[i] >> (k * 8));
+      }
+    }
+  }
+};
+
+// byte order that makes the unpack sequence below produce dwords in stream order: zmm q element 4l + e is byte
+// 16q + 4l + e, unpack takes it from byte 16l + 4q + e
+alignas(64) const uint8_t unpackOrder[64] = {
+    0,  1,  2,  3,  16, 17, 18, 19, 32, 33, 34, 35, 48, 49, 50, 51, 4,  5,  6,  7,  20, 21,
+    22, 23, 36, 37, 38, 39, 52, 53, 54, 55, 8,  9,  10, 11, 24, 25, 26, 27, 40, 41, 42, 43,
+    56, 57, 58, 59, 12, 13, 14, 15, 28, 29, 30, 31, 44, 45, 46, 47, 60, 61, 62, 63,
+};
+alignas(64) const uint32_t carryShift[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+// prefix hash of 16 consecutive gear values as if nothing came before them
+inline __m512i localHash(__m512i g) {
+  const auto zero = _mm512_setzero_si512();
+  g = _mm512_add_epi32(g, _mm512_slli_epi32(_mm512_alignr_epi32(g, zero, 15), 1));
+  g = _mm512_add_epi32(g, _mm512_slli_epi32(_mm512_alignr_epi32(g, zero, 14), 2));
+  g = _mm512_add_epi32(g, _mm512_slli_epi32(_mm512_alignr_epi32(g, zero, 12), 4));
+  return _mm512_add_epi32(g, _mm512_slli_epi32(_mm512_alignr_epi32(g, zero, 8), 8));
+}
+} // namespace
+
+size_t find_avx512(const uint8_t *data, size_t len, uint32_t &fp, uint32_t mask) {
+  static const gearPlanes gp;
+  __m512i lookup[4][4];
+  for (int k = 0; k < 4; k++) {
+    for (int q = 0; q < 4; q++) {
+      lookup[k][q] = _mm512_load_si512(gp.planes[k] + q * 64);
+    }
+  }
+  const auto order = _mm512_load_si512(unpackOrder);
+  const auto shifts = _mm512_load_si512(carryShift);
+  const auto last = _mm512_set1_epi32(15);
+  const auto maskv = _mm512_set1_epi32(static_cast<int>(mask));
+  // hash of byte 16q - 1 is the local hash there plus the one 16 bytes earlier shifted by 16, older bytes are shifted
+  // out: broadcast local hashes of the last two 16-byte groups, the initial fp stands for the one before data
+  auto prev1 = _mm512_set1_epi32(static_cast<int>(fp));
+  auto prev2 = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 64 <= len; i += 64) {
+    auto x = _mm512_permutexvar_epi8(order, _mm512_loadu_si512(data + i));
+    auto high = _mm512_movepi8_mask(x);
+    __m512i p[4];
+    for (int k = 0; k < 4; k++) {
+      p[k] = _mm512_mask_blend_epi8(high, _mm512_permutex2var_epi8(lookup[k][0], x, lookup[k][1]),
+                                    _mm512_permutex2var_epi8(lookup[k][2], x, lookup[k][3]));
+    }
+    auto lo01 = _mm512_unpacklo_epi8(p[0], p[1]);
+    auto hi01 = _mm512_unpackhi_epi8(p[0], p[1]);
+    auto lo23 = _mm512_unpacklo_epi8(p[2], p[3]);
+    auto hi23 = _mm512_unpackhi_epi8(p[2], p[3]);
+    __m512i g[4] = {
+        localHash(_mm512_unpacklo_epi16(lo01, lo23)),
+        localHash(_mm512_unpackhi_epi16(lo01, lo23)),
+        localHash(_mm512_unpacklo_epi16(hi01, hi23)),
+        localHash(_mm512_unpackhi_epi16(hi01, hi23)),
+    };
+    uint64_t hits = 0;
+    for (int q = 0; q < 4; q++) {
+      // add the hash of the byte before, shifted by the distance
+      auto carry = _mm512_add_epi32(prev1, _mm512_slli_epi32(prev2, 16));
+      prev2 = prev1;
+      prev1 = _mm512_permutexvar_epi32(last, g[q]);
+      g[q] = _mm512_add_epi32(g[q], _mm512_sllv_epi32(carry, shifts));
+      hits |= static_cast<uint64_t>(_mm512_testn_epi32_mask(g[q], maskv)) << (q * 16);
+    }
+    if (hits != 0) {
+      auto n = static_cast<size_t>(std::countr_zero(hits));
+      alignas(64) uint32_t hashes[64];
+      for (int q = 0; q < 4; q++) {
+        _mm512_store_si512(hashes + q * 16, g[q]);
+      }
+      fp = hashes[n];
+      return i + n;
+    }
+  }
+  auto h = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm512_castsi512_si128(prev1))) +
+           (static_cast<uint32_t>(_mm_cvtsi128_si32(_mm512_castsi512_si128(prev2))) << 16);
+  for (; i < len; i++) {
+    h = (h << 1) + gear[data[i]];
+    if ((h & mask) == 0) {
+      fp = h;
+      return i;
+    }
+  }
+  fp = h;
+  return len;
+}
+} // namespace bela::hash::cdc
+
+#endif
@@ -0,0 +1,195 @@
+// FastCDC content-defined chunking with normalized chunk sizes and per-chunk BLAKE3
+#include <bela/hashfile.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "hashinternal.hpp"
+
+namespace bela::hash {
+namespace cdc {
+// splitmix64 of 0..255, high 32 bits
+const uint32_t gear[256] = {
+    0xe220a839, 0x910a2dec, 0x975835de, 0x1d0b14e4, 0x6e73e372, 0x63033b0c, 0xbd64a5d9, 0x63cbe1e4,
+    0x9e5651b0, 0xaeaf52fe, 0x088712be, 0x50f5647d, 0x943ff9fc, 0xc4ca37b7, 0x6aa9d614, 0x875b9307,
+    0x5de186dc, 0x808475f0, 0x1120b3d0, 0xbc4075f2, 0x36225990, 0x06ca0a95, 0xc80de0f9, 0xe8d7da00,
+    0xaac8c000, 0xa208c12c, 0xc3b7f4e8, 0x974e3532, 0x905c768a, 0xbb7b49ab, 0xa8ee577a, 0xd7599677,
+    0xeaeb7f27, 0x2c0e0fed, 0x89242d2d, 0x4d5cb825, 0xe9b31629, 0xc7ab5605, 0xeb01cfaf, 0xce6a57a6,
+    0x369eae0b, 0x118e846e, 0xbdd73226, 0xba69ec90, 0xfb452912, 0xf7e9f3f8, 0xbaee56f3, 0x7bb3c45c,
+    0x040a2076, 0x1c4a97a6, 0xbb0802c4, 0x5ddad83b, 0xf9b44ecd, 0xc85e84f4, 0xbc46b610, 0x6e1351b2,
+    0x9d189ecf, 0x36057413, 0x7daf7bd7, 0x9691c38b, 0xbb0af0f3, 0x417ffd13, 0x322f69af, 0x8c741196,
+    0xd6967248, 0x3706970b, 0x2c1c719d, 0xe5aeaa75, 0x051c9d6d, 0x5351ebfc, 0x6707e833, 0xd0b1b125,
+    0x8e64bfa8, 0xd08f0038, 0x49f64e7a, 0x8b425770, 0xe5f50758, 0x6258cbe0, 0x5709ba31, 0x8795cc50,
+    0xbd9e8145, 0x9192105c, 0x0de7f334, 0x0981d32a, 0xcf646247, 0x6e159ae8, 0xd34711b5, 0xf4c4962e,
+    0x3d9b6445, 0xd0f82525, 0xef96e022, 0xf85507da, 0x9d589011, 0xfb43e483, 0xf5d716b2, 0xfb761138,
+    0x62329690, 0x4f5da978, 0xf0eea8c8, 0x42f3a936, 0x23259b94, 0xd1024a5f, 0x11402f24, 0x19e7518d,
+    0x47784b98, 0xbba2aa66, 0x225ac33c, 0x230275d7, 0xcd19f198, 0xb32f0f46, 0x9089f05f, 0xf9364c1f,
+    0x738032f6, 0xaea0b056, 0x66bbe75c, 0x4eff0b08, 0xdabe0bd2, 0x4b1bbcd2, 0x730543a4, 0x2a8e80d0,
+    0x02f59075, 0x28bf8a80, 0x1882c195, 0xb4dc9bd4, 0xd1b89df7, 0xca87cb27, 0xb41d1166, 0x3fadb6bd,
+    0xabf42acc, 0x96403e91, 0x740b4014, 0x8e48a85c, 0xb24ce50e, 0x03ef5b87, 0xe85c7afb, 0x8d9bd6ca,
+    0x3d3f9d6d, 0x6a0c02bb, 0xad4f6e19, 0x325c64db, 0xe6877908, 0xb6e5f089, 0xaafb638a, 0xaab6e406,
+    0x6855ce56, 0x596cb256, 0x35e76b2e, 0x3d8af2ae, 0x23a09496, 0x2ac8b3c3, 0xf8c632ff, 0xb2d51ec8,
+    0xf40299ce, 0x4d1c44a4, 0x90ef8da3, 0xfba1c308, 0x96a2c661, 0x746c9d6c, 0x3c59c8e0, 0x653c0bfe,
+    0x911b6c48, 0x98d2848e, 0x13fb6953, 0xc565002c, 0xc09b8405, 0xfbe4b426, 0xc5c137f9, 0xb08a3cc9,
+    0x5bc7c7d9, 0xeb9f627f, 0x4f3c532b, 0xca23f2d8, 0x57c4944f, 0x049f1a06, 0x6847cd16, 0xbb095a08,
+    0x68b4754b, 0x73d34e79, 0x97656cc3, 0x06cb111d, 0xae6f10cf, 0x28bdf54b, 0x7f8f5752, 0x3b7a1aa8,
+    0x219f5093, 0x3280126b, 0x02dc423f, 0x8108096b, 0x8f86331c, 0xd04d1b94, 0x13e6fb95, 0xfd87a303,
+    0xf7bb2b26, 0x2871f592, 0xb6eeecbe, 0x5bd22369, 0x01165b69, 0xc4079edf, 0x92a00673, 0x174a42cc,
+    0x3f13f4e3, 0xa7a6d3b2, 0xe699e345, 0xb5145f14, 0x172b3485, 0xa92d4e8a, 0x6bc265fe, 0x82770a37,
+    0x4e04e2c4, 0xa6b897d8, 0xe8cb9afa, 0xed3e2b67, 0x209c26f8, 0x96519dd7, 0x38e7c4b2, 0xe65f073c,
+    0xc9a246f2, 0xd3a8d03c, 0x36491d4a, 0xdda4f3b0, 0x08400fcc, 0x64b1e395, 0x86e6b795, 0xeaaf4fba,
+    0x23ad6bad, 0x8eaff634, 0x9c52a3eb, 0x70ea2dfd, 0x84dcc1c7, 0x45f7d13d, 0xaf30118d, 0x6931b9e1,
+    0x6bb5ba8e, 0x2eb67620, 0xa3f6365b, 0x5fa4f116, 0x0f56e2e9, 0xf0afa515, 0xbb5fe8e9, 0xb7646777,
+    0xbeab1149, 0xe9966f07, 0x71f1f1d4, 0x3cd2167a, 0x679737c7, 0x437d563c, 0x5564a7f7, 0x6ba8674f,
+    0xb6986e30, 0xe1efefb5, 0xd257429b, 0x7e5423c8, 0x4997cf2c, 0x31d6e600, 0xda2e5ee5, 0x338c5071,
+};
+
+namespace {
+// roll gear hash of data, only the last 32 bytes count
+uint32_t roll(const uint8_t *data, size_t len) {
+  uint32_t h = 0;
+  for (size_t i = 0; i < len; i++) {
+    h = (h << 1) + gear[data[i]];
+  }
+  return h;
+}
+
+size_t find_generic(const uint8_t *data, size_t len, uint32_t &fp, uint32_t mask) {
+  auto h = fp;
+  for (size_t i = 0; i < len; i++) {
+    h = (h << 1) + gear[data[i]];
+    if ((h & mask) == 0) {
+      fp = h;
+      return i;
+    }
+  }
+  fp = h;
+  return len;
+}
+
+find_function find_function_for() {
+#if defined(BELA_HASH_X86)
+  if (internal::cpu().avx512vbmi) {
+    return find_avx512;
+  }
+#endif
+  return find_generic;
+}
+
+size_t find(const uint8_t *data, size_t len, uint32_t &fp, uint32_t mask) {
+  static const auto fn = find_function_for();
+  return fn(data, len, fp, mask);
+}
+
+// maskOf the top bits of the 32-bit hash depend on most of the 32-byte window
+constexpr uint32_t maskOf(int bits) { return ~uint32_t{0} << (32 - std::clamp(bits, 1, 32)); }
+} // namespace
+} // namespace cdc
+
+bool Chunker::Initialize(const ChunkOptions &opts, bela::error_code &ec) {
+  if (opts.MinSize < 64 || opts.MinSize > opts.AvgSize || opts.AvgSize > opts.MaxSize ||
+      opts.AvgSize > (1u << 30)) {
+    ec = bela::make_error_code(ErrGeneral, L"chunker: want 64 <= MinSize <= AvgSize <= MaxSize, AvgSize <= 1 GiB");
+    return false;
+  }
+  options = opts;
+  // normalized chunking level 2: sizes gather around AvgSize
+  auto bits = std::bit_width(opts.AvgSize) - 1;
+  maskSmall = cdc::maskOf(bits + 2);
+  maskLarge = cdc::maskOf(bits - 2);
+  h.Initialize();
+  fp = 0;
+  fpValid = false;
+  offset = 0;
+  length = 0;
+  memset(history, 0, sizeof(history));
+  return true;
+}
+
+void Chunker::cut(std::vector<Chunk> &chunks) {
+  auto &c = chunks.emplace_back();
+  c.Offset = offset;
+  c.Length = length;
+  h.Finalize(c.Digest, sizeof(c.Digest));
+  h.Initialize();
+  offset += length;
+  length = 0;
+  fpValid = false;
+}
+
+void Chunker::Update(const void *data, size_t len, std::vector<Chunk> &chunks) {
+  auto p = reinterpret_cast<const uint8_t *>(data);
+  size_t pos = 0;
+  while (pos < len) {
+    auto rest = len - pos;
+    // bytes before MinSize - 1 are never a boundary
+    if (length + 1 < options.MinSize) {
+      auto n = (std::min)(rest, static_cast<size_t>(options.MinSize - 1 - length));
+      h.Update(p + pos, n);
+      pos += n;
+      length += static_cast<uint32_t>(n);
+      continue;
+    }
+    if (!fpValid) {
+      // hash of the 32 bytes before pos, MinSize >= 64 keeps them in the stream
+      uint8_t window[32];
+      if (pos >= sizeof(window)) {
+        memcpy(window, p + pos - sizeof(window), sizeof(window));
+      } else {
+        memcpy(window, history + pos, sizeof(window) - pos);
+        memcpy(window + sizeof(window) - pos, p, pos);
+      }
+      fp = cdc::roll(window, sizeof(window));
+      fpValid = true;
+    }
+    auto small = length + 1 < options.AvgSize;
+    auto limit = small ? options.AvgSize - 1 - length : options.MaxSize - length;
+    auto n = (std::min)(rest, static_cast<size_t>(limit));
+    auto i = cdc::find(p + pos, n, fp, small ? maskSmall : maskLarge);
+    if (i < n) {
+      h.Update(p + pos, i + 1);
+      pos += i + 1;
+      length += static_cast<uint32_t>(i + 1);
+      cut(chunks);
+      continue;
+    }
+    h.Update(p + pos, n);
+    pos += n;
+    length += static_cast<uint32_t>(n);
+    if (length == options.MaxSize) {
+      cut(chunks);
+    }
+  }
+  // keep the last 32 bytes for a boundary search that starts early in the next Update
+  if (len >= sizeof(history)) {
+    memcpy(history, p + len - sizeof(history), sizeof(history));
+  } else {
+    memmove(history, history + len, sizeof(history) - len);
+    memcpy(history + sizeof(history) - len, p, len);
+  }
+}
+
+void Chunker::Finalize(std::vector<Chunk> &chunks) {
+  if (length != 0) {
+    cut(chunks);
+  }
+  h.Initialize();
+  fp = 0;
+  fpValid = false;
+  offset = 0;
+  memset(history, 0, sizeof(history));
+}
+
+bool ChunkFile(std::wstring_view file, const ChunkOptions &opts, std::vector<Chunk> &chunks, bela::error_code &ec) {
+  Chunker chunker;
+  if (!chunker.Initialize(opts, ec)) {
+    return false;
+  }
+  if (!ReadBlocks(
+          file, HashFileOptions{}, [&](const void *data, size_t len) { chunker.Update(data, len, chunks); }, nullptr,
+          ec)) {
+    return false;
+  }
+  chunker.Finalize(chunks);
+  return true;
+}
+} // namespace bela::hash
@@ -0,0 +1,99 @@
+// runtime CPU feature detection of hardware hash backends
+#include "hashinternal.hpp"
+#if defined(BELA_HASH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(BELA_HASH_ARM64)
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+namespace bela::hash::internal {
+namespace {
+#if defined(BELA_HASH_X86)
+void cpuidex(uint32_t out[4], uint32_t leaf, uint32_t subleaf) {
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; i++) {
+    out[i] = static_cast<uint32_t>(regs[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, out[0], out[1], out[2], out[3]);
+#endif
+}
+
+uint64_t xgetbv0() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t eax = 0;
+  uint32_t edx = 0;
+  __asm__ __volatile__("xgetbv\n" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+cpu_features detect() {
+  cpu_features features;
+#if defined(BELA_HASH_X86)
+  uint32_t regs[4] = {0};
+  cpuidex(regs, 0, 0);
+  auto maxLeaf = regs[0];
+  // XCR0: xmm|ymm (0x6), opmask|zmm_hi256|hi16_zmm (0xE0)
+  uint64_t xcr0 = 0;
+  if (maxLeaf >= 1) {
+    cpuidex(regs, 1, 0);
+    features.ssse3 = (regs[2] & (1u << 9)) != 0;
+    features.sse41 = (regs[2] & (1u << 19)) != 0;
+    if ((regs[2] & (1u << 27)) != 0) {
+      xcr0 = xgetbv0();
+    }
+  }
+  if (maxLeaf >= 7) {
+    cpuidex(regs, 7, 0);
+    features.sha = (regs[1] & (1u << 29)) != 0;
+    features.avx2 = (regs[1] & (1u << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    features.avx512 = features.avx2 && (regs[1] & (1u << 16)) != 0 && (regs[1] & (1u << 30)) != 0 &&
+                      (xcr0 & 0xE6) == 0xE6;
+    features.avx512vbmi = features.avx512 && (regs[2] & (1u << 1)) != 0;
+  }
+#elif defined(BELA_HASH_ARM64)
+#if defined(_WIN32)
+  features.arm_sha2 = IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != FALSE;
+#if defined(PF_ARM_SHA3_INSTRUCTIONS_AVAILABLE)
+  features.arm_sha3 = IsProcessorFeaturePresent(PF_ARM_SHA3_INSTRUCTIONS_AVAILABLE) != FALSE;
+#endif
+#elif defined(__APPLE__)
+  features.arm_sha2 = true; // every Apple arm64 CPU has the crypto extensions
+  int sha3 = 0;
+  size_t len = sizeof(sha3);
+  features.arm_sha3 = sysctlbyname("hw.optional.armv8_2_sha3", &sha3, &len, nullptr, 0) == 0 && sha3 != 0;
+#elif defined(__linux__)
+#if defined(HWCAP_SHA2)
+  features.arm_sha2 = (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+#endif
+#if defined(HWCAP_SHA3)
+  features.arm_sha3 = (getauxval(AT_HWCAP) & HWCAP_SHA3) != 0;
+#endif
+#endif
+#endif
+  return features;
+}
+} // namespace
+
+const cpu_features &cpu() {
+  static const cpu_features features = detect();
+  return features;
+}
+} // namespace bela::hash::internal
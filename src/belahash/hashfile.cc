@@ -0,0 +1,217 @@
+// file reading for hashers: mapped windows or overlapped double-buffered reads
+#include <bela/hashfile.hpp>
+#include <bela/io.hpp>
+#include <algorithm>
+
+namespace bela::hash {
+namespace {
+// multiple of every sector size, FILE_FLAG_NO_BUFFERING needs aligned offsets and lengths
+constexpr size_t ioAlignment = 64 * 1024;
+
+size_t alignedSize(size_t n) { return (std::max)((n + ioAlignment - 1) & ~(ioAlignment - 1), ioAlignment); }
+
+// alignedBuffer page aligned memory from VirtualAlloc
+class alignedBuffer {
+public:
+  alignedBuffer() = default;
+  alignedBuffer(const alignedBuffer &) = delete;
+  alignedBuffer &operator=(const alignedBuffer &) = delete;
+  ~alignedBuffer() {
+    if (data != nullptr) {
+      VirtualFree(data, 0, MEM_RELEASE);
+    }
+  }
+  bool Allocate(size_t n, bela::error_code &ec) {
+    if (data = static_cast<uint8_t *>(VirtualAlloc(nullptr, n, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+        data == nullptr) {
+      ec = bela::make_system_error_code(L"VirtualAlloc(): ");
+      return false;
+    }
+    return true;
+  }
+  uint8_t *data{nullptr};
+};
+
+// overlappedReader two reads in flight at most, the next buffer is filled while the current one is consumed
+class overlappedReader {
+public:
+  overlappedReader(HANDLE fd_) : fd(fd_) {}
+  overlappedReader(const overlappedReader &) = delete;
+  overlappedReader &operator=(const overlappedReader &) = delete;
+  ~overlappedReader() {
+    for (auto &s : slots) {
+      if (s.pending) {
+        CancelIoEx(fd, &s.ov);
+        DWORD n = 0;
+        GetOverlappedResult(fd, &s.ov, &n, TRUE);
+      }
+      if (s.ov.hEvent != nullptr) {
+        CloseHandle(s.ov.hEvent);
+      }
+    }
+  }
+  bool Initialize(size_t bufferSize_, bela::error_code &ec) {
+    bufferSize = bufferSize_;
+    for (auto &s : slots) {
+      if (!s.buffer.Allocate(bufferSize, ec)) {
+        return false;
+      }
+      if (s.ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr); s.ov.hEvent == nullptr) {
+        ec = bela::make_system_error_code(L"CreateEventW(): ");
+        return false;
+      }
+    }
+    return true;
+  }
+  bool Issue(int i, int64_t offset, bela::error_code &ec) {
+    auto &s = slots[i];
+    LARGE_INTEGER li{.QuadPart = offset};
+    s.ov.Offset = li.LowPart;
+    s.ov.OffsetHigh = static_cast<DWORD>(li.HighPart);
+    if (::ReadFile(fd, s.buffer.data, static_cast<DWORD>(bufferSize), nullptr, &s.ov) != TRUE) {
+      if (auto e = GetLastError(); e != ERROR_IO_PENDING && e != ERROR_HANDLE_EOF) {
+        ec = bela::make_system_error_code(L"ReadFile(): ");
+        return false;
+      }
+    }
+    s.pending = true;
+    return true;
+  }
+  // Wait returns bytes read, 0 at EOF
+  bool Wait(int i, size_t &n, bela::error_code &ec) {
+    auto &s = slots[i];
+    DWORD got = 0;
+    s.pending = false;
+    if (GetOverlappedResult(fd, &s.ov, &got, TRUE) != TRUE) {
+      if (GetLastError() != ERROR_HANDLE_EOF) {
+        ec = bela::make_system_error_code(L"ReadFile(): ");
+        return false;
+      }
+      got = 0;
+    }
+    n = got;
+    return true;
+  }
+  const uint8_t *Data(int i) const { return slots[i].buffer.data; }
+
+private:
+  struct slot {
+    alignedBuffer buffer;
+    OVERLAPPED ov{};
+    bool pending{false};
+  };
+  HANDLE fd;
+  size_t bufferSize{0};
+  slot slots[2];
+};
+
+bool readMapped(HANDLE fd, int64_t size, size_t window, const std::function<void(const void *data, size_t len)> &fn,
+                HashFileStats &st, bela::error_code &ec) {
+  bela::io::MemView mv;
+  if (!mv.Map(fd, size, ec)) {
+    return false;
+  }
+  auto base = mv.data();
+  auto length = mv.size();
+  for (size_t offset = 0; offset < length; offset += window) {
+    auto n = (std::min)(length - offset, window);
+    // same as madvise(MADV_WILLNEED), page the next window in while this one is hashed
+    if (auto next = offset + n; next < length) {
+      WIN32_MEMORY_RANGE_ENTRY range{.VirtualAddress = const_cast<uint8_t *>(base + next),
+                                     .NumberOfBytes = (std::min)(length - next, window)};
+      PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+    fn(base + offset, n);
+    st.Bytes += static_cast<int64_t>(n);
+    st.Reads++;
+  }
+  return true;
+}
+
+bool readOverlapped(HANDLE fd, int64_t size, size_t bufferSize,
+                    const std::function<void(const void *data, size_t len)> &fn, HashFileStats &st,
+                    bela::error_code &ec) {
+  overlappedReader reader(fd);
+  if (!reader.Initialize(bufferSize, ec)) {
+    return false;
+  }
+  int64_t offset = 0;
+  if (size > 0) {
+    if (!reader.Issue(0, offset, ec)) {
+      return false;
+    }
+    offset += static_cast<int64_t>(bufferSize);
+  }
+  for (int cur = 0; st.Bytes < size; cur ^= 1) {
+    size_t n = 0;
+    if (!reader.Wait(cur, n, ec)) {
+      return false;
+    }
+    // file truncated while reading
+    if (n == 0) {
+      break;
+    }
+    // the next read was placed after a full buffer
+    if (n < bufferSize && st.Bytes + static_cast<int64_t>(n) < size) {
+      ec = bela::make_error_code(ErrGeneral, L"short read at ", st.Bytes, L" of ", size);
+      return false;
+    }
+    st.Reads++;
+    if (offset < size) {
+      if (!reader.Issue(cur ^ 1, offset, ec)) {
+        return false;
+      }
+      offset += static_cast<int64_t>(bufferSize);
+    }
+    // the file may have grown since open
+    n = static_cast<size_t>((std::min)(static_cast<int64_t>(n), size - st.Bytes));
+    fn(reader.Data(cur), n);
+    st.Bytes += static_cast<int64_t>(n);
+  }
+  return true;
+}
+} // namespace
+
+bool ReadBlocks(std::wstring_view file, const HashFileOptions &opts,
+                const std::function<void(const void *data, size_t len)> &fn, HashFileStats *stats,
+                bela::error_code &ec) {
+  auto begin = std::chrono::steady_clock::now();
+  HashFileStats st;
+  auto bufferSize = alignedSize(opts.BufferSize);
+  auto fd = bela::io::NewFile(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr, ec);
+  if (!fd) {
+    return false;
+  }
+  auto size = fd->Size(ec);
+  if (size == bela::SizeUnInitialized) {
+    return false;
+  }
+  st.Mode = opts.Mode;
+  if (st.Mode == ReadMode::Auto) {
+    st.Mode = size >= opts.UnbufferedThreshold ? ReadMode::Unbuffered : ReadMode::Map;
+  }
+  bool result = false;
+  if (st.Mode == ReadMode::Map) {
+    result = readMapped(fd->NativeFD(), size, bufferSize, fn, st, ec);
+  } else {
+    DWORD flags = FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN;
+    if (st.Mode == ReadMode::Unbuffered) {
+      flags |= FILE_FLAG_NO_BUFFERING;
+    }
+    if (auto h = ReOpenFile(fd->NativeFD(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, flags);
+        h != INVALID_HANDLE_VALUE) {
+      fd->Assgin(h);
+      result = readOverlapped(h, size, bufferSize, fn, st, ec);
+    } else {
+      ec = bela::make_system_error_code(L"ReOpenFile(): ");
+    }
+  }
+  st.Elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+  if (stats != nullptr) {
+    *stats = st;
+  }
+  return result;
+}
+
+} // namespace bela::hash
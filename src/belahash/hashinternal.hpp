@@ -112,4 +112,171 @@ inline void swap_copy_u64_to_str(void *to, const void *from, size_t length) {
 #define IS_ALIGNED_32(p) (0 == (3 & ((const char *)(p) - (const char *)0)))
 #define IS_ALIGNED_64(p) (0 == (7 & ((const char *)(p) - (const char *)0)))
 
-#endif
\ No newline at end of file
+// SHA2_ROUNDS_16 16 rounds of SHA-256/SHA-512 with rotating working variables A..H, W(n) yields message word n
+#define SHA2_ROUNDS_16(ROUND, W)                                                                                      \
+  ROUND(A, B, C, D, E, F, G, H, 0, W(0));                                                                              \
+  ROUND(H, A, B, C, D, E, F, G, 1, W(1));                                                                              \
+  ROUND(G, H, A, B, C, D, E, F, 2, W(2));                                                                              \
+  ROUND(F, G, H, A, B, C, D, E, 3, W(3));                                                                              \
+  ROUND(E, F, G, H, A, B, C, D, 4, W(4));                                                                              \
+  ROUND(D, E, F, G, H, A, B, C, 5, W(5));                                                                              \
+  ROUND(C, D, E, F, G, H, A, B, 6, W(6));                                                                              \
+  ROUND(B, C, D, E, F, G, H, A, 7, W(7));                                                                              \
+  ROUND(A, B, C, D, E, F, G, H, 8, W(8));                                                                              \
+  ROUND(H, A, B, C, D, E, F, G, 9, W(9));                                                                              \
+  ROUND(G, H, A, B, C, D, E, F, 10, W(10));                                                                            \
+  ROUND(F, G, H, A, B, C, D, E, 11, W(11));                                                                            \
+  ROUND(E, F, G, H, A, B, C, D, 12, W(12));                                                                            \
+  ROUND(D, E, F, G, H, A, B, C, 13, W(13));                                                                            \
+  ROUND(C, D, E, F, G, H, A, B, 14, W(14));                                                                            \
+  ROUND(B, C, D, E, F, G, H, A, 15, W(15));
+
+// KECCAK_ROUND one Keccak-f[1600] round from A[0..24] into E[0..24], lane x + 5y. the includer defines for its lane
+// type KECCAK_XOR, KECCAK_XOR5, KECCAK_ROL1XOR(a, b) a ^ rotl(b, 1) and KECCAK_XORROL(a, b, n) rotl(a ^ b, n), CHI_ROW(E,
+// y, rc) writes row y of E from B0..B4 after theta, rho and pi, iota with rc on row 0
+#define KECCAK_ROUND(A, E, rc, CHI_ROW)                                                                                \
+  do {                                                                                                                 \
+    auto Ca = KECCAK_XOR5(A[0], A[5], A[10], A[15], A[20]);                                                            \
+    auto Ce = KECCAK_XOR5(A[1], A[6], A[11], A[16], A[21]);                                                            \
+    auto Ci = KECCAK_XOR5(A[2], A[7], A[12], A[17], A[22]);                                                            \
+    auto Co = KECCAK_XOR5(A[3], A[8], A[13], A[18], A[23]);                                                            \
+    auto Cu = KECCAK_XOR5(A[4], A[9], A[14], A[19], A[24]);                                                            \
+    auto Da = KECCAK_ROL1XOR(Cu, Ce);                                                                                  \
+    auto De = KECCAK_ROL1XOR(Ca, Ci);                                                                                  \
+    auto Di = KECCAK_ROL1XOR(Ce, Co);                                                                                  \
+    auto Do = KECCAK_ROL1XOR(Ci, Cu);                                                                                  \
+    auto Du = KECCAK_ROL1XOR(Co, Ca);                                                                                  \
+    auto B0 = KECCAK_XOR(A[0], Da);                                                                                    \
+    auto B1 = KECCAK_XORROL(A[6], De, 44);                                                                             \
+    auto B2 = KECCAK_XORROL(A[12], Di, 43);                                                                            \
+    auto B3 = KECCAK_XORROL(A[18], Do, 21);                                                                            \
+    auto B4 = KECCAK_XORROL(A[24], Du, 14);                                                                            \
+    CHI_ROW(E, 0, rc);                                                                                                 \
+    B0 = KECCAK_XORROL(A[3], Do, 28);                                                                                  \
+    B1 = KECCAK_XORROL(A[9], Du, 20);                                                                                  \
+    B2 = KECCAK_XORROL(A[10], Da, 3);                                                                                  \
+    B3 = KECCAK_XORROL(A[16], De, 45);                                                                                 \
+    B4 = KECCAK_XORROL(A[22], Di, 61);                                                                                 \
+    CHI_ROW(E, 1, rc);                                                                                                 \
+    B0 = KECCAK_XORROL(A[1], De, 1);                                                                                   \
+    B1 = KECCAK_XORROL(A[7], Di, 6);                                                                                   \
+    B2 = KECCAK_XORROL(A[13], Do, 25);                                                                                 \
+    B3 = KECCAK_XORROL(A[19], Du, 8);                                                                                  \
+    B4 = KECCAK_XORROL(A[20], Da, 18);                                                                                 \
+    CHI_ROW(E, 2, rc);                                                                                                 \
+    B0 = KECCAK_XORROL(A[4], Du, 27);                                                                                  \
+    B1 = KECCAK_XORROL(A[5], Da, 36);                                                                                  \
+    B2 = KECCAK_XORROL(A[11], De, 10);                                                                                 \
+    B3 = KECCAK_XORROL(A[17], Di, 15);                                                                                 \
+    B4 = KECCAK_XORROL(A[23], Do, 56);                                                                                 \
+    CHI_ROW(E, 3, rc);                                                                                                 \
+    B0 = KECCAK_XORROL(A[2], Di, 62);                                                                                  \
+    B1 = KECCAK_XORROL(A[8], Do, 55);                                                                                  \
+    B2 = KECCAK_XORROL(A[14], Du, 39);                                                                                 \
+    B3 = KECCAK_XORROL(A[15], Da, 41);                                                                                 \
+    B4 = KECCAK_XORROL(A[21], De, 2);                                                                                  \
+    CHI_ROW(E, 4, rc);                                                                                                 \
+  } while (0)
+
+// KECCAK_CHI_ROW plain chi a ^ (~b & c) with KECCAK_CHI(a, b, c) of the lane type
+#define KECCAK_CHI_ROW(E, y, rc)                                                                                       \
+  E[5 * (y)] = KECCAK_CHI(B0, B1, B2);                                                                                 \
+  E[5 * (y) + 1] = KECCAK_CHI(B1, B2, B3);                                                                             \
+  E[5 * (y) + 2] = KECCAK_CHI(B2, B3, B4);                                                                             \
+  E[5 * (y) + 3] = KECCAK_CHI(B3, B4, B0);                                                                             \
+  E[5 * (y) + 4] = KECCAK_CHI(B4, B0, B1);                                                                             \
+  if ((y) == 0) {                                                                                                      \
+    E[0] = KECCAK_XOR(E[0], rc);                                                                                       \
+  }
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BELA_HASH_X86 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define BELA_HASH_ARM64 1
+#endif
+
+namespace bela::hash::internal {
+// cpu_features instruction set extensions used by hardware backends, detected once at first use
+struct cpu_features {
+  bool ssse3{false};
+  bool sse41{false};
+  bool sha{false};      // x86 SHA extensions (SHA-NI)
+  bool avx2{false};     // AVX2 with OS support of ymm state
+  bool avx512{false};   // AVX-512 F and BW with OS support of zmm state
+  bool avx512vbmi{false};
+  bool arm_sha2{false}; // ARMv8 SHA-256 crypto extensions
+  bool arm_sha3{false}; // ARMv8.2 SHA3 extensions (EOR3, RAX1, XAR, BCAX)
+};
+const cpu_features &cpu();
+} // namespace bela::hash::internal
+
+namespace bela::hash::sha256 {
+extern const uint32_t k256[64];
+// block_function compress blocks * 64 bytes of data into hash, data has no alignment requirement
+using block_function = void (*)(uint32_t hash[8], const uint8_t *data, size_t blocks);
+// lanes_function compress one block of every lane, state is word major: state[word * lanes + lane]
+using lanes_function = void (*)(uint32_t *state, const uint8_t *const *blocks);
+// hardware_block_function SHA-NI or ARMv8 SHA2 compression, nullptr when the CPU has neither
+block_function hardware_block_function();
+// kernels are built with their instruction set enabled, call them only after checking internal::cpu()
+#if defined(BELA_HASH_X86)
+void process_blocks_shani(uint32_t hash[8], const uint8_t *data, size_t blocks);
+void lanes_avx2(uint32_t *state, const uint8_t *const *blocks);   // 8 lanes
+void lanes_avx512(uint32_t *state, const uint8_t *const *blocks); // 16 lanes
+#elif defined(BELA_HASH_ARM64)
+void process_blocks_armv8(uint32_t hash[8], const uint8_t *data, size_t blocks);
+#endif
+} // namespace bela::hash::sha256
+
+namespace bela::hash::sha512 {
+extern const uint64_t k512[80];
+using lanes_function = void (*)(uint64_t *state, const uint8_t *const *blocks);
+#if defined(BELA_HASH_X86)
+void lanes_avx2(uint64_t *state, const uint8_t *const *blocks);   // 4 lanes
+void lanes_avx512(uint64_t *state, const uint8_t *const *blocks); // 8 lanes
+#endif
+} // namespace bela::hash::sha512
+
+namespace bela::hash::sha3 {
+extern const uint64_t keccak_round_constants[24];
+// absorb_function xor blocks * block_size bytes into state, one Keccak-f[1600] after each block
+using absorb_function = void (*)(uint64_t state[25], const uint8_t *data, size_t blocks, size_t block_size);
+// lanes_function absorb one block of every lane, state is word major: state[word * lanes + lane]
+using lanes_function = void (*)(uint64_t *state, const uint8_t *const *blocks, size_t block_size);
+// absorb_function_for best single state Keccak of this CPU
+absorb_function absorb_function_for();
+#if defined(BELA_HASH_X86)
+void lanes_avx2(uint64_t *state, const uint8_t *const *blocks, size_t block_size);   // 4 lanes
+void lanes_avx512(uint64_t *state, const uint8_t *const *blocks, size_t block_size); // 8 lanes
+void absorb_avx512(uint64_t state[25], const uint8_t *data, size_t blocks, size_t block_size);
+#elif defined(BELA_HASH_ARM64) && !defined(_MSC_VER)
+// MSVC has no SHA3 intrinsics
+#define BELA_HASH_ARM64_SHA3 1
+void lanes_armv8(uint64_t *state, const uint8_t *const *blocks, size_t block_size); // 2 lanes
+void absorb_armv8(uint64_t state[25], const uint8_t *data, size_t blocks, size_t block_size);
+#endif
+} // namespace bela::hash::sha3
+
+namespace bela::hash::cdc {
+// gear table of the chunk boundaries, changing it moves every cut point
+extern const uint32_t gear[256];
+// find_function index of the first data[i] whose gear hash has no bit of mask set, len if none. fp: hash of the byte
+// before data, on return hash of the byte at the returned index (or the last byte)
+using find_function = size_t (*)(const uint8_t *data, size_t len, uint32_t &fp, uint32_t mask);
+#if defined(BELA_HASH_X86)
+size_t find_avx512(const uint8_t *data, size_t len, uint32_t &fp, uint32_t mask); // AVX-512 VBMI
+#endif
+} // namespace bela::hash::cdc
+
+namespace bela::hash::hex {
+// kernels convert whole 16-byte groups and return the bytes done, the caller converts the rest. decode stops at the
+// first group with a non-hex digit
+#if defined(BELA_HASH_X86)
+size_t encode_avx2(const uint8_t *b, size_t len, char *out);
+size_t encode_avx2(const uint8_t *b, size_t len, wchar_t *out);
+size_t decode_avx2(const char *in, size_t len, uint8_t *out);
+size_t decode_avx2(const wchar_t *in, size_t len, uint8_t *out);
+#endif
+} // namespace bela::hash::hex
+
+#endif
@@ -0,0 +1,316 @@
+// hasher state serialization, layout (little endian):
+//   'B' 'H' version:u8 algorithm:u8 | algorithm state | buffered bytes
+// sha256/sha512: length:u64 hash:u32[8]/u64[8] buffer[length % block size]
+// sha3:          hash:u64[25] rest:u32 buffer[rest]
+// sm3:           length:u64 digest:u32[8] buffer[length % 64]
+// blake3:        key:u32[8] cv:u32[8] chunk_counter:u64 blocks_compressed:u8 flags:u8 buf_len:u8 buf[buf_len]
+//                cv_stack_len:u8 cv_stack[cv_stack_len * 32]
+#include <bela/hash.hpp>
+#include <bela/endian.hpp>
+#include <cstring>
+#include <bit>
+
+namespace bela::hash {
+namespace {
+constexpr uint8_t stateMagic[2] = {'B', 'H'};
+constexpr uint8_t stateVersion = 1;
+// stable algorithm ids, never renumber
+enum class stateAlgorithm : uint8_t {
+  SHA224 = 1,
+  SHA256 = 2,
+  SHA384 = 3,
+  SHA512 = 4,
+  SHA3_224 = 5,
+  SHA3_256 = 6,
+  SHA3_384 = 7,
+  SHA3_512 = 8,
+  BLAKE3 = 9,
+  SM3 = 10,
+};
+
+class stateWriter {
+public:
+  explicit stateWriter(stateAlgorithm a) {
+    b.assign(std::begin(stateMagic), std::end(stateMagic));
+    b.push_back(stateVersion);
+    b.push_back(static_cast<uint8_t>(a));
+  }
+  template <typename T>
+    requires std::integral<T>
+  void Write(T v) {
+    v = bela::fromle(v);
+    auto p = reinterpret_cast<const uint8_t *>(&v);
+    b.insert(b.end(), p, p + sizeof(T));
+  }
+  template <typename T, size_t N> void Write(const T (&a)[N]) {
+    for (auto v : a) {
+      Write(v);
+    }
+  }
+  void WriteBytes(const void *p, size_t n) {
+    auto u = reinterpret_cast<const uint8_t *>(p);
+    b.insert(b.end(), u, u + n);
+  }
+  std::vector<uint8_t> Take() { return std::move(b); }
+
+private:
+  std::vector<uint8_t> b;
+};
+
+class stateReader {
+public:
+  stateReader(std::span<const uint8_t> data) : r(data.data(), data.size()) {}
+  // Header check magic and version, algorithm of the state
+  bool Header(stateAlgorithm &a, bela::error_code &ec) {
+    if (r.Size() < 4 || memcmp(r.Data(), stateMagic, sizeof(stateMagic)) != 0) {
+      ec = bela::make_error_code(ErrGeneral, L"hash state: bad magic");
+      return false;
+    }
+    r.Discard(2);
+    if (auto version = r.Pick(); version != stateVersion) {
+      ec = bela::make_error_code(ErrGeneral, L"hash state: unsupported version ", static_cast<int>(version));
+      return false;
+    }
+    a = static_cast<stateAlgorithm>(r.Pick());
+    return true;
+  }
+  template <typename T>
+    requires std::integral<T>
+  bool Read(T &v, bela::error_code &ec) {
+    if (r.Size() < sizeof(T)) {
+      ec = bela::make_error_code(ErrGeneral, L"hash state: truncated");
+      return false;
+    }
+    v = r.Read<T>();
+    return true;
+  }
+  template <typename T, size_t N> bool Read(T (&a)[N], bela::error_code &ec) {
+    for (auto &v : a) {
+      if (!Read(v, ec)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool ReadBytes(void *p, size_t n, bela::error_code &ec) {
+    if (r.Size() < n) {
+      ec = bela::make_error_code(ErrGeneral, L"hash state: truncated");
+      return false;
+    }
+    memcpy(p, r.Data(), n);
+    r.Discard(n);
+    return true;
+  }
+  bool End(bela::error_code &ec) const {
+    if (r.Size() != 0) {
+      ec = bela::make_error_code(ErrGeneral, L"hash state: ", r.Size(), L" trailing bytes");
+      return false;
+    }
+    return true;
+  }
+
+private:
+  bela::endian::LittenEndian r;
+};
+
+inline bela::error_code unsupportedAlgorithm(stateAlgorithm a) {
+  return bela::make_error_code(ErrGeneral, L"hash state: algorithm ", static_cast<int>(a), L" not for this hasher");
+}
+} // namespace
+
+std::vector<uint8_t> sha256::Hasher::MarshalBinary() const {
+  stateWriter w(hb == HashBits::SHA224 ? stateAlgorithm::SHA224 : stateAlgorithm::SHA256);
+  w.Write(length);
+  w.Write(hash);
+  w.WriteBytes(message, static_cast<size_t>(length % sha256_block_size));
+  return w.Take();
+}
+
+bool sha256::Hasher::UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec) {
+  stateReader r(data);
+  stateAlgorithm a;
+  if (!r.Header(a, ec)) {
+    return false;
+  }
+  if (a != stateAlgorithm::SHA224 && a != stateAlgorithm::SHA256) {
+    ec = unsupportedAlgorithm(a);
+    return false;
+  }
+  Hasher s;
+  s.Initialize(a == stateAlgorithm::SHA224 ? HashBits::SHA224 : HashBits::SHA256);
+  if (!r.Read(s.length, ec) || !r.Read(s.hash, ec) ||
+      !r.ReadBytes(s.message, static_cast<size_t>(s.length % sha256_block_size), ec) || !r.End(ec)) {
+    return false;
+  }
+  *this = s;
+  return true;
+}
+
+std::vector<uint8_t> sha512::Hasher::MarshalBinary() const {
+  stateWriter w(hb == HashBits::SHA384 ? stateAlgorithm::SHA384 : stateAlgorithm::SHA512);
+  w.Write(length);
+  w.Write(hash);
+  w.WriteBytes(message, static_cast<size_t>(length % sha512_block_size));
+  return w.Take();
+}
+
+bool sha512::Hasher::UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec) {
+  stateReader r(data);
+  stateAlgorithm a;
+  if (!r.Header(a, ec)) {
+    return false;
+  }
+  if (a != stateAlgorithm::SHA384 && a != stateAlgorithm::SHA512) {
+    ec = unsupportedAlgorithm(a);
+    return false;
+  }
+  Hasher s;
+  s.Initialize(a == stateAlgorithm::SHA384 ? HashBits::SHA384 : HashBits::SHA512);
+  if (!r.Read(s.length, ec) || !r.Read(s.hash, ec) ||
+      !r.ReadBytes(s.message, static_cast<size_t>(s.length % sha512_block_size), ec) || !r.End(ec)) {
+    return false;
+  }
+  *this = s;
+  return true;
+}
+
+std::vector<uint8_t> sha3::Hasher::MarshalBinary() const {
+  constexpr stateAlgorithm algorithms[] = {stateAlgorithm::SHA3_224, stateAlgorithm::SHA3_256,
+                                           stateAlgorithm::SHA3_384, stateAlgorithm::SHA3_512};
+  auto index = hb == HashBits::SHA3224 ? 0 : hb == HashBits::SHA3256 ? 1 : hb == HashBits::SHA3384 ? 2 : 3;
+  stateWriter w(algorithms[index]);
+  w.Write(hash);
+  w.Write(rest);
+  // finalized hashers keep the flag in rest and are rejected by UnmarshalBinary
+  w.WriteBytes(message, rest < block_size ? rest : 0);
+  return w.Take();
+}
+
+bool sha3::Hasher::UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec) {
+  stateReader r(data);
+  stateAlgorithm a;
+  if (!r.Header(a, ec)) {
+    return false;
+  }
+  Hasher s;
+  switch (a) {
+  case stateAlgorithm::SHA3_224:
+    s.Initialize(HashBits::SHA3224);
+    break;
+  case stateAlgorithm::SHA3_256:
+    s.Initialize(HashBits::SHA3256);
+    break;
+  case stateAlgorithm::SHA3_384:
+    s.Initialize(HashBits::SHA3384);
+    break;
+  case stateAlgorithm::SHA3_512:
+    s.Initialize(HashBits::SHA3512);
+    break;
+  default:
+    ec = unsupportedAlgorithm(a);
+    return false;
+  }
+  if (!r.Read(s.hash, ec) || !r.Read(s.rest, ec)) {
+    return false;
+  }
+  if (s.rest >= s.block_size) {
+    ec = bela::make_error_code(ErrGeneral, L"hash state: sha3 state finalized or corrupted");
+    return false;
+  }
+  if (!r.ReadBytes(s.message, s.rest, ec) || !r.End(ec)) {
+    return false;
+  }
+  *this = s;
+  return true;
+}
+
+std::vector<uint8_t> sm3::Hasher::MarshalBinary() const {
+  stateWriter w(stateAlgorithm::SM3);
+  w.Write((static_cast<uint64_t>(Nh) << 32) | Nl);
+  w.Write(digest);
+  w.WriteBytes(block, Nl % sm3_block_size);
+  return w.Take();
+}
+
+bool sm3::Hasher::UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec) {
+  stateReader r(data);
+  stateAlgorithm a;
+  if (!r.Header(a, ec)) {
+    return false;
+  }
+  if (a != stateAlgorithm::SM3) {
+    ec = unsupportedAlgorithm(a);
+    return false;
+  }
+  Hasher s;
+  uint64_t length = 0;
+  if (!r.Read(length, ec) || !r.Read(s.digest, ec)) {
+    return false;
+  }
+  s.Nl = static_cast<uint32_t>(length);
+  s.Nh = static_cast<uint32_t>(length >> 32);
+  if (!r.ReadBytes(s.block, s.Nl % sm3_block_size, ec) || !r.End(ec)) {
+    return false;
+  }
+  *this = s;
+  return true;
+}
+
+std::vector<uint8_t> blake3::Hasher::MarshalBinary() const {
+  stateWriter w(stateAlgorithm::BLAKE3);
+  w.Write(h.key);
+  w.Write(h.chunk.cv);
+  w.Write(h.chunk.chunk_counter);
+  w.Write(h.chunk.blocks_compressed);
+  w.Write(h.chunk.flags);
+  w.Write(h.chunk.buf_len);
+  w.WriteBytes(h.chunk.buf, h.chunk.buf_len);
+  w.Write(h.cv_stack_len);
+  w.WriteBytes(h.cv_stack, static_cast<size_t>(h.cv_stack_len) * BLAKE3_OUT_LEN);
+  return w.Take();
+}
+
+bool blake3::Hasher::UnmarshalBinary(std::span<const uint8_t> data, bela::error_code &ec) {
+  stateReader r(data);
+  stateAlgorithm a;
+  if (!r.Header(a, ec)) {
+    return false;
+  }
+  if (a != stateAlgorithm::BLAKE3) {
+    ec = unsupportedAlgorithm(a);
+    return false;
+  }
+  blake3_hasher s{};
+  if (!r.Read(s.key, ec) || !r.Read(s.chunk.cv, ec) || !r.Read(s.chunk.chunk_counter, ec) ||
+      !r.Read(s.chunk.blocks_compressed, ec) || !r.Read(s.chunk.flags, ec) || !r.Read(s.chunk.buf_len, ec)) {
+    return false;
+  }
+  auto chunkLength = static_cast<size_t>(s.chunk.blocks_compressed) * BLAKE3_BLOCK_LEN + s.chunk.buf_len;
+  if (s.chunk.buf_len > BLAKE3_BLOCK_LEN || chunkLength > BLAKE3_CHUNK_LEN ||
+      s.chunk.chunk_counter >= (uint64_t{1} << BLAKE3_MAX_DEPTH)) {
+    ec = bela::make_error_code(ErrGeneral, L"hash state: blake3 chunk state corrupted");
+    return false;
+  }
+  if (!r.ReadBytes(s.chunk.buf, s.chunk.buf_len, ec) || !r.Read(s.cv_stack_len, ec)) {
+    return false;
+  }
+  // merges and pushes of the next update and finalize index the stack by its length, accept only the lengths blake3.c
+  // leaves between updates: merged to one entry per 1-bit of chunk_counter when input ends inside a chunk, otherwise
+  // the last push was a subtree pair of 2^k chunks (1 <= k <= trailing zeros) stacked unmerged on cv_stack
+  auto ones = std::popcount(s.chunk.chunk_counter);
+  auto valid = chunkLength != 0 || s.chunk.chunk_counter == 0
+                   ? s.cv_stack_len == ones
+                   : s.cv_stack_len > ones && s.cv_stack_len <= ones + std::countr_zero(s.chunk.chunk_counter);
+  if (!valid) {
+    ec = bela::make_error_code(ErrGeneral, L"hash state: blake3 cv stack length ", static_cast<int>(s.cv_stack_len),
+                               L" does not match chunk counter ", s.chunk.chunk_counter);
+    return false;
+  }
+  if (!r.ReadBytes(s.cv_stack, static_cast<size_t>(s.cv_stack_len) * BLAKE3_OUT_LEN, ec) || !r.End(ec)) {
+    return false;
+  }
+  h = s;
+  return true;
+}
+
+} // namespace bela::hash
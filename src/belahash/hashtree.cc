@@ -0,0 +1,387 @@
+// Bao outboard tree and verified slices on top of the BLAKE3 compression functions
+#include <bela/hashtree.hpp>
+#include <bela/endian.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+// blake3.h declares the same C API as bela/hash.hpp, this file only includes the former
+#include "blake3/blake3_impl.h"
+
+namespace bela::hash::blake3 {
+namespace {
+constexpr uint64_t chunkSize = BLAKE3_CHUNK_LEN;
+constexpr size_t parentSize = 2 * BLAKE3_OUT_LEN;
+constexpr size_t headerSize = 8;
+// full subtrees up to this size are hashed by blake3_hash_many at once
+constexpr uint64_t batchChunks = 64;
+
+uint64_t chunkCount(uint64_t length) { return length == 0 ? 1 : (length + chunkSize - 1) / chunkSize; }
+
+// leftChunks chunks in the left subtree: the largest power of two below count
+uint64_t leftChunks(uint64_t count) { return uint64_t{1} << (std::bit_width(count - 1) - 1); }
+
+void chunkCV(const uint8_t *data, size_t len, uint64_t counter, bool root, uint8_t out[BLAKE3_OUT_LEN]) {
+  uint32_t cv[8];
+  memcpy(cv, IV, sizeof(cv));
+  auto blocks = (std::max)((len + BLAKE3_BLOCK_LEN - 1) / BLAKE3_BLOCK_LEN, size_t{1});
+  for (size_t b = 0; b < blocks; b++) {
+    uint8_t block[BLAKE3_BLOCK_LEN] = {0};
+    auto n = (std::min)(len - b * BLAKE3_BLOCK_LEN, size_t{BLAKE3_BLOCK_LEN});
+    if (n != 0) {
+      memcpy(block, data + b * BLAKE3_BLOCK_LEN, n);
+    }
+    uint8_t flags = b == 0 ? CHUNK_START : 0;
+    if (b + 1 == blocks) {
+      flags |= CHUNK_END | (root ? ROOT : 0);
+    }
+    blake3_compress_in_place(cv, block, static_cast<uint8_t>(n), counter, flags);
+  }
+  store_cv_words(out, cv);
+}
+
+void parentCV(const uint8_t node[parentSize], bool root, uint8_t out[BLAKE3_OUT_LEN]) {
+  uint32_t cv[8];
+  memcpy(cv, IV, sizeof(cv));
+  blake3_compress_in_place(cv, node, BLAKE3_BLOCK_LEN, 0, PARENT | (root ? ROOT : 0));
+  store_cv_words(out, cv);
+}
+
+// fullTree chaining values of a full subtree level by level, each level of parents in one blake3_hash_many call
+class fullTree {
+public:
+  // Hash chunk chaining values of count whole chunks starting at chunk counter
+  void Hash(const uint8_t *const *chunks, uint64_t count, uint64_t counter, bool root, uint8_t out[BLAKE3_OUT_LEN]) {
+    blake3_hash_many(chunks, static_cast<size_t>(count), chunkSize / BLAKE3_BLOCK_LEN, IV, counter, true, 0,
+                     CHUNK_START, CHUNK_END, cvs);
+    levels = 0;
+    offsets[0] = 0;
+    auto width = static_cast<size_t>(count);
+    for (; width > 2; width /= 2) {
+      const uint8_t *inputs[batchChunks / 2];
+      for (size_t i = 0; i < width / 2; i++) {
+        inputs[i] = cvs + offsets[levels] + i * parentSize;
+      }
+      offsets[levels + 1] = offsets[levels] + width * BLAKE3_OUT_LEN;
+      blake3_hash_many(inputs, width / 2, 1, IV, 0, false, PARENT, 0, 0, cvs + offsets[levels + 1]);
+      levels++;
+    }
+    parentCV(cvs + offsets[levels], root, out);
+  }
+  // Nodes write the parent nodes in pre-order
+  void Nodes(uint8_t *&nodes) const { writeNodes(levels + 1, 0, nodes); }
+
+private:
+  // parent index of level, its children are level - 1
+  void writeNodes(int level, size_t index, uint8_t *&nodes) const {
+    memcpy(nodes, cvs + offsets[level - 1] + index * parentSize, parentSize);
+    nodes += parentSize;
+    if (level > 1) {
+      writeNodes(level - 1, index * 2, nodes);
+      writeNodes(level - 1, index * 2 + 1, nodes);
+    }
+  }
+  uint8_t cvs[batchChunks * 2 * BLAKE3_OUT_LEN];
+  size_t offsets[std::bit_width(batchChunks)];
+  int levels{0};
+};
+
+class outboardEncoder {
+public:
+  outboardEncoder(std::span<const uint8_t> content_, uint8_t *nodes_) : content(content_), nodes(nodes_) {}
+  void Encode(uint64_t start, uint64_t count, bool root, uint8_t out[BLAKE3_OUT_LEN]) {
+    if (count == 1) {
+      auto offset = start * chunkSize;
+      chunkCV(content.data() + offset, static_cast<size_t>((std::min)(content.size() - offset, chunkSize)), start,
+              root, out);
+      return;
+    }
+    // full subtrees of whole chunks, the left side of every parent and the right side away from the end
+    if (count <= batchChunks && std::has_single_bit(count) && (start + count) * chunkSize <= content.size()) {
+      const uint8_t *inputs[batchChunks] = {nullptr};
+      for (uint64_t i = 0; i < count; i++) {
+        inputs[i] = content.data() + (start + i) * chunkSize;
+      }
+      fullTree tree;
+      tree.Hash(inputs, count, start, root, out);
+      tree.Nodes(nodes);
+      return;
+    }
+    auto node = nodes;
+    nodes += parentSize;
+    auto left = leftChunks(count);
+    Encode(start, left, false, node);
+    Encode(start + left, count - left, false, node + BLAKE3_OUT_LEN);
+    parentCV(node, root, out);
+  }
+
+private:
+  std::span<const uint8_t> content;
+  uint8_t *nodes;
+};
+
+// rangeChunks first and last chunk of [start, end), an empty range or one past the end still has a chunk
+void rangeChunks(uint64_t length, uint64_t start, uint64_t end, uint64_t &first, uint64_t &last) {
+  auto count = chunkCount(length);
+  first = (std::min)(start / chunkSize, count - 1);
+  last = first;
+  if (end = (std::min)(end, length); end > start) {
+    last = (std::min)((end - 1) / chunkSize, count - 1);
+  }
+}
+
+// inSlice a subtree is in the slice when it overlaps the range or holds the final chunk, which proves the length
+bool inSlice(uint64_t start, uint64_t count, uint64_t first, uint64_t last, uint64_t total) {
+  return (start <= last && start + count > first) || start + count == total;
+}
+
+uint64_t rangeEnd(uint64_t start, uint64_t len) { return len > UINT64_MAX - start ? UINT64_MAX : start + len; }
+
+class sliceExtractor {
+public:
+  sliceExtractor(std::span<const uint8_t> content_, std::span<const uint8_t> nodes_, uint64_t first_, uint64_t last_,
+                 std::vector<uint8_t> &slice_)
+      : content(content_), nodes(nodes_), first(first_), last(last_), total(chunkCount(content_.size())),
+        slice(slice_) {}
+  void Extract(uint64_t start, uint64_t count) {
+    if (count == 1) {
+      auto offset = start * chunkSize;
+      auto data = content.data() + offset;
+      slice.insert(slice.end(), data, data + (std::min)(content.size() - offset, chunkSize));
+      return;
+    }
+    auto node = nodes.data() + cursor;
+    slice.insert(slice.end(), node, node + parentSize);
+    cursor += parentSize;
+    auto left = leftChunks(count);
+    if (inSlice(start, left, first, last, total)) {
+      Extract(start, left);
+    } else {
+      cursor += (left - 1) * parentSize;
+    }
+    if (inSlice(start + left, count - left, first, last, total)) {
+      Extract(start + left, count - left);
+    } else {
+      cursor += (count - left - 1) * parentSize;
+    }
+  }
+
+private:
+  std::span<const uint8_t> content;
+  std::span<const uint8_t> nodes;
+  uint64_t first;
+  uint64_t last;
+  uint64_t total;
+  std::vector<uint8_t> &slice;
+  size_t cursor{0};
+};
+} // namespace
+
+uint64_t OutboardSize(uint64_t length) { return headerSize + (chunkCount(length) - 1) * parentSize; }
+
+void EncodeOutboard(std::span<const uint8_t> content, std::vector<uint8_t> &outboard, uint8_t root[tree_hash_size]) {
+  outboard.resize(static_cast<size_t>(OutboardSize(content.size())));
+  auto length = bela::fromle(static_cast<uint64_t>(content.size()));
+  memcpy(outboard.data(), &length, headerSize);
+  outboardEncoder encoder(content, outboard.data() + headerSize);
+  encoder.Encode(0, chunkCount(content.size()), true, root);
+}
+
+bool ExtractSlice(std::span<const uint8_t> content, std::span<const uint8_t> outboard, uint64_t start, uint64_t len,
+                  std::vector<uint8_t> &slice, bela::error_code &ec) {
+  if (outboard.size() < headerSize || bela::cast_fromle<uint64_t>(outboard.data()) != content.size() ||
+      outboard.size() != OutboardSize(content.size())) {
+    ec = bela::make_error_code(ErrGeneral, L"outboard tree does not match content length ", content.size());
+    return false;
+  }
+  uint64_t first = 0;
+  uint64_t last = 0;
+  rangeChunks(content.size(), start, rangeEnd(start, len), first, last);
+  slice.clear();
+  slice.insert(slice.end(), outboard.data(), outboard.data() + headerSize);
+  sliceExtractor extractor(content, outboard.subspan(headerSize), first, last, slice);
+  extractor.Extract(0, chunkCount(content.size()));
+  return true;
+}
+
+SliceDecoder::SliceDecoder(const uint8_t root[tree_hash_size], uint64_t start_, uint64_t len_)
+    : start(start_), end(rangeEnd(start_, len_)) {
+  memcpy(rootHash, root, tree_hash_size);
+}
+
+void SliceDecoder::emit(uint64_t chunk, const uint8_t *data, size_t len, std::vector<uint8_t> &out) const {
+  auto offset = chunk * chunkSize;
+  auto from = (std::max)(start, offset);
+  auto to = (std::min)({end, offset + len, length});
+  if (from < to) {
+    out.insert(out.end(), data + (from - offset), data + (to - offset));
+  }
+}
+
+// step verify the node on top of the stack with the slice bytes at p, used: 0 when it needs more than avail
+bool SliceDecoder::step(const uint8_t *p, size_t avail, size_t &used, std::vector<uint8_t> &out,
+                        bela::error_code &ec) {
+  used = 0;
+  auto n = stack.back();
+  if (n.count == 1) {
+    auto offset = n.start * chunkSize;
+    auto size = static_cast<size_t>((std::min)(length - offset, chunkSize));
+    if (avail < size) {
+      need = size;
+      return true;
+    }
+    uint8_t cv[BLAKE3_OUT_LEN];
+    chunkCV(p, size, n.start, n.root, cv);
+    if (memcmp(cv, n.cv, BLAKE3_OUT_LEN) != 0) {
+      ec = bela::make_error_code(ErrGeneral, L"slice chunk ", n.start, L" does not match the tree");
+      return false;
+    }
+    stack.pop_back();
+    emit(n.start, p, size, out);
+    used = size;
+    return true;
+  }
+  // a full subtree inside the range is read at once and hashed with the SIMD kernels
+  if (n.count <= batchChunks && std::has_single_bit(n.count) && n.start >= first && n.start + n.count - 1 <= last &&
+      (n.start + n.count) * chunkSize <= length) {
+    auto size = static_cast<size_t>(n.count * chunkSize + (n.count - 1) * parentSize);
+    if (avail < size) {
+      need = size;
+      return true;
+    }
+    // pre-order layout of a full tree: parent, left subtree, right subtree
+    const uint8_t *inputs[batchChunks] = {nullptr};
+    const uint8_t *parents[batchChunks] = {nullptr};
+    size_t cursor = 0;
+    size_t parentCount = 0;
+    for (uint64_t i = 0; i < n.count; i++) {
+      // chunk i follows the parents of the subtrees starting at it, one per trailing zero (all of them for chunk 0)
+      for (auto k = std::countr_zero(i | n.count); k > 0; k--) {
+        parents[parentCount++] = p + cursor;
+        cursor += parentSize;
+      }
+      inputs[i] = p + cursor;
+      cursor += chunkSize;
+    }
+    uint8_t cv[BLAKE3_OUT_LEN];
+    fullTree tree;
+    tree.Hash(inputs, n.count, n.start, n.root, cv);
+    if (memcmp(cv, n.cv, BLAKE3_OUT_LEN) != 0) {
+      ec = bela::make_error_code(ErrGeneral, L"slice chunks ", n.start, L"..", n.start + n.count - 1,
+                                 L" do not match the tree");
+      return false;
+    }
+    // the root only covers the chunks, every interior parent of the slice must be the one the chunks produce
+    uint8_t nodes[(batchChunks - 1) * parentSize];
+    auto np = nodes;
+    tree.Nodes(np);
+    for (size_t i = 0; i < parentCount; i++) {
+      if (memcmp(parents[i], nodes + i * parentSize, parentSize) != 0) {
+        ec = bela::make_error_code(ErrGeneral, L"slice parents of chunks ", n.start, L"..", n.start + n.count - 1,
+                                   L" do not match the tree");
+        return false;
+      }
+    }
+    stack.pop_back();
+    for (uint64_t i = 0; i < n.count; i++) {
+      emit(n.start + i, inputs[i], chunkSize, out);
+    }
+    used = size;
+    return true;
+  }
+  if (avail < parentSize) {
+    need = parentSize;
+    return true;
+  }
+  uint8_t cv[BLAKE3_OUT_LEN];
+  parentCV(p, n.root, cv);
+  if (memcmp(cv, n.cv, BLAKE3_OUT_LEN) != 0) {
+    ec = bela::make_error_code(ErrGeneral, L"slice parent of chunks ", n.start, L"..", n.start + n.count - 1,
+                               L" does not match the tree");
+    return false;
+  }
+  stack.pop_back();
+  auto left = leftChunks(n.count);
+  auto total = chunkCount(length);
+  // right child first, the left one is on top
+  if (inSlice(n.start + left, n.count - left, first, last, total)) {
+    auto &r = stack.emplace_back(node{.start = n.start + left, .count = n.count - left, .cv = {}, .root = false});
+    memcpy(r.cv, p + BLAKE3_OUT_LEN, BLAKE3_OUT_LEN);
+  }
+  if (inSlice(n.start, left, first, last, total)) {
+    auto &l = stack.emplace_back(node{.start = n.start, .count = left, .cv = {}, .root = false});
+    memcpy(l.cv, p, BLAKE3_OUT_LEN);
+  }
+  used = parentSize;
+  return true;
+}
+
+// run verify nodes from p while the input lasts, returns bytes used
+bool SliceDecoder::run(const uint8_t *p, size_t avail, size_t &used, std::vector<uint8_t> &out,
+                       bela::error_code &ec) {
+  used = 0;
+  if (!header) {
+    if (avail < headerSize) {
+      need = headerSize;
+      return true;
+    }
+    length = bela::cast_fromle<uint64_t>(p);
+    header = true;
+    used = headerSize;
+    rangeChunks(length, start, end, first, last);
+    auto &r = stack.emplace_back(node{.start = 0, .count = chunkCount(length), .cv = {}, .root = true});
+    memcpy(r.cv, rootHash, tree_hash_size);
+  }
+  while (!stack.empty()) {
+    size_t n = 0;
+    if (!step(p + used, avail - used, n, out, ec)) {
+      return false;
+    }
+    if (n == 0) {
+      return true;
+    }
+    used += n;
+  }
+  need = 0;
+  if (used != avail) {
+    ec = bela::make_error_code(ErrGeneral, L"slice has ", avail - used, L" trailing bytes");
+    return false;
+  }
+  return true;
+}
+
+bool SliceDecoder::Write(const void *data, size_t len, std::vector<uint8_t> &out, bela::error_code &ec) {
+  auto u = reinterpret_cast<const uint8_t *>(data);
+  // a node split across writes is completed in pending, the rest is verified in place
+  while (!pending.empty() && len != 0) {
+    auto take = (std::min)(len, need > pending.size() ? need - pending.size() : len);
+    pending.insert(pending.end(), u, u + take);
+    u += take;
+    len -= take;
+    if (pending.size() < need) {
+      return true;
+    }
+    size_t used = 0;
+    if (!run(pending.data(), pending.size(), used, out, ec)) {
+      return false;
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<ptrdiff_t>(used));
+  }
+  if (len == 0) {
+    return true;
+  }
+  size_t used = 0;
+  if (!run(u, len, used, out, ec)) {
+    return false;
+  }
+  pending.assign(u + used, u + len);
+  return true;
+}
+
+bool SliceDecoder::Finish(bela::error_code &ec) const {
+  if (!header || !stack.empty()) {
+    ec = bela::make_error_code(ErrGeneral, L"slice truncated");
+    return false;
+  }
+  return true;
+}
+} // namespace bela::hash::blake3
@@ -0,0 +1,97 @@
+// hex encode and decode with AVX2, 16 bytes per iteration: nibbles are looked up with vpshufb, digits are validated
+// with unsigned range checks and packed back to bytes with vpmaddubsw
+#include <bela/hash.hpp>
+#include "hashinternal.hpp"
+
+#if defined(BELA_HASH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace bela::hash::hex {
+namespace {
+// 32 hex digits of 16 bytes, each word of the input becomes the digit of the high nibble then the low nibble
+inline __m256i encode16(const uint8_t *b) {
+  const auto digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                       '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const auto low = _mm256_set1_epi16(0x0F);
+  auto w = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b)));
+  auto nibbles = _mm256_or_si256(_mm256_srli_epi16(w, 4), _mm256_slli_epi16(_mm256_and_si256(w, low), 8));
+  return _mm256_shuffle_epi8(digits, nibbles);
+}
+
+template <typename CharT> inline void storeChars(CharT *out, __m256i c) {
+  if constexpr (sizeof(CharT) == 1) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), c);
+  } else if constexpr (sizeof(CharT) == 2) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(c)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(c, 1)));
+  } else {
+    auto lo = _mm256_castsi256_si128(c);
+    auto hi = _mm256_extracti128_si256(c, 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_cvtepu8_epi32(lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 16), _mm256_cvtepu8_epi32(hi));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+  }
+}
+
+inline __m256i loadu(const void *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+// 32 chars narrowed to bytes, saturation turns anything outside Latin-1 into 0 or 0xFF which are not hex digits
+template <typename CharT> inline __m256i loadChars(const CharT *in) {
+  if constexpr (sizeof(CharT) == 1) {
+    return loadu(in);
+  } else if constexpr (sizeof(CharT) == 2) {
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(loadu(in), loadu(in + 16)), 0xD8);
+  } else {
+    auto lo = _mm256_permute4x64_epi64(_mm256_packus_epi32(loadu(in), loadu(in + 8)), 0xD8);
+    auto hi = _mm256_permute4x64_epi64(_mm256_packus_epi32(loadu(in + 16), loadu(in + 24)), 0xD8);
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+  }
+}
+
+template <typename CharT> size_t encode(const uint8_t *b, size_t len, CharT *out) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    storeChars(out + i * 2, encode16(b + i));
+  }
+  return i;
+}
+
+template <typename CharT> size_t decode(const CharT *in, size_t len, uint8_t *out) {
+  const auto zero = _mm256_set1_epi8('0');
+  const auto lowerA = _mm256_set1_epi8('a');
+  const auto caseBit = _mm256_set1_epi8(0x20);
+  const auto nine = _mm256_set1_epi8(9);
+  const auto five = _mm256_set1_epi8(5);
+  const auto ten = _mm256_set1_epi8(10);
+  const auto weights = _mm256_set1_epi16(0x0110); // high nibble * 16 + low nibble
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    auto c = loadChars(in + i * 2);
+    auto d = _mm256_sub_epi8(c, zero);
+    auto a = _mm256_sub_epi8(_mm256_or_si256(c, caseBit), lowerA);
+    auto digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, nine), d);
+    auto alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(a, five), a);
+    if (_mm256_movemask_epi8(_mm256_or_si256(digit, alpha)) != -1) {
+      break;
+    }
+    auto v = _mm256_blendv_epi8(_mm256_add_epi8(a, ten), d, digit);
+    auto w = _mm256_maddubs_epi16(v, weights);
+    auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(w, w), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm256_castsi256_si128(packed));
+  }
+  return i;
+}
+} // namespace
+
+size_t encode_avx2(const uint8_t *b, size_t len, char *out) { return encode(b, len, out); }
+size_t encode_avx2(const uint8_t *b, size_t len, wchar_t *out) { return encode(b, len, out); }
+size_t decode_avx2(const char *in, size_t len, uint8_t *out) { return decode(in, len, out); }
+size_t decode_avx2(const wchar_t *in, size_t len, uint8_t *out) { return decode(in, len, out); }
+} // namespace bela::hash::hex
+
+#endif
@@ -0,0 +1,83 @@
+// hex encode and decode of digests into caller buffers, AVX2 for whole 16-byte groups and a table for the rest
+#include <bela/hash.hpp>
+#include <array>
+#include <type_traits>
+#include "hashinternal.hpp"
+
+namespace bela::hash {
+namespace {
+constexpr char hexDigits[] = "0123456789abcdef";
+
+constexpr std::array<int8_t, 128> hexValues = [] {
+  std::array<int8_t, 128> t{};
+  t.fill(-1);
+  for (int i = 0; i < 10; i++) {
+    t['0' + i] = static_cast<int8_t>(i);
+  }
+  for (int i = 0; i < 6; i++) {
+    t['a' + i] = static_cast<int8_t>(10 + i);
+    t['A' + i] = static_cast<int8_t>(10 + i);
+  }
+  return t;
+}();
+
+inline bool useAVX2() {
+#if defined(BELA_HASH_X86)
+  static const bool avx2 = internal::cpu().avx2;
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+template <typename CharT> void encodeScalar(const uint8_t *b, size_t len, CharT *out) {
+  for (size_t i = 0; i < len; i++) {
+    *out++ = static_cast<CharT>(hexDigits[b[i] >> 4]);
+    *out++ = static_cast<CharT>(hexDigits[b[i] & 0xf]);
+  }
+}
+
+template <typename CharT> inline int hexValue(CharT c) {
+  auto u = static_cast<uint32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+  return u < hexValues.size() ? hexValues[u] : -1;
+}
+
+template <typename CharT> bool decodeScalar(const CharT *in, size_t len, uint8_t *out) {
+  for (size_t i = 0; i < len; i++) {
+    auto hi = hexValue(in[i * 2]);
+    auto lo = hexValue(in[i * 2 + 1]);
+    if ((hi | lo) < 0) {
+      return false;
+    }
+    out[i] = static_cast<uint8_t>((hi << 4) | lo);
+  }
+  return true;
+}
+
+template <typename CharT> void encode(const uint8_t *b, size_t len, CharT *out) {
+  size_t done = 0;
+#if defined(BELA_HASH_X86)
+  if (useAVX2()) {
+    done = hex::encode_avx2(b, len, out);
+  }
+#endif
+  encodeScalar(b + done, len - done, out + done * 2);
+}
+
+template <typename CharT> bool decode(const CharT *in, size_t len, uint8_t *out) {
+  size_t done = 0;
+#if defined(BELA_HASH_X86)
+  if (useAVX2()) {
+    done = hex::decode_avx2(in, len, out);
+  }
+#endif
+  // also finds the bad digit of a group the kernel stopped at
+  return decodeScalar(in + done * 2, len - done, out + done);
+}
+} // namespace
+
+void HexEncode(const uint8_t *b, size_t len, char *out) { encode(b, len, out); }
+void HexEncode(const uint8_t *b, size_t len, wchar_t *out) { encode(b, len, out); }
+bool HexDecode(const char *in, size_t len, uint8_t *out) { return decode(in, len, out); }
+bool HexDecode(const wchar_t *in, size_t len, uint8_t *out) { return decode(in, len, out); }
+} // namespace bela::hash
@@ -0,0 +1,165 @@
+// read once, digest with every algorithm on its own thread
+#include <bela/hashfile.hpp>
+#include <bela/io.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <variant>
+
+namespace bela::hash {
+namespace {
+constexpr size_t slotSize = 1024 * 1024;
+// workers may lag behind the reader by slots - 1 buffers
+constexpr size_t slots = 4;
+
+using anyHasher = std::variant<sha256::Hasher, sha512::Hasher, sha3::Hasher, blake3::Hasher, sm3::Hasher>;
+
+anyHasher makeHasher(Algorithm a) {
+  anyHasher h;
+  switch (a) {
+  case Algorithm::SHA224:
+    h.emplace<sha256::Hasher>().Initialize(sha256::HashBits::SHA224);
+    break;
+  case Algorithm::SHA256:
+    h.emplace<sha256::Hasher>().Initialize(sha256::HashBits::SHA256);
+    break;
+  case Algorithm::SHA384:
+    h.emplace<sha512::Hasher>().Initialize(sha512::HashBits::SHA384);
+    break;
+  case Algorithm::SHA512:
+    h.emplace<sha512::Hasher>().Initialize(sha512::HashBits::SHA512);
+    break;
+  case Algorithm::SHA3_224:
+    h.emplace<sha3::Hasher>().Initialize(sha3::HashBits::SHA3224);
+    break;
+  case Algorithm::SHA3_256:
+    h.emplace<sha3::Hasher>().Initialize(sha3::HashBits::SHA3256);
+    break;
+  case Algorithm::SHA3_384:
+    h.emplace<sha3::Hasher>().Initialize(sha3::HashBits::SHA3384);
+    break;
+  case Algorithm::SHA3_512:
+    h.emplace<sha3::Hasher>().Initialize(sha3::HashBits::SHA3512);
+    break;
+  case Algorithm::BLAKE3:
+    h.emplace<blake3::Hasher>().Initialize();
+    break;
+  case Algorithm::SM3:
+    h.emplace<sm3::Hasher>().Initialize();
+    break;
+  }
+  return h;
+}
+
+// ring of read buffers, a slot is refilled when every worker is done with it
+struct pipeline {
+  std::mutex mu;
+  std::condition_variable produced;
+  std::condition_variable consumed;
+  std::vector<uint8_t> buffer;
+  size_t sizes[slots]{0};
+  uint32_t pending[slots]{0};
+  uint64_t filled{0}; // blocks published
+  bool done{false};
+};
+
+void consume(pipeline &p, anyHasher &h) {
+  for (uint64_t seq = 0;; seq++) {
+    auto slot = static_cast<size_t>(seq % slots);
+    {
+      std::unique_lock lock(p.mu);
+      p.produced.wait(lock, [&] { return p.filled > seq || p.done; });
+      if (p.filled <= seq) {
+        return;
+      }
+    }
+    std::visit([&](auto &hasher) { hasher.Update(p.buffer.data() + slot * slotSize, p.sizes[slot]); }, h);
+    std::scoped_lock lock(p.mu);
+    if (--p.pending[slot] == 0) {
+      p.consumed.notify_one();
+    }
+  }
+}
+} // namespace
+
+std::wstring_view AlgorithmName(Algorithm a) {
+  constexpr std::wstring_view names[] = {L"SHA224",   L"SHA256",   L"SHA384", L"SHA512", L"SHA3-224",
+                                         L"SHA3-256", L"SHA3-384", L"SHA3-512", L"BLAKE3", L"SM3"};
+  auto i = static_cast<size_t>(a);
+  return i < std::size(names) ? names[i] : L"unknown";
+}
+
+bool MultiDigest::Sum(HANDLE fd, std::vector<Digest> &digests, bela::error_code &ec) const {
+  digests.clear();
+  std::vector<anyHasher> hashers;
+  hashers.reserve(algorithms.size());
+  for (auto a : algorithms) {
+    hashers.emplace_back(makeHasher(a));
+  }
+  pipeline p;
+  p.buffer.resize(slots * slotSize);
+  std::vector<std::thread> workers;
+  try {
+    workers.reserve(hashers.size());
+    for (auto &h : hashers) {
+      workers.emplace_back([&p, &h] { consume(p, h); });
+    }
+  } catch (const std::exception &e) {
+    // started workers wait for the first block: release and join them, a joinable std::thread must not be destroyed
+    {
+      std::scoped_lock lock(p.mu);
+      p.done = true;
+    }
+    p.produced.notify_all();
+    for (auto &w : workers) {
+      w.join();
+    }
+    ec = bela::make_error_code(ErrGeneral, L"start digest worker: ", bela::encode_into<char, wchar_t>(e.what()));
+    return false;
+  }
+  bool result = true;
+  for (uint64_t seq = 0;; seq++) {
+    auto slot = static_cast<size_t>(seq % slots);
+    {
+      std::unique_lock lock(p.mu);
+      p.consumed.wait(lock, [&] { return p.pending[slot] == 0; });
+    }
+    DWORD n = 0;
+    if (::ReadFile(fd, p.buffer.data() + slot * slotSize, static_cast<DWORD>(slotSize), &n, nullptr) != TRUE &&
+        GetLastError() != ERROR_BROKEN_PIPE) {
+      ec = bela::make_system_error_code(L"ReadFile: ");
+      result = false;
+    }
+    std::scoped_lock lock(p.mu);
+    if (!result || n == 0) {
+      p.done = true;
+      p.produced.notify_all();
+      break;
+    }
+    p.sizes[slot] = n;
+    p.pending[slot] = static_cast<uint32_t>(workers.size());
+    p.filled = seq + 1;
+    p.produced.notify_all();
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  if (!result) {
+    return false;
+  }
+  for (size_t i = 0; i < hashers.size(); i++) {
+    digests.emplace_back(Digest{algorithms[i], std::visit([](auto &h) { return h.Finalize(); }, hashers[i])});
+  }
+  return true;
+}
+
+bool MultiDigest::SumFile(std::wstring_view file, std::vector<Digest> &digests, bela::error_code &ec) const {
+  auto fd = bela::io::NewFile(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr, ec);
+  if (!fd) {
+    return false;
+  }
+  return Sum(fd->NativeFD(), digests, ec);
+}
+
+} // namespace bela::hash
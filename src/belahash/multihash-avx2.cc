@@ -0,0 +1,178 @@
+// multi-buffer SHA-256 (8 lanes), SHA-512 (4 lanes) block compression and SHA-3 (4 lanes) absorb with AVX2
+#include <bela/hash.hpp>
+#include <cstring>
+#include "hashinternal.hpp"
+
+#if defined(BELA_HASH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace bela::hash {
+namespace {
+inline __m256i rotr32(__m256i x, int n) { return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n)); }
+inline __m256i rotr64(__m256i x, int n) { return _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - n)); }
+inline __m256i xor3(__m256i a, __m256i b, __m256i c) { return _mm256_xor_si256(_mm256_xor_si256(a, b), c); }
+// Ch(x,y,z)=((x & y) | (~x & z)), Maj(x,y,z)=((x & y) ^ (x & z) ^ (y & z))
+inline __m256i ch(__m256i x, __m256i y, __m256i z) { return _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z))); }
+inline __m256i maj(__m256i x, __m256i y, __m256i z) {
+  return _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_xor_si256(x, y)));
+}
+
+// transpose8x32 rows r[0..7] of 8 words into columns
+inline void transpose8x32(__m256i r[8]) {
+  __m256i t[8];
+  __m256i u[8];
+  for (int i = 0; i < 8; i += 2) {
+    t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  for (int i = 0; i < 8; i += 4) {
+    u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+    u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+    u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+    u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  for (int i = 0; i < 4; i++) {
+    r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+    r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+  }
+}
+
+// transpose4x64 rows r[0..3] of 4 qwords into columns
+inline void transpose4x64(__m256i r[4]) {
+  auto t0 = _mm256_unpacklo_epi64(r[0], r[1]);
+  auto t1 = _mm256_unpackhi_epi64(r[0], r[1]);
+  auto t2 = _mm256_unpacklo_epi64(r[2], r[3]);
+  auto t3 = _mm256_unpackhi_epi64(r[2], r[3]);
+  r[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+  r[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+  r[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+  r[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+// FIPS 180-4 4.1.2 and 4.1.3 on 32-bit and 64-bit lanes
+#define S0_256(x) xor3(rotr32(x, 2), rotr32(x, 13), rotr32(x, 22))
+#define S1_256(x) xor3(rotr32(x, 6), rotr32(x, 11), rotr32(x, 25))
+#define s0_256(x) xor3(rotr32(x, 7), rotr32(x, 18), _mm256_srli_epi32(x, 3))
+#define s1_256(x) xor3(rotr32(x, 17), rotr32(x, 19), _mm256_srli_epi32(x, 10))
+#define S0_512(x) xor3(rotr64(x, 28), rotr64(x, 34), rotr64(x, 39))
+#define S1_512(x) xor3(rotr64(x, 14), rotr64(x, 18), rotr64(x, 41))
+#define s0_512(x) xor3(rotr64(x, 1), rotr64(x, 8), _mm256_srli_epi64(x, 7))
+#define s1_512(x) xor3(rotr64(x, 19), rotr64(x, 61), _mm256_srli_epi64(x, 6))
+
+#define W_1_16(n) W[n]
+/* W[n] = sigma1(W[n - 2]) + W[n - 7] + sigma0(W[n - 15]) + W[n - 16] */
+#define W256_17_64(n)                                                                                                  \
+  (W[n] = _mm256_add_epi32(_mm256_add_epi32(W[n], s0_256(W[((n)-15) & 15])),                                           \
+                           _mm256_add_epi32(s1_256(W[((n)-2) & 15]), W[((n)-7) & 15])))
+#define W512_17_80(n)                                                                                                  \
+  (W[n] = _mm256_add_epi64(_mm256_add_epi64(W[n], s0_512(W[((n)-15) & 15])),                                           \
+                           _mm256_add_epi64(s1_512(W[((n)-2) & 15]), W[((n)-7) & 15])))
+
+#define ROUND256(a, b, c, d, e, f, g, h, n, w)                                                                         \
+  {                                                                                                                    \
+    auto T1 = _mm256_add_epi32(_mm256_add_epi32(h, S1_256(e)),                                                         \
+                               _mm256_add_epi32(ch(e, f, g), _mm256_add_epi32(w, _mm256_set1_epi32(k[n]))));           \
+    (d) = _mm256_add_epi32(d, T1);                                                                                     \
+    (h) = _mm256_add_epi32(T1, _mm256_add_epi32(S0_256(a), maj(a, b, c)));                                             \
+  }
+#define ROUND512(a, b, c, d, e, f, g, h, n, w)                                                                         \
+  {                                                                                                                    \
+    auto T1 = _mm256_add_epi64(_mm256_add_epi64(h, S1_512(e)),                                                         \
+                               _mm256_add_epi64(ch(e, f, g), _mm256_add_epi64(w, _mm256_set1_epi64x(k[n]))));          \
+    (d) = _mm256_add_epi64(d, T1);                                                                                     \
+    (h) = _mm256_add_epi64(T1, _mm256_add_epi64(S0_512(a), maj(a, b, c)));                                             \
+  }
+
+#define KECCAK_XOR(a, b) _mm256_xor_si256(a, b)
+#define KECCAK_XOR5(a, b, c, d, e) _mm256_xor_si256(xor3(a, b, c), _mm256_xor_si256(d, e))
+#define KECCAK_ROL1XOR(a, b) _mm256_xor_si256(a, _mm256_or_si256(_mm256_add_epi64(b, b), _mm256_srli_epi64(b, 63)))
+#define KECCAK_XORROL(a, b, n) rotr64(_mm256_xor_si256(a, b), 64 - (n))
+#define KECCAK_CHI(a, b, c) _mm256_xor_si256(a, _mm256_andnot_si256(b, c))
+} // namespace
+
+void sha256::lanes_avx2(uint32_t *state, const uint8_t *const *blocks) {
+  const __m256i byteswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, //
+                                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  __m256i W[16];
+  for (int half = 0; half < 2; half++) {
+    for (int lane = 0; lane < 8; lane++) {
+      W[half * 8 + lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blocks[lane] + half * 32));
+    }
+    transpose8x32(W + half * 8);
+  }
+  for (int n = 0; n < 16; n++) {
+    W[n] = _mm256_shuffle_epi8(W[n], byteswap);
+  }
+  __m256i s[8];
+  for (int i = 0; i < 8; i++) {
+    s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + i * 8));
+  }
+  auto A = s[0], B = s[1], C = s[2], D = s[3], E = s[4], F = s[5], G = s[6], H = s[7];
+  const auto *k = reinterpret_cast<const int *>(sha256::k256);
+  SHA2_ROUNDS_16(ROUND256, W_1_16)
+  for (k += 16; k < reinterpret_cast<const int *>(sha256::k256 + 64); k += 16) {
+    SHA2_ROUNDS_16(ROUND256, W256_17_64)
+  }
+  const __m256i r[8] = {A, B, C, D, E, F, G, H};
+  for (int i = 0; i < 8; i++) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + i * 8), _mm256_add_epi32(s[i], r[i]));
+  }
+}
+
+void sha512::lanes_avx2(uint64_t *state, const uint8_t *const *blocks) {
+  const __m256i byteswap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, //
+                                            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  __m256i W[16];
+  for (int quarter = 0; quarter < 4; quarter++) {
+    for (int lane = 0; lane < 4; lane++) {
+      W[quarter * 4 + lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blocks[lane] + quarter * 32));
+    }
+    transpose4x64(W + quarter * 4);
+  }
+  for (int n = 0; n < 16; n++) {
+    W[n] = _mm256_shuffle_epi8(W[n], byteswap);
+  }
+  __m256i s[8];
+  for (int i = 0; i < 8; i++) {
+    s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + i * 4));
+  }
+  auto A = s[0], B = s[1], C = s[2], D = s[3], E = s[4], F = s[5], G = s[6], H = s[7];
+  const auto *k = reinterpret_cast<const long long *>(sha512::k512);
+  SHA2_ROUNDS_16(ROUND512, W_1_16)
+  for (k += 16; k < reinterpret_cast<const long long *>(sha512::k512 + 80); k += 16) {
+    SHA2_ROUNDS_16(ROUND512, W512_17_80)
+  }
+  const __m256i r[8] = {A, B, C, D, E, F, G, H};
+  for (int i = 0; i < 8; i++) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + i * 4), _mm256_add_epi64(s[i], r[i]));
+  }
+}
+
+void sha3::lanes_avx2(uint64_t *state, const uint8_t *const *blocks, size_t block_size) {
+  for (size_t w = 0; w < block_size / 8; w++) {
+    uint64_t v[4];
+    for (int lane = 0; lane < 4; lane++) {
+      memcpy(v + lane, blocks[lane] + w * 8, 8);
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i *>(state + w * 4),
+                       _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(state + w * 4)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v))));
+  }
+  __m256i A[25];
+  __m256i E[25];
+  memcpy(A, state, sizeof(A));
+  for (int round = 0; round < 24; round += 2) {
+    KECCAK_ROUND(A, E, _mm256_set1_epi64x(static_cast<long long>(sha3::keccak_round_constants[round])),
+                 KECCAK_CHI_ROW);
+    KECCAK_ROUND(E, A, _mm256_set1_epi64x(static_cast<long long>(sha3::keccak_round_constants[round + 1])),
+                 KECCAK_CHI_ROW);
+  }
+  memcpy(state, A, sizeof(A));
+}
+} // namespace bela::hash
+
+#endif
@@ -0,0 +1,189 @@
+// multi-buffer SHA-256 (16 lanes), SHA-512 (8 lanes) block compression and SHA-3 (8 lanes) absorb with AVX-512F/BW
+#include <bela/hash.hpp>
+#include <cstring>
+#include "hashinternal.hpp"
+
+#if defined(BELA_HASH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace bela::hash {
+namespace {
+// vpternlogq truth tables of a ^ b ^ c, Ch(a,b,c) and Maj(a,b,c)
+constexpr int ternXor3 = 0x96;
+constexpr int ternCh = 0xCA;
+constexpr int ternMaj = 0xE8;
+constexpr int ternChi = 0xD2; // a ^ (~b & c)
+
+// transpose4x128 4x4 transpose of the 128-bit lanes of a, b, c, d
+inline void transpose4x128(__m512i &a, __m512i &b, __m512i &c, __m512i &d) {
+  auto v0 = _mm512_shuffle_i32x4(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  auto v1 = _mm512_shuffle_i32x4(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+  auto v2 = _mm512_shuffle_i32x4(c, d, _MM_SHUFFLE(2, 0, 2, 0));
+  auto v3 = _mm512_shuffle_i32x4(c, d, _MM_SHUFFLE(3, 1, 3, 1));
+  a = _mm512_shuffle_i32x4(v0, v2, _MM_SHUFFLE(2, 0, 2, 0));
+  b = _mm512_shuffle_i32x4(v1, v3, _MM_SHUFFLE(2, 0, 2, 0));
+  c = _mm512_shuffle_i32x4(v0, v2, _MM_SHUFFLE(3, 1, 3, 1));
+  d = _mm512_shuffle_i32x4(v1, v3, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+// transpose16x32 rows r[0..15] of 16 words into columns
+inline void transpose16x32(__m512i r[16]) {
+  __m512i t[16];
+  for (int i = 0; i < 16; i += 2) {
+    t[i] = _mm512_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm512_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  // r[4i+k], 128-bit lane L: column 4L+k of rows 4i..4i+3
+  for (int i = 0; i < 16; i += 4) {
+    r[i] = _mm512_unpacklo_epi64(t[i], t[i + 2]);
+    r[i + 1] = _mm512_unpackhi_epi64(t[i], t[i + 2]);
+    r[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+    r[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  // column 4L+k lands in r[4L+k]
+  for (int k = 0; k < 4; k++) {
+    transpose4x128(r[k], r[4 + k], r[8 + k], r[12 + k]);
+  }
+}
+
+// transpose8x64 rows r[0..7] of 8 qwords into columns
+inline void transpose8x64(__m512i r[8]) {
+  __m512i t[8];
+  for (int i = 0; i < 8; i += 2) {
+    t[i] = _mm512_unpacklo_epi64(r[i], r[i + 1]);
+    t[i + 1] = _mm512_unpackhi_epi64(r[i], r[i + 1]);
+  }
+  // r[2i+k], 128-bit lane L: column 2L+k of rows 2i, 2i+1. column 2L+k lands in r[2L+k]
+  for (int i = 0; i < 8; i++) {
+    r[i] = t[i];
+  }
+  for (int k = 0; k < 2; k++) {
+    transpose4x128(r[k], r[2 + k], r[4 + k], r[6 + k]);
+  }
+}
+
+#define xor3_32(a, b, c) _mm512_ternarylogic_epi32(a, b, c, ternXor3)
+#define xor3_64(a, b, c) _mm512_ternarylogic_epi64(a, b, c, ternXor3)
+// FIPS 180-4 4.1.2 and 4.1.3 on 32-bit and 64-bit lanes
+#define S0_256(x) xor3_32(_mm512_ror_epi32(x, 2), _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22))
+#define S1_256(x) xor3_32(_mm512_ror_epi32(x, 6), _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25))
+#define s0_256(x) xor3_32(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x, 3))
+#define s1_256(x) xor3_32(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10))
+#define S0_512(x) xor3_64(_mm512_ror_epi64(x, 28), _mm512_ror_epi64(x, 34), _mm512_ror_epi64(x, 39))
+#define S1_512(x) xor3_64(_mm512_ror_epi64(x, 14), _mm512_ror_epi64(x, 18), _mm512_ror_epi64(x, 41))
+#define s0_512(x) xor3_64(_mm512_ror_epi64(x, 1), _mm512_ror_epi64(x, 8), _mm512_srli_epi64(x, 7))
+#define s1_512(x) xor3_64(_mm512_ror_epi64(x, 19), _mm512_ror_epi64(x, 61), _mm512_srli_epi64(x, 6))
+
+#define W_1_16(n) W[n]
+/* W[n] = sigma1(W[n - 2]) + W[n - 7] + sigma0(W[n - 15]) + W[n - 16] */
+#define W256_17_64(n)                                                                                                  \
+  (W[n] = _mm512_add_epi32(_mm512_add_epi32(W[n], s0_256(W[((n)-15) & 15])),                                           \
+                           _mm512_add_epi32(s1_256(W[((n)-2) & 15]), W[((n)-7) & 15])))
+#define W512_17_80(n)                                                                                                  \
+  (W[n] = _mm512_add_epi64(_mm512_add_epi64(W[n], s0_512(W[((n)-15) & 15])),                                           \
+                           _mm512_add_epi64(s1_512(W[((n)-2) & 15]), W[((n)-7) & 15])))
+
+#define ROUND256(a, b, c, d, e, f, g, h, n, w)                                                                         \
+  {                                                                                                                    \
+    auto T1 = _mm512_add_epi32(                                                                                        \
+        _mm512_add_epi32(h, S1_256(e)),                                                                                \
+        _mm512_add_epi32(_mm512_ternarylogic_epi32(e, f, g, ternCh), _mm512_add_epi32(w, _mm512_set1_epi32(k[n]))));  \
+    (d) = _mm512_add_epi32(d, T1);                                                                                     \
+    (h) = _mm512_add_epi32(T1, _mm512_add_epi32(S0_256(a), _mm512_ternarylogic_epi32(a, b, c, ternMaj)));             \
+  }
+#define ROUND512(a, b, c, d, e, f, g, h, n, w)                                                                         \
+  {                                                                                                                    \
+    auto T1 = _mm512_add_epi64(                                                                                        \
+        _mm512_add_epi64(h, S1_512(e)),                                                                                \
+        _mm512_add_epi64(_mm512_ternarylogic_epi64(e, f, g, ternCh), _mm512_add_epi64(w, _mm512_set1_epi64(k[n]))));  \
+    (d) = _mm512_add_epi64(d, T1);                                                                                     \
+    (h) = _mm512_add_epi64(T1, _mm512_add_epi64(S0_512(a), _mm512_ternarylogic_epi64(a, b, c, ternMaj)));             \
+  }
+
+#define KECCAK_XOR(a, b) _mm512_xor_si512(a, b)
+#define KECCAK_XOR5(a, b, c, d, e) _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(a, b, c, ternXor3), d, e, ternXor3)
+#define KECCAK_ROL1XOR(a, b) _mm512_xor_si512(a, _mm512_rol_epi64(b, 1))
+#define KECCAK_XORROL(a, b, n) _mm512_rol_epi64(_mm512_xor_si512(a, b), n)
+#define KECCAK_CHI(a, b, c) _mm512_ternarylogic_epi64(a, b, c, ternChi)
+} // namespace
+
+void sha256::lanes_avx512(uint32_t *state, const uint8_t *const *blocks) {
+  const __m512i byteswap = _mm512_broadcast_i32x4(_mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+  __m512i W[16];
+  for (int lane = 0; lane < 16; lane++) {
+    W[lane] = _mm512_loadu_si512(blocks[lane]);
+  }
+  transpose16x32(W);
+  for (int n = 0; n < 16; n++) {
+    W[n] = _mm512_shuffle_epi8(W[n], byteswap);
+  }
+  __m512i s[8];
+  for (int i = 0; i < 8; i++) {
+    s[i] = _mm512_loadu_si512(state + i * 16);
+  }
+  auto A = s[0], B = s[1], C = s[2], D = s[3], E = s[4], F = s[5], G = s[6], H = s[7];
+  const auto *k = reinterpret_cast<const int *>(sha256::k256);
+  SHA2_ROUNDS_16(ROUND256, W_1_16)
+  for (k += 16; k < reinterpret_cast<const int *>(sha256::k256 + 64); k += 16) {
+    SHA2_ROUNDS_16(ROUND256, W256_17_64)
+  }
+  const __m512i r[8] = {A, B, C, D, E, F, G, H};
+  for (int i = 0; i < 8; i++) {
+    _mm512_storeu_si512(state + i * 16, _mm512_add_epi32(s[i], r[i]));
+  }
+}
+
+void sha512::lanes_avx512(uint64_t *state, const uint8_t *const *blocks) {
+  const __m512i byteswap = _mm512_broadcast_i32x4(_mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+  __m512i W[16];
+  for (int half = 0; half < 2; half++) {
+    for (int lane = 0; lane < 8; lane++) {
+      W[half * 8 + lane] = _mm512_loadu_si512(blocks[lane] + half * 64);
+    }
+    transpose8x64(W + half * 8);
+  }
+  for (int n = 0; n < 16; n++) {
+    W[n] = _mm512_shuffle_epi8(W[n], byteswap);
+  }
+  __m512i s[8];
+  for (int i = 0; i < 8; i++) {
+    s[i] = _mm512_loadu_si512(state + i * 8);
+  }
+  auto A = s[0], B = s[1], C = s[2], D = s[3], E = s[4], F = s[5], G = s[6], H = s[7];
+  const auto *k = reinterpret_cast<const long long *>(sha512::k512);
+  SHA2_ROUNDS_16(ROUND512, W_1_16)
+  for (k += 16; k < reinterpret_cast<const long long *>(sha512::k512 + 80); k += 16) {
+    SHA2_ROUNDS_16(ROUND512, W512_17_80)
+  }
+  const __m512i r[8] = {A, B, C, D, E, F, G, H};
+  for (int i = 0; i < 8; i++) {
+    _mm512_storeu_si512(state + i * 8, _mm512_add_epi64(s[i], r[i]));
+  }
+}
+
+void sha3::lanes_avx512(uint64_t *state, const uint8_t *const *blocks, size_t block_size) {
+  for (size_t w = 0; w < block_size / 8; w++) {
+    uint64_t v[8];
+    for (int lane = 0; lane < 8; lane++) {
+      memcpy(v + lane, blocks[lane] + w * 8, 8);
+    }
+    _mm512_store_si512(state + w * 8, _mm512_xor_si512(_mm512_load_si512(state + w * 8), _mm512_loadu_si512(v)));
+  }
+  __m512i A[25];
+  __m512i E[25];
+  memcpy(A, state, sizeof(A));
+  for (int round = 0; round < 24; round += 2) {
+    KECCAK_ROUND(A, E, _mm512_set1_epi64(static_cast<long long>(sha3::keccak_round_constants[round])),
+                 KECCAK_CHI_ROW);
+    KECCAK_ROUND(E, A, _mm512_set1_epi64(static_cast<long long>(sha3::keccak_round_constants[round + 1])),
+                 KECCAK_CHI_ROW);
+  }
+  memcpy(state, A, sizeof(A));
+}
+} // namespace bela::hash
+
+#endif
@@ -0,0 +1,356 @@
+// multi-buffer SHA-256/SHA-512/SHA-3 scheduling, messages are fed to SIMD lanes block by block
+#include <bela/hash.hpp>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include "hashinternal.hpp"
+
+namespace bela::hash {
+namespace {
+constexpr size_t npos = static_cast<size_t>(-1);
+
+template <typename Word, size_t BlockSize> struct laneMessage {
+  size_t index{npos}; // message index, npos: idle lane
+  const uint8_t *data{nullptr};
+  size_t full{0};   // blocks read in place from data
+  size_t blocks{0}; // full blocks and padded tail blocks
+  size_t done{0};
+  uint8_t tail[BlockSize * 2];
+
+  const uint8_t *block() const { return done < full ? data + done * BlockSize : tail + (done - full) * BlockSize; }
+  // reset copy leftovers to tail and append 0x80, zeros and the big endian bit length (64 or 128 bits)
+  void reset(size_t i, std::span<const uint8_t> m) {
+    constexpr size_t lengthSize = sizeof(Word) * 2;
+    index = i;
+    data = m.data();
+    full = m.size() / BlockSize;
+    done = 0;
+    auto rest = m.size() % BlockSize;
+    auto tailBlocks = rest + 1 + lengthSize > BlockSize ? 2 : 1;
+    blocks = full + tailBlocks;
+    auto tailSize = tailBlocks * BlockSize;
+    memset(tail, 0, tailSize);
+    if (rest != 0) {
+      memcpy(tail, data + full * BlockSize, rest);
+    }
+    tail[rest] = 0x80;
+    auto bits = bela::frombe(static_cast<uint64_t>(m.size()) << 3);
+    memcpy(tail + tailSize - 8, &bits, 8);
+    if constexpr (lengthSize == 16) {
+      auto high = bela::frombe(static_cast<uint64_t>(m.size()) >> 61);
+      memcpy(tail + tailSize - 16, &high, 8);
+    }
+  }
+};
+
+// sumLanes hash messages in N lanes, longest messages first so the last rounds are short. single: hardware single
+// buffer compression that finishes the remaining lanes once fewer than half of them are busy
+template <typename Word, size_t N, size_t BlockSize, typename Single>
+void sumLanes(void (*compress)(Word *, const uint8_t *const *), Single single, const Word iv[8],
+              std::span<const std::span<const uint8_t>> messages, uint8_t *digests, size_t digestLength) {
+  using lane_t = laneMessage<Word, BlockSize>;
+  std::vector<size_t> order(messages.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return messages[a].size() > messages[b].size(); });
+  alignas(64) Word state[8 * N];
+  alignas(64) static const uint8_t idleBlock[BlockSize] = {0};
+  std::vector<lane_t> lanes(N);
+  const uint8_t *blocks[N];
+  size_t next = 0;
+  size_t active = 0;
+  auto writeDigest = [&](size_t index, const Word hash[8]) {
+    auto out = digests + index * digestLength;
+    for (size_t w = 0; w < digestLength / sizeof(Word); w++) {
+      auto v = bela::frombe(hash[w]);
+      memcpy(out + w * sizeof(Word), &v, sizeof(Word));
+    }
+  };
+  auto load = [&](size_t l) {
+    if (next == order.size()) {
+      lanes[l].index = npos;
+      return;
+    }
+    auto i = order[next++];
+    lanes[l].reset(i, messages[i]);
+    for (size_t w = 0; w < 8; w++) {
+      state[w * N + l] = iv[w];
+    }
+    active++;
+  };
+  for (size_t l = 0; l < N; l++) {
+    load(l);
+  }
+  while (active != 0) {
+    if (single != nullptr && next == order.size() && active * 2 <= N) {
+      for (size_t l = 0; l < N; l++) {
+        auto &lane = lanes[l];
+        if (lane.index == npos) {
+          continue;
+        }
+        Word hash[8];
+        for (size_t w = 0; w < 8; w++) {
+          hash[w] = state[w * N + l];
+        }
+        if (lane.done < lane.full) {
+          single(hash, lane.data + lane.done * BlockSize, lane.full - lane.done);
+          lane.done = lane.full;
+        }
+        single(hash, lane.tail + (lane.done - lane.full) * BlockSize, lane.blocks - lane.done);
+        writeDigest(lane.index, hash);
+      }
+      return;
+    }
+    for (size_t l = 0; l < N; l++) {
+      blocks[l] = lanes[l].index == npos ? idleBlock : lanes[l].block();
+    }
+    compress(state, blocks);
+    for (size_t l = 0; l < N; l++) {
+      auto &lane = lanes[l];
+      if (lane.index == npos || ++lane.done != lane.blocks) {
+        continue;
+      }
+      Word hash[8];
+      for (size_t w = 0; w < 8; w++) {
+        hash[w] = state[w * N + l];
+      }
+      writeDigest(lane.index, hash);
+      active--;
+      load(l);
+    }
+  }
+}
+
+// spongeMessage a SHA-3 message in a lane, the padded tail is always a single block
+struct spongeMessage {
+  size_t index{npos};
+  const uint8_t *data{nullptr};
+  size_t full{0};
+  size_t done{0};
+  uint8_t tail[sha3::sha3_max_rate_in_qwords * 8];
+
+  const uint8_t *block(size_t rate) const { return done < full ? data + done * rate : tail; }
+  void reset(size_t i, std::span<const uint8_t> m, size_t rate) {
+    index = i;
+    data = m.data();
+    full = m.size() / rate;
+    done = 0;
+    auto rest = m.size() % rate;
+    memset(tail, 0, rate);
+    if (rest != 0) {
+      memcpy(tail, data + full * rate, rest);
+    }
+    tail[rest] |= 0x06;
+    tail[rate - 1] |= 0x80;
+  }
+};
+
+// sumSponge SHA-3 counterpart of sumLanes, the state is 25 words per lane, word-major
+template <size_t N>
+void sumSponge(sha3::lanes_function absorb, size_t rate, std::span<const std::span<const uint8_t>> messages,
+               uint8_t *digests, size_t digestLength) {
+  std::vector<size_t> order(messages.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return messages[a].size() > messages[b].size(); });
+  alignas(64) uint64_t state[25 * N];
+  alignas(64) static const uint8_t idleBlock[sha3::sha3_max_rate_in_qwords * 8] = {0};
+  std::vector<spongeMessage> lanes(N);
+  const uint8_t *blocks[N];
+  size_t next = 0;
+  size_t active = 0;
+  auto writeDigest = [&](size_t index, const uint64_t hash[25]) {
+    auto out = digests + index * digestLength;
+    for (size_t w = 0; w * 8 < digestLength; w++) {
+      auto v = bela::fromle(hash[w]);
+      memcpy(out + w * 8, &v, (std::min)(digestLength - w * 8, size_t{8}));
+    }
+  };
+  auto load = [&](size_t l) {
+    if (next == order.size()) {
+      lanes[l].index = npos;
+      return;
+    }
+    auto i = order[next++];
+    lanes[l].reset(i, messages[i], rate);
+    for (size_t w = 0; w < 25; w++) {
+      state[w * N + l] = 0;
+    }
+    active++;
+  };
+  for (size_t l = 0; l < N; l++) {
+    load(l);
+  }
+  while (active != 0) {
+    if (next == order.size() && active * 2 <= N) {
+      auto single = sha3::absorb_function_for();
+      for (size_t l = 0; l < N; l++) {
+        auto &lane = lanes[l];
+        if (lane.index == npos) {
+          continue;
+        }
+        uint64_t hash[25];
+        for (size_t w = 0; w < 25; w++) {
+          hash[w] = state[w * N + l];
+        }
+        if (lane.done < lane.full) {
+          single(hash, lane.data + lane.done * rate, lane.full - lane.done, rate);
+        }
+        single(hash, lane.tail, 1, rate);
+        writeDigest(lane.index, hash);
+      }
+      return;
+    }
+    for (size_t l = 0; l < N; l++) {
+      blocks[l] = lanes[l].index == npos ? idleBlock : lanes[l].block(rate);
+    }
+    absorb(state, blocks, rate);
+    for (size_t l = 0; l < N; l++) {
+      auto &lane = lanes[l];
+      if (lane.index == npos || ++lane.done != lane.full + 1) {
+        continue;
+      }
+      uint64_t hash[25];
+      for (size_t w = 0; w < 25; w++) {
+        hash[w] = state[w * N + l];
+      }
+      writeDigest(lane.index, hash);
+      active--;
+      load(l);
+    }
+  }
+}
+
+template <typename Hasher, typename HashBits>
+void sumSerial(HashBits hb, std::span<const std::span<const uint8_t>> messages, uint8_t *digests,
+               size_t digestLength) {
+  for (size_t i = 0; i < messages.size(); i++) {
+    Hasher h;
+    h.Initialize(hb);
+    h.Update(messages[i].data(), messages[i].size());
+    h.Finalize(digests + i * digestLength, digestLength);
+  }
+}
+
+// sha256Lanes AVX-512 lanes, AVX2 lanes only without SHA-NI: one SHA-NI stream outruns 8 AVX2 lanes
+std::pair<sha256::lanes_function, size_t> sha256Lanes() {
+#if defined(BELA_HASH_X86)
+  const auto &features = internal::cpu();
+  if (features.avx512) {
+    return {sha256::lanes_avx512, 16};
+  }
+  if (features.avx2 && sha256::hardware_block_function() == nullptr) {
+    return {sha256::lanes_avx2, 8};
+  }
+#endif
+  return {nullptr, 1};
+}
+
+std::pair<sha512::lanes_function, size_t> sha512Lanes() {
+#if defined(BELA_HASH_X86)
+  const auto &features = internal::cpu();
+  if (features.avx512) {
+    return {sha512::lanes_avx512, 8};
+  }
+  if (features.avx2) {
+    return {sha512::lanes_avx2, 4};
+  }
+#endif
+  return {nullptr, 1};
+}
+
+std::pair<sha3::lanes_function, size_t> sha3Lanes() {
+#if defined(BELA_HASH_X86)
+  const auto &features = internal::cpu();
+  if (features.avx512) {
+    return {sha3::lanes_avx512, 8};
+  }
+  if (features.avx2) {
+    return {sha3::lanes_avx2, 4};
+  }
+#elif defined(BELA_HASH_ARM64_SHA3)
+  if (internal::cpu().arm_sha3) {
+    return {sha3::lanes_armv8, 2};
+  }
+#endif
+  return {nullptr, 1};
+}
+} // namespace
+
+size_t sha256::MultiHasher::Lanes() { return sha256Lanes().second; }
+
+size_t sha256::MultiHasher::Sum(std::span<const std::span<const uint8_t>> messages,
+                                std::span<uint8_t> digests) const {
+  Hasher h;
+  h.Initialize(hb);
+  auto count = (std::min)(messages.size(), digests.size() / h.digest_length);
+  messages = messages.first(count);
+  switch (auto [lanes, n] = sha256Lanes(); n) {
+  case 16:
+    sumLanes<uint32_t, 16, sha256_block_size>(lanes, hardware_block_function(), h.hash, messages, digests.data(),
+                                              h.digest_length);
+    break;
+  case 8:
+    sumLanes<uint32_t, 8, sha256_block_size>(lanes, hardware_block_function(), h.hash, messages, digests.data(),
+                                             h.digest_length);
+    break;
+  default:
+    sumSerial<Hasher>(hb, messages, digests.data(), h.digest_length);
+    break;
+  }
+  return count;
+}
+
+size_t sha512::MultiHasher::Lanes() { return sha512Lanes().second; }
+
+size_t sha512::MultiHasher::Sum(std::span<const std::span<const uint8_t>> messages,
+                                std::span<uint8_t> digests) const {
+  using single_function = void (*)(uint64_t *, const uint8_t *, size_t);
+  Hasher h;
+  h.Initialize(hb);
+  auto count = (std::min)(messages.size(), digests.size() / h.digest_length);
+  messages = messages.first(count);
+  switch (auto [lanes, n] = sha512Lanes(); n) {
+  case 8:
+    sumLanes<uint64_t, 8, sha512_block_size>(lanes, single_function{nullptr}, h.hash, messages, digests.data(),
+                                             h.digest_length);
+    break;
+  case 4:
+    sumLanes<uint64_t, 4, sha512_block_size>(lanes, single_function{nullptr}, h.hash, messages, digests.data(),
+                                             h.digest_length);
+    break;
+  default:
+    sumSerial<Hasher>(hb, messages, digests.data(), h.digest_length);
+    break;
+  }
+  return count;
+}
+
+size_t sha3::MultiHasher::Lanes() { return sha3Lanes().second; }
+
+size_t sha3::MultiHasher::Sum(std::span<const std::span<const uint8_t>> messages,
+                              std::span<uint8_t> digests) const {
+  Hasher h;
+  h.Initialize(hb);
+  auto digestLength = static_cast<size_t>(hb) / 8;
+  auto count = (std::min)(messages.size(), digests.size() / digestLength);
+  messages = messages.first(count);
+  switch (auto [lanes, n] = sha3Lanes(); n) {
+  case 8:
+    sumSponge<8>(lanes, h.block_size, messages, digests.data(), digestLength);
+    break;
+  case 4:
+    sumSponge<4>(lanes, h.block_size, messages, digests.data(), digestLength);
+    break;
+  case 2:
+    sumSponge<2>(lanes, h.block_size, messages, digests.data(), digestLength);
+    break;
+  default:
+    sumSerial<Hasher>(hb, messages, digests.data(), digestLength);
+    break;
+  }
+  return count;
+}
+} // namespace bela::hash
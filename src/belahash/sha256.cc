@@ -21,7 +21,7 @@
 
 namespace bela::hash::sha256 {
 //
-constexpr const uint32_t k256[64] = {
+const uint32_t k256[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98,
     0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
     0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8,
@@ -82,7 +82,7 @@ void Hasher::Initialize(HashBits hb_) {
  * @param hash algorithm state
  * @param block the message block to process
  */
-static void sha256_process_block(unsigned hash[8], unsigned block[16]) {
+static void sha256_process_block(unsigned hash[8], const unsigned block[16]) {
   unsigned A;
   unsigned B;
   unsigned C;
@@ -139,6 +139,47 @@ static void sha256_process_block(unsigned hash[8], unsigned block[16]) {
   hash[4] += E, hash[5] += F, hash[6] += G, hash[7] += H;
 }
 
+static void sha256_process_blocks(uint32_t hash[8], const uint8_t *data, size_t blocks) {
+  for (; blocks != 0; blocks--, data += sha256_block_size) {
+    if (IS_ALIGNED_32(data)) {
+      /* the most common case is processing of an already aligned message
+      without copying it */
+      sha256_process_block(hash, reinterpret_cast<const unsigned *>(data));
+      continue;
+    }
+    unsigned block[16];
+    memcpy(block, data, sha256_block_size);
+    sha256_process_block(hash, block);
+  }
+}
+
+// hardware_block_function runtime selection of the SHA-NI and ARMv8 kernels. it lives here, not next to the kernels:
+// code in a file built with -msha or +crypto may use those instructions anywhere, even before a CPU check
+block_function hardware_block_function() {
+  [[maybe_unused]] const auto &features = internal::cpu();
+#if defined(BELA_HASH_X86)
+  if (features.sha && features.ssse3 && features.sse41) {
+    return process_blocks_shani;
+  }
+#elif defined(BELA_HASH_ARM64)
+  if (features.arm_sha2) {
+    return process_blocks_armv8;
+  }
+#endif
+  return nullptr;
+}
+
+// process_blocks SHA-NI or ARMv8 SHA2 when the CPU supports them, selected once
+static void process_blocks(uint32_t hash[8], const uint8_t *data, size_t blocks) {
+  static const block_function fn = [] {
+    if (auto hw = hardware_block_function(); hw != nullptr) {
+      return hw;
+    }
+    return static_cast<block_function>(sha256_process_blocks);
+  }();
+  fn(hash, data, blocks);
+}
+
 void Hasher::Update(const void *input, size_t input_len) {
   auto msg = reinterpret_cast<const uint8_t *>(input);
   size_t index = (size_t)length & 63;
@@ -153,24 +194,14 @@ void Hasher::Update(const void *input, size_t input_len) {
     }
 
     /* process partial block */
-    sha256_process_block(hash, (unsigned *)message);
+    process_blocks(hash, reinterpret_cast<const uint8_t *>(message), 1);
     msg += left;
     input_len -= left;
   }
-  while (input_len >= sha256_block_size) {
-    unsigned *aligned_message_block;
-    if (IS_ALIGNED_32(msg)) {
-      /* the most common case is processing of an already aligned message
-      without copying it */
-      aligned_message_block = (unsigned *)msg;
-    } else {
-      memcpy(message, msg, sha256_block_size);
-      aligned_message_block = (unsigned *)message;
-    }
-
-    sha256_process_block(hash, aligned_message_block);
-    msg += sha256_block_size;
-    input_len -= sha256_block_size;
+  if (auto blocks = input_len / sha256_block_size; blocks != 0) {
+    process_blocks(hash, msg, blocks);
+    msg += blocks * sha256_block_size;
+    input_len -= blocks * sha256_block_size;
   }
   if (input_len != 0) {
     memcpy(message, msg, input_len); /* save leftovers */
@@ -192,7 +223,7 @@ void Hasher::Finalize(uint8_t *out, size_t out_len) {
     while (index < 16) {
       message[index++] = 0;
     }
-    sha256_process_block(hash, message);
+    process_blocks(hash, reinterpret_cast<const uint8_t *>(message), 1);
     index = 0;
   }
   while (index < 14) {
@@ -200,7 +231,7 @@ void Hasher::Finalize(uint8_t *out, size_t out_len) {
   }
   message[14] = bela::frombe((unsigned)(length >> 29));
   message[15] = bela::frombe((unsigned)(length << 3));
-  sha256_process_block(hash, message);
+  process_blocks(hash, reinterpret_cast<const uint8_t *>(message), 1);
 
   if (out != nullptr && out_len >= digest_length) {
     be32_copy(out, 0, hash, digest_length);
@@ -0,0 +1,61 @@
+// Keccak-f[1600] with ARMv8.2 SHA3 extensions: theta with EOR3 and RAX1, rho with XAR and chi with BCAX
+#include <bela/hash.hpp>
+#include "hashinternal.hpp"
+
+#if defined(BELA_HASH_ARM64_SHA3)
+#include <arm_neon.h>
+
+namespace bela::hash::sha3 {
+namespace {
+#define KECCAK_XOR(a, b) veorq_u64(a, b)
+#define KECCAK_XOR5(a, b, c, d, e) veor3q_u64(veor3q_u64(a, b, c), d, e)
+#define KECCAK_ROL1XOR(a, b) vrax1q_u64(a, b)
+#define KECCAK_XORROL(a, b, n) vxarq_u64(a, b, 64 - (n))
+#define KECCAK_CHI(a, b, c) vbcaxq_u64(a, c, b)
+
+// permute two states, lane i of every word belongs to state i
+inline void permute(uint64x2_t A[25]) {
+  uint64x2_t E[25];
+  for (int round = 0; round < 24; round += 2) {
+    KECCAK_ROUND(A, E, vdupq_n_u64(keccak_round_constants[round]), KECCAK_CHI_ROW);
+    KECCAK_ROUND(E, A, vdupq_n_u64(keccak_round_constants[round + 1]), KECCAK_CHI_ROW);
+  }
+}
+} // namespace
+
+void absorb_armv8(uint64_t state[25], const uint8_t *data, size_t blocks, size_t block_size) {
+  // the second lane is idle, two states cost the same as one
+  uint64x2_t A[25];
+  for (int i = 0; i < 25; i++) {
+    A[i] = vdupq_n_u64(state[i]);
+  }
+  const auto words = block_size / 8;
+  for (; blocks != 0; blocks--, data += block_size) {
+    for (size_t i = 0; i < words; i++) {
+      A[i] = veorq_u64(A[i], vdupq_n_u64(bela::cast_fromle<uint64_t>(data + i * 8)));
+    }
+    permute(A);
+  }
+  for (int i = 0; i < 25; i++) {
+    state[i] = vgetq_lane_u64(A[i], 0);
+  }
+}
+
+void lanes_armv8(uint64_t *state, const uint8_t *const *blocks, size_t block_size) {
+  uint64x2_t A[25];
+  for (int i = 0; i < 25; i++) {
+    A[i] = vld1q_u64(state + i * 2);
+  }
+  for (size_t i = 0; i < block_size / 8; i++) {
+    auto w = vcombine_u64(vcreate_u64(bela::cast_fromle<uint64_t>(blocks[0] + i * 8)),
+                          vcreate_u64(bela::cast_fromle<uint64_t>(blocks[1] + i * 8)));
+    A[i] = veorq_u64(A[i], w);
+  }
+  permute(A);
+  for (int i = 0; i < 25; i++) {
+    vst1q_u64(state + i * 2, A[i]);
+  }
+}
+} // namespace bela::hash::sha3
+
+#endif
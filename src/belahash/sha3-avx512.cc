@@ -0,0 +1,126 @@
+// Keccak-f[1600] on one state with AVX-512F: plane y in the low 5 qwords of a zmm register, theta and chi with
+// vpternlogq, rho with vprolvq and pi as a 5x5 lane transpose
+#include <bela/hash.hpp>
+#include <algorithm>
+#include "hashinternal.hpp"
+
+#if defined(BELA_HASH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace bela::hash::sha3 {
+namespace {
+// vpternlogq truth tables of a ^ b ^ c and a ^ (~b & c)
+constexpr int ternXor3 = 0x96;
+constexpr int ternChi = 0xD2;
+constexpr __mmask8 planeMask = 0x1F;
+
+// qword indexes of vpermq/vpermt2q, lanes 5..7 are don't care
+alignas(64) const uint64_t rotate1[8] = {1, 2, 3, 4, 0, 5, 6, 7};
+alignas(64) const uint64_t rotate2[8] = {2, 3, 4, 0, 1, 5, 6, 7};
+alignas(64) const uint64_t rotate4[8] = {4, 0, 1, 2, 3, 5, 6, 7};
+alignas(64) const uint64_t rho[5][8] = {
+    {0, 1, 62, 28, 27}, {36, 44, 6, 55, 20}, {3, 10, 43, 25, 39}, {41, 45, 15, 21, 8}, {18, 2, 61, 56, 14},
+};
+// pi: plane y lane x = old plane x lane (x + 3y) % 5. pairs of planes 0,1 and 2,3 for y = 0..3 and y = 4, then the
+// four lanes of y are joined with the lane of plane 4
+alignas(64) const uint64_t piPairs[8] = {0, 9, 3, 12, 1, 10, 4, 8};
+alignas(64) const uint64_t piPairs4[8] = {2, 11, 0, 0, 0, 0, 0, 0};
+alignas(64) const uint64_t piPairsHigh[8] = {2, 11, 0, 9, 3, 12, 1, 10};
+alignas(64) const uint64_t piPairsHigh4[8] = {4, 8, 0, 0, 0, 0, 0, 0};
+alignas(64) const uint64_t piJoinLow[8] = {0, 1, 8, 9, 2, 3, 10, 11};
+alignas(64) const uint64_t piJoinHigh[8] = {4, 5, 12, 13, 6, 7, 14, 15};
+alignas(64) const uint64_t piPlane[5][8] = {
+    {0, 1, 2, 3, 12}, {4, 5, 6, 7, 10}, {0, 1, 2, 3, 8}, {4, 5, 6, 7, 11}, {0, 1, 2, 3, 9},
+};
+
+inline __m512i load(const uint64_t *p) { return _mm512_load_si512(p); }
+
+// planeMaskOf lanes of plane y covered by a block of words qwords
+inline __mmask8 planeMaskOf(size_t words, size_t y) {
+  if (words <= y * 5) {
+    return 0;
+  }
+  auto n = (std::min)(words - y * 5, size_t{5});
+  return static_cast<__mmask8>((1u << n) - 1);
+}
+} // namespace
+
+void absorb_avx512(uint64_t state[25], const uint8_t *data, size_t blocks, size_t block_size) {
+  const auto words = block_size / 8;
+  const __mmask8 m0 = planeMaskOf(words, 0);
+  const __mmask8 m1 = planeMaskOf(words, 1);
+  const __mmask8 m2 = planeMaskOf(words, 2);
+  const __mmask8 m3 = planeMaskOf(words, 3);
+  const __mmask8 m4 = planeMaskOf(words, 4);
+  const auto r1 = load(rotate1);
+  const auto r2 = load(rotate2);
+  const auto r4 = load(rotate4);
+  const auto rho0 = load(rho[0]);
+  const auto rho1 = load(rho[1]);
+  const auto rho2 = load(rho[2]);
+  const auto rho3 = load(rho[3]);
+  const auto rho4 = load(rho[4]);
+  const auto pairs = load(piPairs);
+  const auto pairs4 = load(piPairs4);
+  const auto pairsHigh = load(piPairsHigh);
+  const auto pairsHigh4 = load(piPairsHigh4);
+  const auto joinLow = load(piJoinLow);
+  const auto joinHigh = load(piJoinHigh);
+  const auto plane0 = load(piPlane[0]);
+  const auto plane1 = load(piPlane[1]);
+  const auto plane2 = load(piPlane[2]);
+  const auto plane3 = load(piPlane[3]);
+  const auto plane4 = load(piPlane[4]);
+  auto P0 = _mm512_maskz_loadu_epi64(planeMask, state);
+  auto P1 = _mm512_maskz_loadu_epi64(planeMask, state + 5);
+  auto P2 = _mm512_maskz_loadu_epi64(planeMask, state + 10);
+  auto P3 = _mm512_maskz_loadu_epi64(planeMask, state + 15);
+  auto P4 = _mm512_maskz_loadu_epi64(planeMask, state + 20);
+  auto chi = [&](__m512i p) {
+    return _mm512_ternarylogic_epi64(p, _mm512_permutexvar_epi64(r1, p), _mm512_permutexvar_epi64(r2, p), ternChi);
+  };
+  for (; blocks != 0; blocks--, data += block_size) {
+    P0 = _mm512_xor_si512(P0, _mm512_maskz_loadu_epi64(m0, data));
+    P1 = _mm512_xor_si512(P1, _mm512_maskz_loadu_epi64(m1, data + 40));
+    P2 = _mm512_xor_si512(P2, _mm512_maskz_loadu_epi64(m2, data + 80));
+    P3 = _mm512_xor_si512(P3, _mm512_maskz_loadu_epi64(m3, data + 120));
+    P4 = _mm512_xor_si512(P4, _mm512_maskz_loadu_epi64(m4, data + 160));
+    for (auto rc : keccak_round_constants) {
+      // theta and rho
+      auto C = _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(P0, P1, P2, ternXor3), P3, P4, ternXor3);
+      auto D = _mm512_xor_si512(_mm512_permutexvar_epi64(r4, C), _mm512_rol_epi64(_mm512_permutexvar_epi64(r1, C), 1));
+      P0 = _mm512_rolv_epi64(_mm512_xor_si512(P0, D), rho0);
+      P1 = _mm512_rolv_epi64(_mm512_xor_si512(P1, D), rho1);
+      P2 = _mm512_rolv_epi64(_mm512_xor_si512(P2, D), rho2);
+      P3 = _mm512_rolv_epi64(_mm512_xor_si512(P3, D), rho3);
+      P4 = _mm512_rolv_epi64(_mm512_xor_si512(P4, D), rho4);
+      // pi
+      auto u0 = _mm512_permutex2var_epi64(P0, pairs, P1);
+      auto u1 = _mm512_permutex2var_epi64(P0, pairs4, P1);
+      auto v0 = _mm512_permutex2var_epi64(P2, pairsHigh, P3);
+      auto v1 = _mm512_permutex2var_epi64(P2, pairsHigh4, P3);
+      auto w01 = _mm512_permutex2var_epi64(u0, joinLow, v0);
+      auto w23 = _mm512_permutex2var_epi64(u0, joinHigh, v0);
+      auto w4 = _mm512_permutex2var_epi64(u1, joinLow, v1);
+      // chi and iota
+      P0 = _mm512_xor_si512(chi(_mm512_permutex2var_epi64(w01, plane0, P4)),
+                            _mm512_maskz_set1_epi64(1, static_cast<long long>(rc)));
+      P1 = chi(_mm512_permutex2var_epi64(w01, plane1, P4));
+      P2 = chi(_mm512_permutex2var_epi64(w23, plane2, P4));
+      P3 = chi(_mm512_permutex2var_epi64(w23, plane3, P4));
+      P4 = chi(_mm512_permutex2var_epi64(w4, plane4, P4));
+    }
+  }
+  _mm512_mask_storeu_epi64(state, planeMask, P0);
+  _mm512_mask_storeu_epi64(state + 5, planeMask, P1);
+  _mm512_mask_storeu_epi64(state + 10, planeMask, P2);
+  _mm512_mask_storeu_epi64(state + 15, planeMask, P3);
+  _mm512_mask_storeu_epi64(state + 20, planeMask, P4);
+}
+} // namespace bela::hash::sha3
+
+#endif
@@ -25,7 +25,7 @@ namespace bela::hash::sha512 {
 /* SHA-384 and SHA-512 constants for 80 rounds. These qwords represent
  * the first 64 bits of the fractional parts of the cube
  * roots of the first 80 prime numbers. */
-static constexpr const uint64_t k512[80] = {
+const uint64_t k512[80] = {
     I64(0x428a2f98d728ae22), I64(0x7137449123ef65cd), I64(0xb5c0fbcfec4d3b2f),
     I64(0xe9b5dba58189dbbc), I64(0x3956c25bf348b538), I64(0x59f111f1b605d019),
     I64(0x923f82a4af194f9b), I64(0xab1c5ed5da6d8118), I64(0xd807aa98a3030242),
@@ -0,0 +1,129 @@
+// api set schema
+#include "internal.hpp"
+
+// https://www.geoffchappell.com/studies/windows/win32/apisetschema/index.htm
+// API_SET_NAMESPACE { Version Size Flags Count EntryOffset HashOffset HashFactor }
+// API_SET_NAMESPACE_ENTRY { Flags NameOffset NameLength HashedLength ValueOffset ValueCount }
+// API_SET_VALUE_ENTRY { Flags NameOffset NameLength ValueOffset ValueLength }
+// offsets are relative to the namespace, lengths are in bytes of UTF-16LE
+
+namespace bela::pe {
+constexpr std::string_view apisetSectionName = ".apiset";
+constexpr uint32_t apisetSchemaVersion = 6;
+constexpr size_t apisetNamespaceSize = 28;
+constexpr size_t apisetEntrySize = 24;
+constexpr size_t apisetValueSize = 20;
+
+bool ApiSetSchema::IsApiSetName(std::string_view name) {
+  return bela::StartsWithIgnoreCase(name, "api-") || bela::StartsWithIgnoreCase(name, "ext-");
+}
+
+bool ApiSetSchema::Load(std::wstring_view file, bela::error_code &ec) {
+  File pf;
+  if (!pf.NewFile(file, ec)) {
+    return false;
+  }
+  for (const auto &sec : pf.Sections()) {
+    if (sec.Name != apisetSectionName) {
+      continue;
+    }
+    auto data = pf.SectionData(sec, ec);
+    if (!data) {
+      return false;
+    }
+    return Parse(*data, ec);
+  }
+  ec = bela::make_error_code(ErrGeneral, L"'", file, L"' no .apiset section");
+  return false;
+}
+
+bool ApiSetSchema::Parse(bela::bytes_view data, bela::error_code &ec) {
+  if (data.size() < apisetNamespaceSize) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"api set schema too small");
+    return false;
+  }
+  if (auto version = data.cast_fromle<uint32_t>(0); version != apisetSchemaVersion) {
+    ec = bela::make_error_code(bela::ErrUnimplemented, L"unsupported api set schema version ", version);
+    return false;
+  }
+  auto count = static_cast<size_t>(data.cast_fromle<uint32_t>(12));
+  auto entryOffset = static_cast<size_t>(data.cast_fromle<uint32_t>(16));
+  if (entryOffset > data.size() || count > (data.size() - entryOffset) / apisetEntrySize) {
+    ec = bela::make_error_code(ErrGeneral, L"api set entries overflow schema");
+    return false;
+  }
+  // names are ASCII, store lower case for case insensitive lookup
+  auto readName = [&](size_t offset, size_t length, std::string &s) -> bool {
+    if (offset > data.size() || length > data.size() - offset) {
+      return false;
+    }
+    s.clear();
+    for (size_t i = 0; i + 1 < length; i += 2) {
+      auto ch = data.cast_fromle<uint16_t>(offset + i);
+      s.push_back(ch < 0x80 ? bela::ascii_tolower(static_cast<char>(ch)) : '?');
+    }
+    return true;
+  };
+  bela::flat_hash_map<std::string, contract> parsed;
+  parsed.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    auto e = entryOffset + i * apisetEntrySize;
+    auto valueOffset = static_cast<size_t>(data.cast_fromle<uint32_t>(e + 16));
+    auto valueCount = static_cast<size_t>(data.cast_fromle<uint32_t>(e + 20));
+    std::string name;
+    // HashedLength covers the name up to its last hyphen, the version suffix is not part of the lookup
+    if (!readName(data.cast_fromle<uint32_t>(e + 4), data.cast_fromle<uint32_t>(e + 12), name) ||
+        valueOffset > data.size() || valueCount > (data.size() - valueOffset) / apisetValueSize) {
+      ec = bela::make_error_code(ErrGeneral, L"bad api set entry ", i);
+      return false;
+    }
+    contract c;
+    auto hasDefault = false;
+    for (size_t j = 0; j < valueCount; j++) {
+      auto v = valueOffset + j * apisetValueSize;
+      std::string importer;
+      std::string host;
+      if (!readName(data.cast_fromle<uint32_t>(v + 4), data.cast_fromle<uint32_t>(v + 8), importer) ||
+          !readName(data.cast_fromle<uint32_t>(v + 12), data.cast_fromle<uint32_t>(v + 16), host)) {
+        ec = bela::make_error_code(ErrGeneral, L"bad api set value ", i, L":", j);
+        return false;
+      }
+      if (importer.empty()) {
+        if (!hasDefault) {
+          c.host = std::move(host);
+          hasDefault = true;
+        }
+        continue;
+      }
+      c.exceptions.emplace_back(std::move(importer), std::move(host));
+    }
+    parsed.insert_or_assign(std::move(name), std::move(c));
+  }
+  contracts = std::move(parsed);
+  return true;
+}
+
+std::optional<std::string> ApiSetSchema::Resolve(std::string_view name, std::string_view importer) const {
+  if (!IsApiSetName(name)) {
+    return std::nullopt;
+  }
+  auto key = bela::AsciiStrToLower(name);
+  if (key.ends_with(".dll")) {
+    key.resize(key.size() - 4);
+  }
+  if (auto pos = key.rfind('-'); pos != std::string::npos) {
+    key.resize(pos);
+  }
+  auto it = contracts.find(key);
+  if (it == contracts.end()) {
+    return std::nullopt;
+  }
+  for (const auto &[from, host] : it->second.exceptions) {
+    if (bela::EqualsIgnoreCase(from, importer)) {
+      return std::make_optional(host);
+    }
+  }
+  return std::make_optional(it->second.host);
+}
+
+} // namespace bela::pe
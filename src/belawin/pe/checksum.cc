@@ -0,0 +1,191 @@
+// PE CheckSum and Authenticode hashed ranges
+#include "internal.hpp"
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BELA_PE_CHECKSUM_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BELA_PE_CHECKSUM_NEON 1
+#endif
+
+// https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#the-attribute-certificate-table-image-only
+// https://download.microsoft.com/download/9/c/5/9c5b2167-8017-4bae-9fde-d599bac8184a/Authenticode_PE.docx
+
+namespace bela::pe {
+namespace {
+constexpr int64_t checksumFieldOffset = 64;  // same in IMAGE_OPTIONAL_HEADER32 and IMAGE_OPTIONAL_HEADER64
+constexpr int64_t dataDirectoryOffset32 = 96; // IMAGE_OPTIONAL_HEADER32::DataDirectory
+constexpr int64_t dataDirectoryOffset64 = 112;
+constexpr size_t streamChunkSize = 512 * 1024; // hashed and summed while still in cache
+
+// sumWords sum of little endian 16-bit words, n is even. lanes are flushed before they may overflow
+uint64_t sumWords(const uint8_t *p, size_t n) {
+  uint64_t sum = 0;
+  size_t i = 0;
+#if defined(BELA_PE_CHECKSUM_SSE2)
+  // each 32-bit lane adds at most 2 * 0xFFFF per block
+  constexpr size_t flushBlocks = 32768;
+  const auto zero = _mm_setzero_si128();
+  auto acc64 = _mm_setzero_si128();
+  while (n - i >= 16) {
+    auto blocks = (std::min)((n - i) / 16, flushBlocks);
+    auto acc32 = _mm_setzero_si128();
+    for (size_t k = 0; k < blocks; k++, i += 16) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+      acc32 = _mm_add_epi32(acc32, _mm_unpacklo_epi16(v, zero));
+      acc32 = _mm_add_epi32(acc32, _mm_unpackhi_epi16(v, zero));
+    }
+    acc64 = _mm_add_epi64(acc64, _mm_unpacklo_epi32(acc32, zero));
+    acc64 = _mm_add_epi64(acc64, _mm_unpackhi_epi32(acc32, zero));
+  }
+  alignas(16) uint64_t lanes[2];
+  _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc64);
+  sum = lanes[0] + lanes[1];
+#elif defined(BELA_PE_CHECKSUM_NEON)
+  constexpr size_t flushBlocks = 32768;
+  auto acc64 = vdupq_n_u64(0);
+  while (n - i >= 16) {
+    auto blocks = (std::min)((n - i) / 16, flushBlocks);
+    auto acc32 = vdupq_n_u32(0);
+    for (size_t k = 0; k < blocks; k++, i += 16) {
+      acc32 = vpadalq_u16(acc32, vld1q_u16(reinterpret_cast<const uint16_t *>(p + i)));
+    }
+    acc64 = vpadalq_u32(acc64, acc32);
+  }
+  sum = vgetq_lane_u64(acc64, 0) + vgetq_lane_u64(acc64, 1);
+#else
+  // SWAR: two 32-bit lanes of a 64-bit word hold the sum of even and odd words
+  constexpr uint64_t lowWords = 0x0000FFFF0000FFFFull;
+  constexpr size_t flushBlocks = 32768;
+  while (n - i >= 8) {
+    auto blocks = (std::min)((n - i) / 8, flushBlocks);
+    uint64_t acc = 0;
+    for (size_t k = 0; k < blocks; k++, i += 8) {
+      uint64_t v;
+      memcpy(&v, p + i, sizeof(v));
+      v = bela::fromle(v);
+      acc += (v & lowWords) + ((v >> 16) & lowWords);
+    }
+    sum += (acc & 0xFFFFFFFFull) + (acc >> 32);
+  }
+#endif
+  for (; i < n; i += 2) {
+    sum += static_cast<uint64_t>(p[i]) | (static_cast<uint64_t>(p[i + 1]) << 8);
+  }
+  return sum;
+}
+
+// checksumState one's complement sum of the file as 16-bit words, chunks may start at an odd offset
+struct checksumState {
+  uint64_t sum{0};
+  void Update(const uint8_t *p, size_t n, int64_t offset) {
+    if (n == 0) {
+      return;
+    }
+    if ((offset & 1) != 0) {
+      sum += static_cast<uint64_t>(p[0]) << 8;
+      p++;
+      n--;
+    }
+    auto even = n & ~static_cast<size_t>(1);
+    sum += sumWords(p, even);
+    if (even != n) {
+      sum += p[even];
+    }
+  }
+  uint32_t Final(int64_t size) const {
+    auto s = sum;
+    while ((s >> 16) != 0) {
+      s = (s & 0xFFFF) + (s >> 16);
+    }
+    return static_cast<uint32_t>(s) + static_cast<uint32_t>(size);
+  }
+};
+
+struct fileRange {
+  int64_t begin;
+  int64_t end;
+};
+
+// forEachIncluded call fn on the parts of chunk [offset, offset+n) outside the sorted skips
+template <typename Fn>
+void forEachIncluded(const uint8_t *p, size_t n, int64_t offset, std::span<const fileRange> skips, Fn fn) {
+  auto pos = offset;
+  auto end = offset + static_cast<int64_t>(n);
+  for (const auto &r : skips) {
+    if (r.end <= pos || r.begin >= end) {
+      continue;
+    }
+    if (r.begin > pos) {
+      fn(p + (pos - offset), static_cast<size_t>(r.begin - pos), pos);
+    }
+    pos = (std::max)(pos, r.end);
+  }
+  if (pos < end) {
+    fn(p + (pos - offset), static_cast<size_t>(end - pos), pos);
+  }
+}
+} // namespace
+
+bool File::Authenticode(const DigestWriter &w, uint32_t &checksum, bela::error_code &ec) const {
+  if (ohOffset == 0) {
+    ec = bela::make_error_code(ErrGeneral, L"pe: image has no optional header");
+    return false;
+  }
+  const fileRange checksumField{ohOffset + checksumFieldOffset, ohOffset + checksumFieldOffset + 4};
+  if (checksumField.end > size) {
+    ec = bela::make_error_code(ErrGeneral, L"pe: optional header out of file");
+    return false;
+  }
+  // skips sorted by offset: CheckSum, security directory entry, certificate table (always after headers)
+  fileRange skips[3] = {checksumField};
+  size_t skipCount = 1;
+  if (oh.NumberOfRvaAndSizes > IMAGE_DIRECTORY_ENTRY_SECURITY) {
+    auto entry = ohOffset + (oh.Is64Bit ? dataDirectoryOffset64 : dataDirectoryOffset32) +
+                 static_cast<int64_t>(sizeof(DataDirectory)) * IMAGE_DIRECTORY_ENTRY_SECURITY;
+    skips[skipCount++] = fileRange{entry, entry + static_cast<int64_t>(sizeof(DataDirectory))};
+    // security directory VirtualAddress is a file offset
+    const auto &dd = oh.DataDirectory[IMAGE_DIRECTORY_ENTRY_SECURITY];
+    if (dd.Size != 0) {
+      auto begin = static_cast<int64_t>(dd.VirtualAddress);
+      auto end = begin + static_cast<int64_t>(dd.Size);
+      if (begin < entry + static_cast<int64_t>(sizeof(DataDirectory)) || end > size) {
+        ec = bela::make_error_code(ErrGeneral, L"pe: certificate table [", begin, L",", end, L") out of file");
+        return false;
+      }
+      skips[skipCount++] = fileRange{begin, end};
+    }
+  }
+  const auto hashSkips = std::span<const fileRange>(skips, skipCount);
+  const auto sumSkips = hashSkips.first(1);
+  checksumState cs;
+  auto process = [&](const uint8_t *p, size_t n, int64_t offset) {
+    forEachIncluded(p, n, offset, sumSkips,
+                    [&](const uint8_t *data, size_t len, int64_t pos) { cs.Update(data, len, pos); });
+    if (w) {
+      forEachIncluded(p, n, offset, hashSkips, [&](const uint8_t *data, size_t len, int64_t) { w(data, len); });
+    }
+  };
+  if (image.data() != nullptr) {
+    for (int64_t offset = 0; offset < size; offset += streamChunkSize) {
+      auto n = static_cast<size_t>((std::min)(size - offset, static_cast<int64_t>(streamChunkSize)));
+      process(image.data() + offset, n, offset);
+    }
+    checksum = cs.Final(size);
+    return true;
+  }
+  bela::Buffer buffer(streamChunkSize);
+  for (int64_t offset = 0; offset < size; offset += streamChunkSize) {
+    auto n = static_cast<size_t>((std::min)(size - offset, static_cast<int64_t>(streamChunkSize)));
+    auto chunk = buffer.make_span(n);
+    if (!readAt(chunk, offset, ec)) {
+      return false;
+    }
+    process(chunk.data(), n, offset);
+  }
+  checksum = cs.Final(size);
+  return true;
+}
+
+} // namespace bela::pe
@@ -17,7 +17,7 @@ bool File::LookupDelayImports(FunctionTable::symbols_map_t &sm, bela::error_code
   if (!sdata) {
     return false;
   }
-  auto bv = sdata->as_bytes_view();
+  auto bv = *sdata;
   // seek to the virtual address specified in the delay import data directory
   std::vector<image_delayload_descriptor> ida;
   for (size_t offset = delay->VirtualAddress - sec->VirtualAddress; offset < sec->Size;
@@ -96,6 +96,359 @@ void FlagsToText(const IMAGE_COR20_HEADER *cr, std::string &text) {
   }
 }
 
+// ECMA-335 II.24.2.6 #~ stream. column kinds: below ClrTableCount a simple index into that table
+enum column : uint8_t {
+  colU8 = 0x40,
+  colU16,
+  colU32,
+  colString,
+  colGuid,
+  colBlob,
+  // II.24.2.6 coded indexes
+  colTypeDefOrRef = 0x50,
+  colHasConstant,
+  colHasCustomAttribute,
+  colHasFieldMarshal,
+  colHasDeclSecurity,
+  colMemberRefParent,
+  colHasSemantics,
+  colMethodDefOrRef,
+  colMemberForwarded,
+  colImplementation,
+  colCustomAttributeType,
+  colResolutionScope,
+  colTypeOrMethodDef,
+};
+
+constexpr uint8_t tableUnused = 0xFF;
+
+struct codedIndex {
+  uint8_t bits;
+  uint8_t count;
+  uint8_t tables[22];
+};
+
+#define CLRT(name) static_cast<uint8_t>(ClrTable::name)
+constexpr codedIndex codedIndexes[] = {
+    {2, 3, {CLRT(TypeDef), CLRT(TypeRef), CLRT(TypeSpec)}},
+    {2, 3, {CLRT(Field), CLRT(Param), CLRT(Property)}},
+    {5,
+     22,
+     {CLRT(MethodDef), CLRT(Field), CLRT(TypeRef), CLRT(TypeDef), CLRT(Param), CLRT(InterfaceImpl), CLRT(MemberRef),
+      CLRT(Module), CLRT(DeclSecurity), CLRT(Property), CLRT(Event), CLRT(StandAloneSig), CLRT(ModuleRef),
+      CLRT(TypeSpec), CLRT(Assembly), CLRT(AssemblyRef), CLRT(File), CLRT(ExportedType), CLRT(ManifestResource),
+      CLRT(GenericParam), CLRT(GenericParamConstraint), CLRT(MethodSpec)}},
+    {1, 2, {CLRT(Field), CLRT(Param)}},
+    {2, 3, {CLRT(TypeDef), CLRT(MethodDef), CLRT(Assembly)}},
+    {3, 5, {CLRT(TypeDef), CLRT(TypeRef), CLRT(ModuleRef), CLRT(MethodDef), CLRT(TypeSpec)}},
+    {1, 2, {CLRT(Event), CLRT(Property)}},
+    {1, 2, {CLRT(MethodDef), CLRT(MemberRef)}},
+    {1, 2, {CLRT(Field), CLRT(MethodDef)}},
+    {2, 3, {CLRT(File), CLRT(AssemblyRef), CLRT(ExportedType)}},
+    {3, 5, {tableUnused, tableUnused, CLRT(MethodDef), CLRT(MemberRef), tableUnused}},
+    {2, 4, {CLRT(Module), CLRT(ModuleRef), CLRT(AssemblyRef), CLRT(TypeRef)}},
+    {1, 2, {CLRT(TypeDef), CLRT(MethodDef)}},
+};
+
+struct tableSchema {
+  uint8_t count;
+  uint8_t columns[9];
+};
+
+// II.22 column layout of every table, in table number order
+constexpr tableSchema tableSchemas[ClrTableCount] = {
+    {5, {colU16, colString, colGuid, colGuid, colGuid}},                                   // Module
+    {3, {colResolutionScope, colString, colString}},                                       // TypeRef
+    {6, {colU32, colString, colString, colTypeDefOrRef, CLRT(Field), CLRT(MethodDef)}},    // TypeDef
+    {1, {CLRT(Field)}},                                                                    // FieldPtr
+    {3, {colU16, colString, colBlob}},                                                     // Field
+    {1, {CLRT(MethodDef)}},                                                                // MethodPtr
+    {6, {colU32, colU16, colU16, colString, colBlob, CLRT(Param)}},                        // MethodDef
+    {1, {CLRT(Param)}},                                                                    // ParamPtr
+    {3, {colU16, colU16, colString}},                                                      // Param
+    {2, {CLRT(TypeDef), colTypeDefOrRef}},                                                 // InterfaceImpl
+    {3, {colMemberRefParent, colString, colBlob}},                                         // MemberRef
+    {4, {colU8, colU8, colHasConstant, colBlob}},                                          // Constant
+    {3, {colHasCustomAttribute, colCustomAttributeType, colBlob}},                         // CustomAttribute
+    {2, {colHasFieldMarshal, colBlob}},                                                    // FieldMarshal
+    {3, {colU16, colHasDeclSecurity, colBlob}},                                            // DeclSecurity
+    {3, {colU16, colU32, CLRT(TypeDef)}},                                                  // ClassLayout
+    {2, {colU32, CLRT(Field)}},                                                            // FieldLayout
+    {1, {colBlob}},                                                                        // StandAloneSig
+    {2, {CLRT(TypeDef), CLRT(Event)}},                                                     // EventMap
+    {1, {CLRT(Event)}},                                                                    // EventPtr
+    {3, {colU16, colString, colTypeDefOrRef}},                                             // Event
+    {2, {CLRT(TypeDef), CLRT(Property)}},                                                  // PropertyMap
+    {1, {CLRT(Property)}},                                                                 // PropertyPtr
+    {3, {colU16, colString, colBlob}},                                                     // Property
+    {3, {colU16, CLRT(MethodDef), colHasSemantics}},                                       // MethodSemantics
+    {3, {CLRT(TypeDef), colMethodDefOrRef, colMethodDefOrRef}},                            // MethodImpl
+    {1, {colString}},                                                                      // ModuleRef
+    {1, {colBlob}},                                                                        // TypeSpec
+    {4, {colU16, colMemberForwarded, colString, CLRT(ModuleRef)}},                         // ImplMap
+    {2, {colU32, CLRT(Field)}},                                                            // FieldRVA
+    {2, {colU32, colU32}},                                                                 // ENCLog
+    {1, {colU32}},                                                                         // ENCMap
+    {9, {colU32, colU16, colU16, colU16, colU16, colU32, colBlob, colString, colString}},  // Assembly
+    {1, {colU32}},                                                                         // AssemblyProcessor
+    {3, {colU32, colU32, colU32}},                                                         // AssemblyOS
+    {9, {colU16, colU16, colU16, colU16, colU32, colBlob, colString, colString, colBlob}}, // AssemblyRef
+    {2, {colU32, CLRT(AssemblyRef)}},                                                      // AssemblyRefProcessor
+    {4, {colU32, colU32, colU32, CLRT(AssemblyRef)}},                                      // AssemblyRefOS
+    {3, {colU32, colString, colBlob}},                                                     // File
+    {5, {colU32, colU32, colString, colString, colImplementation}},                        // ExportedType
+    {4, {colU32, colU32, colString, colImplementation}},                                   // ManifestResource
+    {2, {CLRT(TypeDef), CLRT(TypeDef)}},                                                   // NestedClass
+    {4, {colU16, colU16, colTypeOrMethodDef, colString}},                                  // GenericParam
+    {2, {colMethodDefOrRef, colBlob}},                                                     // MethodSpec
+    {2, {CLRT(GenericParam), colTypeDefOrRef}},                                            // GenericParamConstraint
+};
+#undef CLRT
+
+constexpr uint8_t heapStringsWide = 0x01;
+constexpr uint8_t heapGuidWide = 0x02;
+constexpr uint8_t heapBlobWide = 0x04;
+constexpr uint8_t heapExtraData = 0x40;
+constexpr size_t guidSize = 16;
+
+// rvaView view of image from rva to the end of its section
+std::optional<bela::bytes_view> rvaView(const File &file, uint32_t rva, bela::error_code &ec) {
+  for (const auto &s : file.Sections()) {
+    if (s.VirtualAddress <= rva && rva - s.VirtualAddress < s.Size) {
+      auto data = file.SectionData(s, ec);
+      if (!data) {
+        return std::nullopt;
+      }
+      return std::make_optional(data->subview(rva - s.VirtualAddress));
+    }
+  }
+  ec = bela::make_error_code(ErrGeneral, L"rva ", rva, L" not in any section");
+  return std::nullopt;
+}
+
+inline size_t align4(size_t n) { return (n + 3) & ~static_cast<size_t>(3); }
+
+bool ClrMetadata::Open(const File &file, bela::error_code &ec) {
+  const auto &oh = file.Header();
+  if (oh.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_COMHEADER ||
+      oh.DataDirectory[IMAGE_DIRECTORY_ENTRY_COMHEADER].VirtualAddress == 0) {
+    ec = bela::make_error_code(ErrGeneral, L"not a .NET assembly");
+    return false;
+  }
+  auto crv = rvaView(file, oh.DataDirectory[IMAGE_DIRECTORY_ENTRY_COMHEADER].VirtualAddress, ec);
+  if (!crv) {
+    return false;
+  }
+  auto cr = crv->checked_cast<IMAGE_COR20_HEADER>(0);
+  if (cr == nullptr) {
+    ec = bela::make_error_code(ErrGeneral, L"bad CLR header");
+    return false;
+  }
+  auto mdv = rvaView(file, bela::fromle(cr->MetaData.VirtualAddress), ec);
+  if (!mdv) {
+    return false;
+  }
+  // II.24.2.1 metadata root
+  auto md = mdv->subview(0, bela::fromle(cr->MetaData.Size));
+  if (md.size() < sizeof(STORAGESIGNATURE) || md.cast_fromle<uint32_t>(0) != STORAGE_MAGIC_SIG) {
+    ec = bela::make_error_code(ErrGeneral, L"bad metadata signature");
+    return false;
+  }
+  auto versionLength = static_cast<size_t>(md.cast_fromle<uint32_t>(12));
+  auto pos = sizeof(STORAGESIGNATURE) + versionLength;
+  if (versionLength > md.size() || pos + sizeof(STORAGEHEADER) > md.size()) {
+    ec = bela::make_error_code(ErrGeneral, L"metadata version overflow");
+    return false;
+  }
+  version = md.make_cstring_view(sizeof(STORAGESIGNATURE), versionLength);
+  auto streams = md.cast_fromle<uint16_t>(pos + 2);
+  pos += sizeof(STORAGEHEADER);
+  bela::bytes_view ts;
+  for (uint16_t i = 0; i < streams; i++) {
+    if (pos + 8 > md.size()) {
+      ec = bela::make_error_code(ErrGeneral, L"metadata stream header ", i, L" overflow");
+      return false;
+    }
+    auto offset = static_cast<size_t>(md.cast_fromle<uint32_t>(pos));
+    auto size = static_cast<size_t>(md.cast_fromle<uint32_t>(pos + 4));
+    auto name = md.make_cstring_view(pos + 8, MAXSTREAMNAME);
+    pos += 8 + align4(name.size() + 1);
+    if (offset > md.size() || size > md.size() - offset) {
+      ec = bela::make_error_code(ErrGeneral, L"metadata stream ", i, L" overflow");
+      return false;
+    }
+    auto sv = md.subview(offset, size);
+    if (name == "#~" || name == "#-") {
+      ts = sv;
+    } else if (name == "#Strings") {
+      strings = sv;
+    } else if (name == "#Blob") {
+      blob = sv;
+    } else if (name == "#GUID") {
+      guid = sv;
+    }
+  }
+  return parseTables(ts, ec);
+}
+
+bool ClrMetadata::parseTables(bela::bytes_view ts, bela::error_code &ec) {
+  constexpr size_t headerSize = 24;
+  if (ts.size() < headerSize) {
+    ec = bela::make_error_code(ErrGeneral, L"metadata table stream not found");
+    return false;
+  }
+  auto heapSizes = ts[6];
+  auto valid = ts.cast_fromle<uint64_t>(8);
+  auto pos = headerSize;
+  uint32_t rows[64] = {0};
+  for (size_t i = 0; i < 64; i++) {
+    if ((valid >> i & 1) == 0) {
+      continue;
+    }
+    if (pos + 4 > ts.size()) {
+      ec = bela::make_error_code(ErrGeneral, L"metadata table rows overflow");
+      return false;
+    }
+    rows[i] = ts.cast_fromle<uint32_t>(pos);
+    pos += 4;
+  }
+  if ((heapSizes & heapExtraData) != 0) {
+    pos += 4;
+  }
+  auto columnSize = [&](uint8_t col) -> uint8_t {
+    switch (col) {
+    case colU8:
+      return 1;
+    case colU16:
+      return 2;
+    case colU32:
+      return 4;
+    case colString:
+      return (heapSizes & heapStringsWide) != 0 ? 4 : 2;
+    case colGuid:
+      return (heapSizes & heapGuidWide) != 0 ? 4 : 2;
+    case colBlob:
+      return (heapSizes & heapBlobWide) != 0 ? 4 : 2;
+    default:
+      break;
+    }
+    if (col < ClrTableCount) {
+      return rows[col] < 0x10000 ? 2 : 4;
+    }
+    // a coded index is 2 bytes when every referenced table has fewer than 2^(16 - tag bits) rows
+    const auto &ci = codedIndexes[col - colTypeDefOrRef];
+    uint32_t maxRows = 0;
+    for (size_t i = 0; i < ci.count; i++) {
+      if (ci.tables[i] != tableUnused) {
+        maxRows = (std::max)(maxRows, rows[ci.tables[i]]);
+      }
+    }
+    return maxRows < (1u << (16 - ci.bits)) ? 2 : 4;
+  };
+  for (size_t i = 0; i < ClrTableCount; i++) {
+    auto &t = tables[i];
+    const auto &schema = tableSchemas[i];
+    t = table{};
+    t.rows = rows[i];
+    t.columns = schema.count;
+    for (size_t c = 0; c < schema.count; c++) {
+      t.offsets[c] = static_cast<uint8_t>(t.rowSize);
+      t.sizes[c] = columnSize(schema.columns[c]);
+      t.rowSize += t.sizes[c];
+    }
+  }
+  // tables are stored in table number order, tables past GenericParamConstraint (portable PDB) are not needed
+  for (size_t i = 0; i < ClrTableCount; i++) {
+    auto &t = tables[i];
+    auto length = static_cast<uint64_t>(t.rows) * t.rowSize;
+    if (length > ts.size() - (std::min)(pos, ts.size())) {
+      ec = bela::make_error_code(ErrGeneral, L"metadata table ", i, L" overflow table stream");
+      return false;
+    }
+    t.data = ts.subview(pos, static_cast<size_t>(length));
+    pos += static_cast<size_t>(length);
+  }
+  return true;
+}
+
+std::optional<uint32_t> ClrMetadata::Column(ClrTable t, uint32_t row, size_t column) const {
+  const auto &tb = tables[static_cast<size_t>(t)];
+  if (row == 0 || row > tb.rows || column >= tb.columns) {
+    return std::nullopt;
+  }
+  auto offset = static_cast<size_t>(row - 1) * tb.rowSize + tb.offsets[column];
+  switch (tb.sizes[column]) {
+  case 1:
+    return std::make_optional<uint32_t>(tb.data[offset]);
+  case 2:
+    return std::make_optional<uint32_t>(tb.data.cast_fromle<uint16_t>(offset));
+  default:
+    break;
+  }
+  return std::make_optional(tb.data.cast_fromle<uint32_t>(offset));
+}
+
+bela::bytes_view ClrMetadata::Blob(uint32_t index) const {
+  if (index >= blob.size()) {
+    return bela::bytes_view();
+  }
+  // II.24.2.4 compressed length: 0xxxxxxx, 10xxxxxx x8, 110xxxxx x8 x8 x8
+  auto b0 = blob[index];
+  if ((b0 & 0x80) == 0) {
+    return blob.subview(index + 1, b0);
+  }
+  if ((b0 & 0xC0) == 0x80 && blob.size() - index >= 2) {
+    return blob.subview(index + 2, (static_cast<size_t>(b0 & 0x3F) << 8) | blob[index + 1]);
+  }
+  if ((b0 & 0xE0) == 0xC0 && blob.size() - index >= 4) {
+    auto length = (static_cast<size_t>(b0 & 0x1F) << 24) | (static_cast<size_t>(blob[index + 1]) << 16) |
+                  (static_cast<size_t>(blob[index + 2]) << 8) | blob[index + 3];
+    return blob.subview(index + 4, length);
+  }
+  return bela::bytes_view();
+}
+
+bela::bytes_view ClrMetadata::GUID(uint32_t index) const {
+  if (index == 0 || index > guid.size() / guidSize) {
+    return bela::bytes_view();
+  }
+  return guid.subview((index - 1) * guidSize, guidSize);
+}
+
+std::optional<ClrAssemblyName> ClrMetadata::Assembly() const {
+  constexpr auto t = ClrTable::Assembly;
+  if (Rows(t) == 0) {
+    return std::nullopt;
+  }
+  ClrAssemblyName an;
+  an.Major = static_cast<uint16_t>(*Column(t, 1, 1));
+  an.Minor = static_cast<uint16_t>(*Column(t, 1, 2));
+  an.Build = static_cast<uint16_t>(*Column(t, 1, 3));
+  an.Revision = static_cast<uint16_t>(*Column(t, 1, 4));
+  an.Flags = *Column(t, 1, 5);
+  an.PublicKeyOrToken = Blob(*Column(t, 1, 6));
+  an.Name = String(*Column(t, 1, 7));
+  an.Culture = String(*Column(t, 1, 8));
+  return std::make_optional(an);
+}
+
+std::optional<ClrAssemblyName> ClrMetadata::AssemblyRef(uint32_t row) const {
+  constexpr auto t = ClrTable::AssemblyRef;
+  if (row == 0 || row > Rows(t)) {
+    return std::nullopt;
+  }
+  ClrAssemblyName an;
+  an.Major = static_cast<uint16_t>(*Column(t, row, 0));
+  an.Minor = static_cast<uint16_t>(*Column(t, row, 1));
+  an.Build = static_cast<uint16_t>(*Column(t, row, 2));
+  an.Revision = static_cast<uint16_t>(*Column(t, row, 3));
+  an.Flags = *Column(t, row, 4);
+  an.PublicKeyOrToken = Blob(*Column(t, row, 5));
+  an.Name = String(*Column(t, row, 6));
+  an.Culture = String(*Column(t, row, 7));
+  return std::make_optional(an);
+}
+
 std::optional<DotNetMetadata> File::LookupDotNetMetadata(bela::error_code &ec) const {
   auto clrd = getDataDirectory(IMAGE_DIRECTORY_ENTRY_COMHEADER);
   if (clrd == nullptr) {
@@ -109,7 +462,7 @@ std::optional<DotNetMetadata> File::LookupDotNetMetadata(bela::error_code &ec) c
   if (!sdata) {
     return std::nullopt;
   }
-  auto bv = sdata->as_bytes_view();
+  auto bv = *sdata;
   auto N = clrd->VirtualAddress - sec->VirtualAddress;
   auto cr = bv.checked_cast<IMAGE_COR20_HEADER>(N);
   if (cr == nullptr) {
@@ -133,6 +486,16 @@ std::optional<DotNetMetadata> File::LookupDotNetMetadata(bela::error_code &ec) c
   DotNetMetadata dm;
   FlagsToText(cr, dm.flags);
   dm.version = bv.make_cstring_view(N + sizeof(STORAGESIGNATURE));
+  // referenced assemblies, metadata without a valid table stream keeps version and flags only
+  ClrMetadata md;
+  bela::error_code mec;
+  if (md.Open(*this, mec)) {
+    for (uint32_t i = 1; i <= md.Rows(ClrTable::AssemblyRef); i++) {
+      if (auto ar = md.AssemblyRef(i); ar) {
+        dm.imports.emplace_back(ar->Name);
+      }
+    }
+  }
   return std::make_optional(std::move(dm));
 }
 
@@ -3,27 +3,27 @@
 #include <algorithm>
 
 namespace bela::pe {
-bool File::LookupExports(std::vector<ExportedSymbol> &exports, bela::error_code &ec) const {
+const Section *File::readExportDirectory(IMAGE_EXPORT_DIRECTORY &ied, bela::bytes_view &bv,
+                                         bela::error_code &ec) const {
   auto exd = getDataDirectory(IMAGE_DIRECTORY_ENTRY_EXPORT);
   if (exd == nullptr) {
-    return true;
+    return nullptr;
   }
   auto ds = getSection(exd);
   if (ds == nullptr) {
-    return true;
+    return nullptr;
   }
   auto sdata = readSectionData(*ds, ec);
   if (!sdata) {
-    return false;
+    return nullptr;
   }
-  auto bv = sdata->as_bytes_view();
+  bv = *sdata;
   // seek to the virtual address specified in the export data directory
   auto N = exd->VirtualAddress - ds->VirtualAddress;
   auto cied = bv.checked_cast<IMAGE_EXPORT_DIRECTORY>(N);
   if (cied == nullptr) {
-    return true;
+    return nullptr;
   }
-  IMAGE_EXPORT_DIRECTORY ied;
   if constexpr (bela::IsLittleEndian()) {
     memcpy(&ied, cied, sizeof(IMAGE_EXPORT_DIRECTORY));
   } else {
@@ -40,8 +40,19 @@ bool File::LookupExports(std::vector<ExportedSymbol> &exports, bela::error_code
     ied.AddressOfNameOrdinals = bela::fromle(cied->AddressOfNameOrdinals); // RVA from base of image
   }
   if (ied.NumberOfFunctions == 0 || ied.AddressOfFunctions == 0) {
-    return true;
+    return nullptr;
+  }
+  return ds;
+}
+
+bool File::LookupExports(std::vector<ExportedSymbol> &exports, bela::error_code &ec) const {
+  IMAGE_EXPORT_DIRECTORY ied;
+  bela::bytes_view bv;
+  auto ds = readExportDirectory(ied, bv, ec);
+  if (ds == nullptr) {
+    return !ec;
   }
+  auto exd = getDataDirectory(IMAGE_DIRECTORY_ENTRY_EXPORT);
   const auto exportDataEnd = exd->VirtualAddress + exd->Size;
   exports.resize(ied.NumberOfFunctions);
   auto ordinalTable = bv.subview(ied.AddressOfNameOrdinals - ds->VirtualAddress);
@@ -59,7 +70,7 @@ bool File::LookupExports(std::vector<ExportedSymbol> &exports, bela::error_code
     auto nameRVA = nameTable.cast_fromle<uint32_t>(i * 4);
     auto name = bv.make_cstring_view(nameRVA - ds->VirtualAddress);
     auto ordinalIndex = ordinalTable.cast_fromle<uint16_t>(i * 2);
-    if (ordinalIndex < 0 || static_cast<DWORD>(ordinalIndex) >= ied.NumberOfFunctions) {
+    if (static_cast<DWORD>(ordinalIndex) >= ied.NumberOfFunctions) {
       continue;
     }
     exports[ordinalIndex].Name = name;
@@ -68,4 +79,49 @@ bool File::LookupExports(std::vector<ExportedSymbol> &exports, bela::error_code
   return true;
 }
 
-} // namespace bela::pe
\ No newline at end of file
+std::optional<ExportSymbolView> File::FindExport(std::string_view name, bela::error_code &ec) const {
+  IMAGE_EXPORT_DIRECTORY ied;
+  bela::bytes_view bv;
+  auto ds = readExportDirectory(ied, bv, ec);
+  if (ds == nullptr) {
+    return std::nullopt;
+  }
+  auto ordinalTable = bv.subview(ied.AddressOfNameOrdinals - ds->VirtualAddress);
+  auto nameTable = bv.subview(ied.AddressOfNames - ds->VirtualAddress);
+  auto addressTable = bv.subview(ied.AddressOfFunctions - ds->VirtualAddress);
+  auto names = (std::min)(static_cast<size_t>(ied.NumberOfNames), nameTable.size() / 4);
+  // the export name pointer table is sorted in ascending lexical order, compared as bytes
+  size_t lo = 0;
+  size_t hi = names;
+  while (lo < hi) {
+    auto mid = lo + (hi - lo) / 2;
+    auto nameRVA = nameTable.cast_fromle<uint32_t>(mid * 4);
+    auto current = bv.make_cstring_view(nameRVA - ds->VirtualAddress);
+    auto r = current.compare(name);
+    if (r < 0) {
+      lo = mid + 1;
+      continue;
+    }
+    if (r > 0) {
+      hi = mid;
+      continue;
+    }
+    auto ordinalIndex = ordinalTable.cast_fromle<uint16_t>(mid * 2);
+    if (static_cast<DWORD>(ordinalIndex) >= ied.NumberOfFunctions) {
+      ec = bela::make_error_code(ErrGeneral, L"export ordinal index ", ordinalIndex, L" out of range");
+      return std::nullopt;
+    }
+    ExportSymbolView es;
+    es.Address = addressTable.cast_fromle<uint32_t>(static_cast<size_t>(ordinalIndex) * 4);
+    es.Ordinal = static_cast<uint16_t>(ordinalIndex + ied.Base);
+    es.Hint = static_cast<int>(mid);
+    auto exd = getDataDirectory(IMAGE_DIRECTORY_ENTRY_EXPORT);
+    if (es.Address > exd->VirtualAddress && es.Address < exd->VirtualAddress + exd->Size) {
+      es.ForwardName = bv.make_cstring_view(es.Address - ds->VirtualAddress);
+    }
+    return std::make_optional(es);
+  }
+  return std::nullopt;
+}
+
+} // namespace bela::pe
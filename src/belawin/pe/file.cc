@@ -116,7 +116,7 @@ bool File::parseFile(bela::error_code &ec) {
     }
   }
   DosHeader dh;
-  if (!fd.ReadAt(dh, 0, ec)) {
+  if (!readAt(dh, 0, ec)) {
     return false;
   }
   memset(&oh, 0, sizeof(oh));
@@ -124,7 +124,7 @@ bool File::parseFile(bela::error_code &ec) {
   if (bela::fromle(dh.e_magic) == IMAGE_DOS_SIGNATURE) {
     auto signoff = static_cast<int64_t>(bela::fromle(dh.e_lfanew));
     uint8_t sign[4];
-    if (!fd.ReadAt(sign, signoff, ec)) {
+    if (!readAt(sign, signoff, ec)) {
       return false;
     }
     if (sign[0] != 'P' || sign[1] != 'E' || sign[2] != 0 || sign[3] != 0) {
@@ -135,34 +135,38 @@ bool File::parseFile(bela::error_code &ec) {
     base = signoff + 4;
   }
 
-  if (!fd.ReadAt(fh, base, ec)) {
+  if (!readAt(fh, base, ec)) {
     return false;
   }
   fromle(fh);
   oh.Is64Bit = (fh.SizeOfOptionalHeader == sizeof(IMAGE_OPTIONAL_HEADER64));
+  ohOffset = fh.SizeOfOptionalHeader != 0 ? base + static_cast<int64_t>(sizeof(FileHeader)) : 0;
   if (!readStringTable(ec)) {
     return false;
   }
 
   if (oh.Is64Bit) {
     IMAGE_OPTIONAL_HEADER64 oh64;
-    if (!fd.ReadAt(oh64, base + sizeof(FileHeader), ec)) {
+    if (!readAt(oh64, base + sizeof(FileHeader), ec)) {
       ec = bela::make_error_code(ErrGeneral, L"pe: not a valid pe file ", ec.message);
       return false;
     }
     fromle(&oh, &oh64);
   } else {
     IMAGE_OPTIONAL_HEADER32 oh32;
-    if (!fd.ReadAt(oh32, base + sizeof(FileHeader), ec)) {
+    if (!readAt(oh32, base + sizeof(FileHeader), ec)) {
       ec = bela::make_error_code(ErrGeneral, L"pe: not a valid pe file ", ec.message);
       return false;
     }
     fromle(&oh, &oh32);
   }
   sections.resize(fh.NumberOfSections);
+  sectionCache.resize(fh.NumberOfSections);
+  // section table immediately follows the optional header
+  auto shoff = base + static_cast<int64_t>(sizeof(FileHeader)) + fh.SizeOfOptionalHeader;
   for (int i = 0; std::cmp_less(i, fh.NumberOfSections); i++) {
     SectionHeader32 sh;
-    if (!fd.ReadFull(sh, ec)) {
+    if (!readAt(sh, shoff + static_cast<int64_t>(sizeof(SectionHeader32)) * i, ec)) {
       return false;
     }
     fromle(sh);
@@ -196,18 +200,58 @@ bool File::LookupFunctionTable(FunctionTable &ft, bela::error_code &ec) const {
   return LookupExports(ft.exports, ec);
 }
 
-bool File::NewFile(std::wstring_view p, bela::error_code &ec) {
+bool File::NewFile(std::wstring_view p, bela::error_code &ec, bool mapped) {
+  reset();
   auto fd_ = bela::io::NewFile(p, ec);
   if (!fd_) {
     return false;
   }
   fd = std::move(*fd_);
+  if (mapped) {
+    if (!mv.Map(fd.NativeFD(), bela::SizeUnInitialized, ec)) {
+      return false;
+    }
+    image = mv.as_bytes_view();
+    size = static_cast<int64_t>(image.size());
+  }
   return parseFile(ec);
 }
 
-bool File::NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec) {
+bool File::NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec, bool mapped) {
+  reset();
   fd.Assgin(fd_, false);
   size = sz;
+  if (mapped) {
+    if (!mv.Map(fd.NativeFD(), sz, ec)) {
+      return false;
+    }
+    image = mv.as_bytes_view();
+    size = static_cast<int64_t>(image.size());
+  }
+  return parseFile(ec);
+}
+
+bool File::NewFile(bela::bytes_view image_, bela::error_code &ec) {
+  reset();
+  fd = bela::io::FD();
+  // an empty view has no data pointer, readAt would fall back to the (invalid) fd
+  if (image_.size() == 0) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"pe: empty image");
+    return false;
+  }
+  image = image_;
+  size = static_cast<int64_t>(image.size());
+  return parseFile(ec);
+}
+
+bool File::NewFile(const bela::io::ReaderAt &reader_, bela::error_code &ec) {
+  reset();
+  fd = bela::io::FD();
+  reader = &reader_;
+  if (size = reader->Size(); size < 0) {
+    ec = bela::make_error_code(ErrGeneral, L"invalid reader size ", size);
+    return false;
+  }
   return parseFile(ec);
 }
 
@@ -0,0 +1,247 @@
+// import graph of a directory tree
+#include "internal.hpp"
+#include <bela/path.hpp>
+#include <bela/fs.hpp>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+namespace bela::pe {
+namespace {
+struct parsedImport {
+  std::string name; // lower case
+  std::vector<Function> functions;
+  bool delay{false};
+};
+
+struct parsedModule {
+  std::wstring path;
+  size_t dirLength{0}; // path is moved when modules grows, keep a length instead of a view
+  bela::pe::Machine machine{bela::pe::Machine::UNKNOWN};
+  std::vector<parsedImport> imports;
+  std::shared_ptr<const ExportTable> exports;
+  bela::error_code ec;
+};
+
+constexpr std::wstring_view peSuffixes[] = {L".exe", L".dll", L".sys", L".ocx", L".cpl", L".pyd", L".node"};
+
+bool isPEName(std::wstring_view name) {
+  return std::ranges::any_of(peSuffixes, [&](std::wstring_view s) { return bela::EndsWithIgnoreCase(name, s); });
+}
+
+// walkTree collect PE files, junctions and symlinked directories are not followed to avoid cycles
+void walkTree(std::wstring_view root, std::vector<std::wstring> &files) {
+  std::vector<std::wstring> dirs{std::wstring(root)};
+  while (!dirs.empty()) {
+    auto dir = std::move(dirs.back());
+    dirs.pop_back();
+    bela::error_code ec;
+    bela::fs::Finder finder;
+    if (!finder.First(dir, L"*", ec)) {
+      continue;
+    }
+    do {
+      if (finder.Ignore()) {
+        continue;
+      }
+      if (finder.IsDir()) {
+        if (!finder.IsReparsePoint()) {
+          dirs.emplace_back(bela::StringCat(dir, L"\\", finder.Name()));
+        }
+        continue;
+      }
+      if (isPEName(finder.Name())) {
+        files.emplace_back(bela::StringCat(dir, L"\\", finder.Name()));
+      }
+    } while (finder.Next());
+  }
+}
+
+std::string moduleName(std::wstring_view path) {
+  if (auto pos = path.find_last_of(L"\\/"); pos != std::wstring_view::npos) {
+    path.remove_prefix(pos + 1);
+  }
+  return bela::AsciiStrToLower(bela::encode_into<wchar_t, char>(path));
+}
+
+void parseModule(parsedModule &m, bool exportsOnly) {
+  File pf;
+  if (!pf.NewFile(m.path, m.ec, true)) {
+    return;
+  }
+  m.machine = pf.Machine();
+  if (exportsOnly) {
+    std::vector<ExportedSymbol> es;
+    if (pf.LookupExports(es, m.ec)) {
+      m.exports = std::make_shared<const ExportTable>(std::move(es));
+    }
+    return;
+  }
+  FunctionTable ft;
+  if (!pf.LookupFunctionTable(ft, m.ec)) {
+    return;
+  }
+  m.exports = std::make_shared<const ExportTable>(std::move(ft.exports));
+  m.imports.reserve(ft.imports.size() + ft.delayimprots.size());
+  for (auto &[name, functions] : ft.imports) {
+    m.imports.emplace_back(parsedImport{bela::AsciiStrToLower(name), std::move(functions), false});
+  }
+  for (auto &[name, functions] : ft.delayimprots) {
+    m.imports.emplace_back(parsedImport{bela::AsciiStrToLower(name), std::move(functions), true});
+  }
+  // hash map order is not stable
+  std::ranges::sort(m.imports, [](const parsedImport &a, const parsedImport &b) {
+    return a.delay != b.delay ? b.delay : a.name < b.name;
+  });
+}
+
+template <typename Fn> void parallelFor(size_t begin, size_t end, uint32_t concurrency, Fn fn) {
+  std::atomic_size_t next{begin};
+  auto worker = [&] {
+    for (auto i = next.fetch_add(1); i < end; i = next.fetch_add(1)) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < concurrency && i < end - begin; i++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &w : workers) {
+    w.join();
+  }
+}
+} // namespace
+
+ImportGraphBuilder::ImportGraphBuilder(uint32_t concurrency_) : concurrency(concurrency_) {
+  if (concurrency == 0) {
+    concurrency = (std::max)(std::thread::hardware_concurrency(), 1u);
+  }
+}
+
+bool ImportGraphBuilder::Build(std::wstring_view root, ImportGraph &graph, bela::error_code &ec) const {
+  std::wstring top(root);
+  while (!top.empty() && bela::IsPathSeparator(top.back())) {
+    top.pop_back();
+  }
+  std::vector<std::wstring> files;
+  walkTree(top, files);
+  if (files.empty()) {
+    ec = bela::make_error_code(ErrGeneral, L"no PE file found in '", root, L"'");
+    return false;
+  }
+  std::ranges::sort(files);
+  // Nodes[i] and modules[i] describe the same module, tree files first then modules found by name
+  std::vector<parsedModule> modules(files.size());
+  graph.Nodes.clear();
+  graph.Missing.clear();
+  graph.Nodes.resize(files.size());
+  bela::flat_hash_map<std::string, std::vector<uint32_t>> treeNames;
+  for (size_t i = 0; i < files.size(); i++) {
+    modules[i].path = std::move(files[i]);
+    auto &path = modules[i].path;
+    modules[i].dirLength = (std::min)(path.find_last_of(L'\\'), path.size());
+    graph.Nodes[i].Name = moduleName(path);
+    graph.Nodes[i].Path = path;
+    treeNames[graph.Nodes[i].Name].emplace_back(static_cast<uint32_t>(i));
+  }
+  auto treeCount = modules.size();
+  parallelFor(0, treeCount, concurrency, [&](size_t i) { parseModule(modules[i], false); });
+
+  // modules outside tree are interned by lower case name
+  bela::flat_hash_map<std::string, uint32_t> outside;
+  auto intern = [&](const std::string &name, bool apiSet) -> uint32_t {
+    if (auto it = outside.find(name); it != outside.end()) {
+      return it->second;
+    }
+    auto index = static_cast<uint32_t>(graph.Nodes.size());
+    auto &node = graph.Nodes.emplace_back();
+    node.Name = name;
+    node.ApiSet = apiSet;
+    auto &m = modules.emplace_back();
+    if (!apiSet) {
+      for (const auto &p : Paths) {
+        auto file = bela::StringCat(p, L"\\", bela::encode_into<char, wchar_t>(name));
+        if (bela::PathExists(file)) {
+          node.Path = file;
+          m.path = std::move(file);
+          break;
+        }
+      }
+    }
+    outside.emplace(name, index);
+    return index;
+  };
+  auto resolveName = [&](uint32_t importer, const std::string &name) -> uint32_t {
+    if (auto it = treeNames.find(name); it != treeNames.end()) {
+      // the loader searches the application directory first, prefer a module of the same machine otherwise
+      auto best = it->second.front();
+      for (auto i : it->second) {
+        if (bela::EqualsIgnoreCase(std::wstring_view(modules[i].path).substr(0, modules[i].dirLength),
+                                   std::wstring_view(modules[importer].path).substr(0, modules[importer].dirLength))) {
+          return i;
+        }
+        if (modules[best].machine != modules[importer].machine && modules[i].machine == modules[importer].machine) {
+          best = i;
+        }
+      }
+      return best;
+    }
+    return intern(name, false);
+  };
+  for (uint32_t i = 0; i < treeCount; i++) {
+    // intern grows graph.Nodes, resolve target before touching the edge list
+    for (const auto &imp : modules[i].imports) {
+      ImportEdge edge;
+      edge.Delay = imp.delay;
+      if (!ApiSetSchema::IsApiSetName(imp.name)) {
+        edge.Target = resolveName(i, imp.name);
+      } else if (auto host = ApiSet.Resolve(imp.name, graph.Nodes[i].Name); host && !host->empty()) {
+        edge.ApiSet = imp.name;
+        edge.Target = resolveName(i, *host);
+      } else {
+        edge.Target = intern(imp.name, true);
+      }
+      graph.Nodes[i].Imports.emplace_back(std::move(edge));
+    }
+  }
+  parallelFor(treeCount, modules.size(), concurrency, [&](size_t i) {
+    if (!modules[i].path.empty()) {
+      parseModule(modules[i], true);
+    }
+  });
+  // check imported symbols against target exports
+  parallelFor(0, treeCount, concurrency, [&](size_t i) {
+    auto &node = graph.Nodes[i];
+    for (size_t j = 0; j < node.Imports.size(); j++) {
+      auto &edge = node.Imports[j];
+      const auto &exports = modules[edge.Target].exports;
+      if (!exports) {
+        continue;
+      }
+      for (const auto &fn : modules[i].imports[j].functions) {
+        if (fn.Ordinal != 0) {
+          if (auto e = exports->LookupOrdinal(fn.Ordinal); e == nullptr || e->Address == 0) {
+            edge.Missing.emplace_back("#" + std::to_string(fn.Ordinal));
+          }
+          continue;
+        }
+        if (exports->LookupName(fn.Name) == nullptr) {
+          edge.Missing.emplace_back(fn.Name);
+        }
+      }
+    }
+  });
+  for (size_t i = 0; i < graph.Nodes.size(); i++) {
+    auto &node = graph.Nodes[i];
+    node.Machine = modules[i].machine;
+    node.Error = std::move(modules[i].ec);
+    if (node.Path.empty() && !node.ApiSet) {
+      graph.Missing.emplace_back(static_cast<uint32_t>(i));
+    }
+  }
+  std::ranges::sort(graph.Missing, [&](uint32_t a, uint32_t b) { return graph.Nodes[a].Name < graph.Nodes[b].Name; });
+  return true;
+}
+
+} // namespace bela::pe
@@ -16,7 +16,7 @@ bool File::LookupImports(FunctionTable::symbols_map_t &sm, bela::error_code &ec)
   if (!sdata) {
     return false;
   }
-  auto bv = sdata->as_bytes_view();
+  auto bv = *sdata;
   std::vector<image_import_descriptor> ida;
   for (size_t offset = idd->VirtualAddress - ds->VirtualAddress; offset < static_cast<size_t>(ds->Size);
        offset += sizeof(IMAGE_IMPORT_DESCRIPTOR)) {
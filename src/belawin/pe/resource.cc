@@ -47,44 +47,175 @@ struct image_resource_data_entry {
   uint32_t reserved;
 };
 
-// manifest
-constexpr std::string_view rsrcName = ".rsrc";
+constexpr uint16_t rtVersion = 16; // RT_VERSION is MAKEINTRESOURCE(16) in winuser.h
+constexpr uint32_t resourceDataIsDirectory = 0x80000000;
+constexpr uint32_t resourceNameIsString = 0x80000000;
+constexpr size_t resourceDirectorySize = 16;
+constexpr size_t resourceEntrySize = 8;
+constexpr size_t resourceDataEntrySize = 16;
 
-std::optional<Version> File::LookupVersion(bela::error_code &ec) const {
-  auto dd = getDataDirectory(IMAGE_DIRECTORY_ENTRY_RESOURCE);
-  if (dd == nullptr) {
-    return std::nullopt;
+bool ResourceNavigator::Open(const File &file_, bela::error_code &ec) {
+  const auto &oh = file_.Header();
+  if (oh.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_RESOURCE ||
+      oh.DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress == 0) {
+    ec = bela::make_error_code(ErrGeneral, L"resource directory not found");
+    return false;
+  }
+  auto rva = oh.DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE].VirtualAddress;
+  for (const auto &s : file_.Sections()) {
+    if (s.VirtualAddress > rva || rva - s.VirtualAddress >= s.Size) {
+      continue;
+    }
+    auto data = file_.SectionData(s, ec);
+    if (!data) {
+      return false;
+    }
+    file = &file_;
+    root = data->subview(rva - s.VirtualAddress);
+    rootRVA = rva;
+    return true;
+  }
+  ec = bela::make_error_code(ErrGeneral, L"resource section not found");
+  return false;
+}
+
+bool ResourceNavigator::lookupEntry(uint32_t offset, const ResourceID &key, uint32_t &next, uint16_t &id,
+                                    bela::error_code &ec) const {
+  if (offset > root.size() || root.size() - offset < resourceDirectorySize) {
+    ec = bela::make_error_code(ErrGeneral, L"bad resource directory at ", offset);
+    return false;
+  }
+  auto named = static_cast<size_t>(root.cast_fromle<uint16_t>(offset + 12));
+  auto total = named + root.cast_fromle<uint16_t>(offset + 14);
+  auto entries = root.subview(offset + resourceDirectorySize);
+  if (entries.size() / resourceEntrySize < total) {
+    ec = bela::make_error_code(ErrGeneral, L"resource directory at ", offset, L" overflow section");
+    return false;
   }
-  if (dd->VirtualAddress == 0) {
+  auto found = [&](size_t i) {
+    auto name = entries.cast_fromle<uint32_t>(i * resourceEntrySize);
+    id = (name & resourceNameIsString) == 0 ? static_cast<uint16_t>(name) : 0;
+    next = entries.cast_fromle<uint32_t>(i * resourceEntrySize + 4);
+    return true;
+  };
+  if (key.Any) {
+    return total != 0 && found(0);
+  }
+  if (!key.Name.empty()) {
+    // named entries are few and their order depends on the compiler's case folding, compare each one
+    for (size_t i = 0; i < named; i++) {
+      auto nameOffset = entries.cast_fromle<uint32_t>(i * resourceEntrySize) & ~resourceNameIsString;
+      if (nameOffset > root.size() || root.size() - nameOffset < 2) {
+        continue;
+      }
+      auto length = static_cast<size_t>(root.cast_fromle<uint16_t>(nameOffset));
+      auto chars = root.subview(nameOffset + 2, length * 2);
+      if (length != key.Name.size() || chars.size() != length * 2) {
+        continue;
+      }
+      auto equal = true;
+      for (size_t j = 0; j < length && equal; j++) {
+        equal = bela::ascii_tolower(static_cast<wchar_t>(chars.cast_fromle<uint16_t>(j * 2))) ==
+                bela::ascii_tolower(key.Name[j]);
+      }
+      if (equal) {
+        return found(i);
+      }
+    }
+    return false;
+  }
+  // id entries follow the named entries in ascending order
+  size_t lo = named;
+  size_t hi = total;
+  while (lo < hi) {
+    auto mid = lo + (hi - lo) / 2;
+    auto current = entries.cast_fromle<uint32_t>(mid * resourceEntrySize);
+    if (current == key.ID) {
+      return found(mid);
+    }
+    if (current < key.ID) {
+      lo = mid + 1;
+      continue;
+    }
+    hi = mid;
+  }
+  return false;
+}
+
+std::optional<Resource> ResourceNavigator::Find(const ResourceID &type, const ResourceID &name, const ResourceID &lang,
+                                                bela::error_code &ec) const {
+  if (file == nullptr) {
+    ec = bela::make_error_code(ErrGeneral, L"resource navigator not opened");
     return std::nullopt;
   }
-  auto sec = getSection(rsrcName);
-  if (sec == nullptr) {
+  // type -> name -> language -> IMAGE_RESOURCE_DATA_ENTRY
+  const ResourceID *keys[] = {&type, &name, &lang};
+  uint32_t offset = 0;
+  Resource r;
+  for (size_t level = 0; level < std::size(keys); level++) {
+    uint32_t next = 0;
+    if (!lookupEntry(offset, *keys[level], next, r.Language, ec)) {
+      return std::nullopt;
+    }
+    auto isDirectory = (next & resourceDataIsDirectory) != 0;
+    if (isDirectory != (level + 1 < std::size(keys))) {
+      ec = bela::make_error_code(ErrGeneral, L"unexpected resource tree depth ", level + 1);
+      return std::nullopt;
+    }
+    offset = next & ~resourceDataIsDirectory;
+  }
+  if (offset > root.size() || root.size() - offset < resourceDataEntrySize) {
+    ec = bela::make_error_code(ErrGeneral, L"bad resource data entry at ", offset);
     return std::nullopt;
   }
-  auto offset = static_cast<int64_t>(sec->Offset);
-  auto N = dd->VirtualAddress - sec->VirtualAddress;
-  auto offsetSize = sec->Size - N;
-  IMAGE_RESOURCE_DIRECTORY ird;
-  if (!fd.ReadAt(ird, offset, ec)) {
+  r.RVA = root.cast_fromle<uint32_t>(offset);
+  auto size = root.cast_fromle<uint32_t>(offset + 4);
+  r.CodePage = root.cast_fromle<uint32_t>(offset + 8);
+  // OffsetToData is an RVA, usually but not necessarily inside the resource section
+  if (r.RVA >= rootRVA && r.RVA - rootRVA < root.size()) {
+    r.Data = root.subview(r.RVA - rootRVA, size);
+  } else {
+    const Section *sec = nullptr;
+    for (const auto &s : file->Sections()) {
+      if (s.VirtualAddress <= r.RVA && r.RVA - s.VirtualAddress < s.Size) {
+        sec = &s;
+        break;
+      }
+    }
+    if (sec == nullptr) {
+      ec = bela::make_error_code(ErrGeneral, L"resource data rva ", r.RVA, L" not in any section");
+      return std::nullopt;
+    }
+    auto data = file->SectionData(*sec, ec);
+    if (!data) {
+      return std::nullopt;
+    }
+    r.Data = data->subview(r.RVA - sec->VirtualAddress, size);
+  }
+  if (r.Data.size() != size) {
+    ec = bela::make_error_code(ErrGeneral, L"resource data overflow section, size ", size);
     return std::nullopt;
   }
-  auto totalEntries = static_cast<int>(ird.NumberOfNamedEntries) + static_cast<int>(ird.NumberOfIdEntries);
-  if (totalEntries == 0) {
+  return std::make_optional(r);
+}
+
+std::optional<Version> File::LookupVersion(bela::error_code &ec) const {
+  ResourceNavigator rn;
+  if (!rn.Open(*this, ec)) {
     return std::nullopt;
   }
-  IMAGE_RESOURCE_DIRECTORY_ENTRY entry;
-  for (auto i = 0; i < totalEntries; i++) {
-    if (!fd.ReadFull(entry, ec)) {
-      return std::nullopt;
+  auto r = rn.Find(rtVersion, ResourceID{}, ec);
+  if (!r) {
+    if (!ec) {
+      ec = bela::make_error_code(ErrGeneral, L"resource type ", rtVersion, L" not found");
     }
-    // if (entry.NameIsString != 1) {
-    //   continue;
-    // }
-    // if (entry.Name != 0x00000010) {
-    // }
+    return std::nullopt;
+  }
+  Version vi;
+  if (!ParseVersionInfo(r->Data, vi, ec)) {
+    return std::nullopt;
   }
-  return std::nullopt;
+  return std::make_optional(std::move(vi));
 }
 
-} // namespace bela::pe
\ No newline at end of file
+} // namespace bela::pe
@@ -50,44 +50,237 @@ SymbolSearcher::SymbolSearcher(std::wstring_view exe, Machine machine) {
   }
 }
 
-std::optional<std::string> SymbolSearcher::LoadOrdinalFunctionName(std::string_view dllname, int ordinal,
-                                                                   bela::error_code &ec) {
+ExportTable::ExportTable(std::vector<ExportedSymbol> &&symbols_) : symbols(std::move(symbols_)) {
+  // LookupExports fills symbols[i].Ordinal = Base + i
+  if (!symbols.empty()) {
+    base = symbols.front().Ordinal;
+  }
+  names.reserve(symbols.size());
+  for (size_t i = 0; i < symbols.size(); i++) {
+    if (!symbols[i].Name.empty()) {
+      names.emplace(symbols[i].Name, static_cast<uint32_t>(i));
+    }
+  }
+}
+
+namespace {
+struct FileIdentity {
+  std::pair<uint64_t, uint64_t> key;
+  uint64_t lastWriteTime{0};
+  uint64_t size{0};
+};
+
+bool fileIdentity(HANDLE fd, FileIdentity &fi) {
+  BY_HANDLE_FILE_INFORMATION bi;
+  if (GetFileInformationByHandle(fd, &bi) != TRUE) {
+    return false;
+  }
+  fi.key = {bi.dwVolumeSerialNumber, (static_cast<uint64_t>(bi.nFileIndexHigh) << 32) | bi.nFileIndexLow};
+  fi.lastWriteTime =
+      (static_cast<uint64_t>(bi.ftLastWriteTime.dwHighDateTime) << 32) | bi.ftLastWriteTime.dwLowDateTime;
+  fi.size = (static_cast<uint64_t>(bi.nFileSizeHigh) << 32) | bi.nFileSizeLow;
+  return true;
+}
+} // namespace
+
+std::shared_ptr<const ExportTable> SymbolSearcher::loadExportTable(std::string_view dllname, bela::error_code &ec) {
   auto wdn = bela::encode_into<char, wchar_t>(dllname);
   for (auto &p : Paths) {
     auto file = bela::StringCat(p, L"\\", wdn);
-    if (bela::PathExists(file)) {
-      bela::pe::File fd;
-      if (!fd.NewFile(file, ec)) {
-        continue;
-      }
-      if (std::vector<bela::pe::ExportedSymbol> es; fd.LookupExports(es, ec)) {
-        auto it = table.emplace(dllname, std::move(es));
-        if (!it.second) {
-          return std::nullopt;
-        }
-        for (auto &e : it.first->second) {
-          if (std::cmp_equal(e.Ordinal, ordinal)) {
-            return std::make_optional(e.Name);
-          }
-        }
+    auto fd = bela::io::NewFile(file, ec);
+    if (!fd) {
+      // not in this path, a miss on every path is reported by LookupExportTable
+      ec.clear();
+      continue;
+    }
+    FileIdentity fi;
+    auto identified = fileIdentity(fd->NativeFD(), fi);
+    if (identified) {
+      if (auto it = persistent.find(fi.key);
+          it != persistent.end() && it->second.LastWriteTime == fi.lastWriteTime && it->second.Size == fi.size) {
+        return it->second.Exports;
       }
-      return std::nullopt;
     }
+    bela::pe::File pf;
+    if (!pf.NewFile(fd->NativeFD(), bela::SizeUnInitialized, ec)) {
+      ec.clear();
+      continue;
+    }
+    std::vector<bela::pe::ExportedSymbol> es;
+    if (!pf.LookupExports(es, ec)) {
+      return nullptr;
+    }
+    auto et = std::make_shared<const ExportTable>(std::move(es));
+    if (identified) {
+      persistent.insert_or_assign(fi.key, CachedExports{fi.lastWriteTime, fi.size, et});
+    }
+    return et;
   }
-  return std::nullopt;
+  return nullptr;
+}
+
+const ExportTable *SymbolSearcher::LookupExportTable(std::string_view dllname, bela::error_code &ec) {
+  auto key = bela::AsciiStrToLower(dllname);
+  if (auto it = table.find(key); it != table.end()) {
+    if (!it->second) {
+      ec = bela::make_error_code(ErrGeneral, L"'", bela::encode_into<char, wchar_t>(dllname), L"' not found");
+    }
+    return it->second.get();
+  }
+  auto et = loadExportTable(dllname, ec);
+  if (!et && !ec) {
+    ec = bela::make_error_code(ErrGeneral, L"'", bela::encode_into<char, wchar_t>(dllname), L"' not found");
+  }
+  return table.emplace(std::move(key), std::move(et)).first->second.get();
 }
 
 std::optional<std::string> SymbolSearcher::LookupOrdinalFunctionName(std::string_view dllname, int ordinal,
                                                                      bela::error_code &ec) {
-  if (auto it = table.find(dllname); it != table.end()) {
-    for (auto &s : it->second) {
-      if (std::cmp_equal(s.Ordinal, ordinal)) {
-        return std::make_optional(s.Name);
+  auto et = LookupExportTable(dllname, ec);
+  if (et == nullptr) {
+    return std::nullopt;
+  }
+  if (auto e = et->LookupOrdinal(ordinal); e != nullptr) {
+    return std::make_optional(e->Name);
+  }
+  return std::nullopt;
+}
+
+std::optional<int> SymbolSearcher::LookupFunctionOrdinal(std::string_view dllname, std::string_view name,
+                                                         bela::error_code &ec) {
+  auto et = LookupExportTable(dllname, ec);
+  if (et == nullptr) {
+    return std::nullopt;
+  }
+  if (auto e = et->LookupName(name); e != nullptr) {
+    return std::make_optional(static_cast<int>(e->Ordinal));
+  }
+  return std::nullopt;
+}
+
+// cache file layout, little endian:
+//   magic[8] version:u32 count:u32
+//   count * { volume:u64 index:u64 lastWriteTime:u64 size:u64 symbols:u32
+//             symbols * { address:u32 ordinal:u16 hint:i32 nameLen:u32 name fowardLen:u32 forward } }
+constexpr uint8_t exportCacheMagic[] = {'B', 'E', 'L', 'A', 'P', 'E', 'X', 'C'};
+constexpr uint32_t exportCacheVersion = 2;
+constexpr uint64_t exportCacheMaxSize = 1024ull * 1024 * 256;
+
+namespace {
+class cacheWriter {
+public:
+  void Bytes(const void *data, size_t len) { b.append(reinterpret_cast<const char *>(data), len); }
+  template <typename T> void Int(T v) {
+    v = bela::fromle(v); // byte swap is symmetric
+    Bytes(&v, sizeof(T));
+  }
+  void String(std::string_view s) {
+    Int(static_cast<uint32_t>(s.size()));
+    Bytes(s.data(), s.size());
+  }
+  std::string b;
+};
+
+class cacheReader {
+public:
+  cacheReader(std::string_view sv) : bv(sv.data(), sv.size()) {}
+  template <typename T> bool Int(T &v) {
+    if (bv.size() - pos < sizeof(T)) {
+      return false;
+    }
+    v = bv.cast_fromle<T>(pos);
+    pos += sizeof(T);
+    return true;
+  }
+  bool String(std::string &s) {
+    uint32_t n = 0;
+    if (!Int(n) || bv.size() - pos < n) {
+      return false;
+    }
+    s.assign(reinterpret_cast<const char *>(bv.data()) + pos, n);
+    pos += n;
+    return true;
+  }
+  bool Magic() {
+    if (bv.size() < sizeof(exportCacheMagic) || memcmp(bv.data(), exportCacheMagic, sizeof(exportCacheMagic)) != 0) {
+      return false;
+    }
+    pos = sizeof(exportCacheMagic);
+    return true;
+  }
+
+private:
+  bela::bytes_view bv;
+  size_t pos{0};
+};
+} // namespace
+
+bool SymbolSearcher::LoadCache(std::wstring_view file, bela::error_code &ec) {
+  if (!bela::PathExists(file)) {
+    return true;
+  }
+  std::string data;
+  if (!bela::io::ReadFile(file, data, ec, exportCacheMaxSize)) {
+    return false;
+  }
+  cacheReader r(data);
+  uint32_t version = 0;
+  uint32_t count = 0;
+  if (!r.Magic() || !r.Int(version) || version != exportCacheVersion || !r.Int(count)) {
+    // stale or foreign cache, rebuilt on SaveCache
+    return true;
+  }
+  PersistentTable entries;
+  for (uint32_t i = 0; i < count; i++) {
+    std::pair<uint64_t, uint64_t> key;
+    CachedExports ce;
+    uint32_t n = 0;
+    if (!r.Int(key.first) || !r.Int(key.second) || !r.Int(ce.LastWriteTime) || !r.Int(ce.Size) || !r.Int(n)) {
+      ec = bela::make_error_code(bela::ErrParseBroken, L"export cache '", file, L"' truncated");
+      return false;
+    }
+    std::vector<ExportedSymbol> es;
+    es.reserve((std::min)(n, 0x10000u));
+    for (uint32_t j = 0; j < n; j++) {
+      auto &e = es.emplace_back();
+      uint32_t address = 0;
+      if (!r.Int(address) || !r.Int(e.Ordinal) || !r.Int(e.Hint) || !r.String(e.Name) || !r.String(e.ForwardName)) {
+        ec = bela::make_error_code(bela::ErrParseBroken, L"export cache '", file, L"' truncated");
+        return false;
       }
+      e.Address = address;
+    }
+    ce.Exports = std::make_shared<const ExportTable>(std::move(es));
+    entries.insert_or_assign(key, std::move(ce));
+  }
+  // entries already parsed in this session are newer
+  for (auto &[k, v] : entries) {
+    persistent.try_emplace(k, std::move(v));
+  }
+  return true;
+}
+
+bool SymbolSearcher::SaveCache(std::wstring_view file, bela::error_code &ec) const {
+  cacheWriter w;
+  w.Bytes(exportCacheMagic, sizeof(exportCacheMagic));
+  w.Int(exportCacheVersion);
+  w.Int(static_cast<uint32_t>(persistent.size()));
+  for (const auto &[k, v] : persistent) {
+    w.Int(k.first);
+    w.Int(k.second);
+    w.Int(v.LastWriteTime);
+    w.Int(v.Size);
+    const auto &symbols = v.Exports->Symbols();
+    w.Int(static_cast<uint32_t>(symbols.size()));
+    for (const auto &e : symbols) {
+      w.Int(static_cast<uint32_t>(e.Address));
+      w.Int(static_cast<uint16_t>(e.Ordinal));
+      w.Int(static_cast<int32_t>(e.Hint));
+      w.String(e.Name);
+      w.String(e.ForwardName);
     }
-    return std::nullopt;
   }
-  return LoadOrdinalFunctionName(dllname, ordinal, ec);
+  return bela::io::AtomicWriteText(file, {reinterpret_cast<const uint8_t *>(w.b.data()), w.b.size()}, ec);
 }
 
-} // namespace bela::pe
\ No newline at end of file
+} // namespace bela::pe
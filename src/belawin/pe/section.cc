@@ -23,7 +23,7 @@ bool File::readRelocs(Section &sec) const {
   }
   bela::error_code ec;
   sec.Relocs.resize(sec.NumberOfRelocations);
-  if (!fd.ReadAt(sec.Relocs, sec.PointerToRelocations, ec)) {
+  if (!readAt(sec.Relocs, sec.PointerToRelocations, ec)) {
     return false;
   }
   if constexpr (bela::IsBigEndian()) {
@@ -35,20 +35,52 @@ bool File::readRelocs(Section &sec) const {
   }
   return true;
 }
-std::optional<Buffer> File::readSectionData(const Section &sec, bela::error_code &ec) const {
+
+bool File::readAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const {
+  if (image.data() != nullptr) {
+    if (pos < 0 || static_cast<uint64_t>(pos) > image.size() || buffer.size() > image.size() - static_cast<size_t>(pos)) {
+      ec = bela::make_error_code(ErrEOF, L"unexpected EOF");
+      return false;
+    }
+    memcpy(buffer.data(), image.data() + pos, buffer.size());
+    return true;
+  }
+  if (reader != nullptr) {
+    return reader->ReadAt(buffer, pos, ec);
+  }
+  return fd.ReadAt(buffer, pos, ec);
+}
+
+std::optional<bela::bytes_view> File::readSectionData(const Section &sec, bela::error_code &ec) const {
   if (sec.Size == 0) {
-    return std::make_optional<Buffer>();
+    return std::make_optional<bela::bytes_view>();
   }
-  if (bela::narrow_cast<int64_t>(sec.Offset + sec.Size) > size) {
+  if (static_cast<int64_t>(sec.Offset) + static_cast<int64_t>(sec.Size) > size) {
     ec = bela::make_error_code(bela::ErrFileTooSmall, L"corrupted PE file, section overflow file: ", size,
-                               L" section end: ", sec.Offset + sec.Size);
-    return false;
+                               L" section end: ", static_cast<int64_t>(sec.Offset) + static_cast<int64_t>(sec.Size));
+    return std::nullopt;
+  }
+  if (image.data() != nullptr) {
+    return std::make_optional(image.subview(sec.Offset, sec.Size));
+  }
+  if (std::less<>{}(&sec, sections.data()) || !std::less<>{}(&sec, sections.data() + sections.size())) {
+    ec = bela::make_error_code(ErrGeneral, L"section '", bela::encode_into<char, wchar_t>(sec.Name),
+                               L"' not belong to this file");
+    return std::nullopt;
+  }
+  auto index = static_cast<size_t>(&sec - sections.data());
+  std::scoped_lock lock(cacheMutex);
+  if (auto &b = sectionCache[index]; b.size() != 0) {
+    return std::make_optional(b.as_bytes_view());
   }
   Buffer buffer(sec.Size);
-  if (!fd.ReadAt(buffer, sec.Size, sec.Offset, ec)) {
+  if (auto p = buffer.make_span(sec.Size); readAt(p, sec.Offset, ec)) {
+    buffer.size() = p.size();
+  } else {
     ec = bela::make_error_code(ec.code, L"unable read section data: ", ec.message);
     return std::nullopt;
   }
-  return std::make_optional(std::move(buffer));
+  sectionCache[index] = std::move(buffer);
+  return std::make_optional(sectionCache[index].as_bytes_view());
 }
 } // namespace bela::pe
\ No newline at end of file
@@ -15,7 +15,7 @@ bool File::readStringTable(bela::error_code &ec) {
     return true;
   }
   uint32_t l = 0;
-  if (!fd.ReadAt(l, offset, ec)) {
+  if (!readAt(l, offset, ec)) {
     return false;
   }
   l = bela::fromle(l);
@@ -24,7 +24,9 @@ bool File::readStringTable(bela::error_code &ec) {
   }
   l -= 4;
   bela::Buffer b(l);
-  if (!fd.ReadFull(b, l, ec)) {
+  if (auto p = b.make_span(l); readAt(p, offset + 4, ec)) {
+    b.size() = p.size();
+  } else {
     ec = bela::make_error_code(ErrGeneral, L"fail to read string table: ", ec.message);
     return false;
   }
@@ -62,7 +62,7 @@ bool File::readCOFFSymbols(std::vector<COFFSymbol> &symbols, bela::error_code &e
     return true;
   }
   symbols.resize(fh.NumberOfSymbols);
-  if (!fd.ReadAt(symbols, fh.PointerToSymbolTable, ec)) {
+  if (!readAt(symbols, fh.PointerToSymbolTable, ec)) {
     return false;
   }
   if constexpr (bela::IsBigEndian()) {
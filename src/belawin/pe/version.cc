@@ -2,120 +2,169 @@
 #include <bela/pe.hpp>
 #include <bela/buffer.hpp>
 
+// https://learn.microsoft.com/en-us/windows/win32/menurc/vs-versioninfo
 // https://github.com/chromium/chromium/blob/master/base/file_version_info_win.cc
 
 namespace bela::pe {
+namespace {
+constexpr uint32_t fixedFileInfoSignature = 0xFEEF04BD;
+constexpr uint16_t latinCodePage = 1252;
 
-struct LanguageAndCodePage {
-  WORD language;
-  WORD codePage;
+// versionNode VS_VERSIONINFO, StringFileInfo, StringTable, String, VarFileInfo and Var share one layout:
+// wLength wValueLength wType szKey padding Value padding Children
+struct versionNode {
+  std::wstring key;
+  bela::bytes_view value;
+  bela::bytes_view children;
+  uint16_t type{0}; // 1: text value, wValueLength counts WCHARs
 };
 
-// Returns the \VarFileInfo\Translation value extracted from the
-// VS_VERSION_INFO resource in |data|.
-LanguageAndCodePage *GetTranslate(const void *data) {
-  static constexpr wchar_t kTranslation[] = L"\\VarFileInfo\\Translation";
-  LPVOID translate = nullptr;
-  UINT dummy_size;
-  if (::VerQueryValue(data, kTranslation, &translate, &dummy_size) != 0) {
-    return static_cast<LanguageAndCodePage *>(translate);
-  }
-  return nullptr;
-}
+size_t align4(size_t n) { return (n + 3) & ~static_cast<size_t>(3); }
 
-const VS_FIXEDFILEINFO *GetVsFixedFileInfo(const void *data) {
-  static constexpr wchar_t kRoot[] = L"\\";
-  LPVOID fixed_file_info = nullptr;
-  UINT dummy_size;
-  if (::VerQueryValue(data, kRoot, &fixed_file_info, &dummy_size) != 0) {
-    //
-    return nullptr;
+// decodeText UTF-16LE to wstring, stops at first null character
+void decodeText(bela::bytes_view bv, std::wstring &s) {
+  s.clear();
+  for (size_t i = 0; i + 1 < bv.size(); i += 2) {
+    auto ch = bv.cast_fromle<uint16_t>(i);
+    if (ch == 0) {
+      break;
+    }
+    s.push_back(static_cast<wchar_t>(ch));
   }
-  return static_cast<VS_FIXEDFILEINFO *>(fixed_file_info);
 }
 
-struct VersionLoader {
-  bela::Buffer buffer;
-  WORD language;
-  WORD codePage;
-  LANGID defaultLangage;
-  bool initialize(std::wstring_view file, bela::error_code &ec);
-  bool getValue(const wchar_t *name, std::wstring &value) const;
-};
-
-bool VersionLoader::initialize(std::wstring_view file, bela::error_code &ec) {
-  DWORD dwhandle{0};
-  auto N = GetFileVersionInfoSizeW(file.data(), &dwhandle);
-  if (N == 0) {
-    ec = bela::make_system_error_code(L"GetFileVersionInfoSizeW ");
+// parseNode parse node at bv start, consumed is aligned length including children
+bool parseNode(bela::bytes_view bv, versionNode &node, size_t &consumed) {
+  if (bv.size() < 6) {
     return false;
   }
-  buffer.grow(N);
-  if (GetFileVersionInfoW(file.data(), 0, N, buffer.data()) != TRUE) {
-    ec = bela::make_system_error_code(L"GetFileVersionInfoW");
+  auto length = static_cast<size_t>(bv.cast_fromle<uint16_t>(0));
+  auto valueLength = static_cast<size_t>(bv.cast_fromle<uint16_t>(2));
+  node.type = bv.cast_fromle<uint16_t>(4);
+  if (length < 6 || length > bv.size()) {
     return false;
   }
-  buffer.size() = static_cast<size_t>(N);
-  auto translate = GetTranslate(buffer.data());
-  if (translate == nullptr) {
-    ec = bela::make_error_code(L"no found translate");
-    return false;
+  bv = bv.subview(0, length);
+  auto pos = size_t{6};
+  for (; pos + 1 < bv.size() && bv.cast_fromle<uint16_t>(pos) != 0; pos += 2) {
+  }
+  decodeText(bv.subview(6, pos - 6), node.key);
+  pos = align4(pos + 2);
+  if (node.type == 1) {
+    valueLength *= 2;
   }
-  language = translate->language;
-  codePage = translate->codePage;
-  defaultLangage = GetUserDefaultLangID();
+  // some resource compilers store text value length in bytes, never trust it past the node end
+  node.value = bv.subview(pos, valueLength);
+  node.children = bv.subview(align4(pos + node.value.size()));
+  consumed = align4(length);
   return true;
 }
 
-std::wstring_view cleanupString(void *valuePtr, size_t n) {
-  std::wstring_view sv{reinterpret_cast<const wchar_t *>(valuePtr), n};
-  if (auto pos = sv.find(L'\0'); pos != std::wstring_view::npos) {
-    return sv.substr(0, pos);
+// walkChildren call fn on each child node, stops on malformed child
+template <typename Fn> void walkChildren(bela::bytes_view children, Fn fn) {
+  while (children.size() != 0) {
+    versionNode node;
+    size_t consumed = 0;
+    if (!parseNode(children, node, consumed)) {
+      return;
+    }
+    fn(node);
+    children.remove_prefix(consumed);
   }
-  return sv;
 }
+} // namespace
 
-bool VersionLoader::getValue(const wchar_t *name, std::wstring &value) const {
-  const struct LanguageAndCodePage langCodepages[] = {
-      // Use the language and codepage from the DLL.
-      {.language = language, .codePage = codePage},
-      // Use the default language and codepage from the DLL.
-      {.language = defaultLangage, .codePage = codePage},
-      // Use the language from the DLL and Latin codepage (most common).
-      {.language = language, .codePage = 1252},
-      // Use the default language and Latin codepage (most common).
-      {.language = defaultLangage, .codePage = 1252},
+bool ParseVersionInfo(bela::bytes_view data, Version &vi, bela::error_code &ec) {
+  versionNode root;
+  size_t consumed = 0;
+  if (!parseNode(data, root, consumed) || root.key != L"VS_VERSION_INFO") {
+    ec = bela::make_error_code(ErrGeneral, L"invalid VS_VERSIONINFO resource");
+    return false;
+  }
+  if (root.value.size() >= sizeof(FileInfo) && root.value.cast_fromle<uint32_t>(0) == fixedFileInfoSignature) {
+    auto fields = reinterpret_cast<DWORD *>(&vi.Fixed);
+    for (size_t i = 0; i < sizeof(FileInfo) / sizeof(DWORD); i++) {
+      fields[i] = root.value.cast_fromle<uint32_t>(i * 4);
+    }
+  }
+  std::vector<versionNode> tables;
+  uint16_t language = 0;
+  uint16_t codePage = 0;
+  auto hasTranslation = false;
+  walkChildren(root.children, [&](const versionNode &node) {
+    if (node.key == L"StringFileInfo") {
+      walkChildren(node.children, [&](const versionNode &table) { tables.emplace_back(table); });
+      return;
+    }
+    if (node.key == L"VarFileInfo") {
+      walkChildren(node.children, [&](const versionNode &var) {
+        if (!hasTranslation && var.key == L"Translation" && var.value.size() >= 4) {
+          language = var.value.cast_fromle<uint16_t>(0);
+          codePage = var.value.cast_fromle<uint16_t>(2);
+          hasTranslation = true;
+        }
+      });
+    }
+  });
+  if (tables.empty()) {
+    ec = bela::make_error_code(ErrGeneral, L"no found StringFileInfo");
+    return false;
+  }
+  // StringTable key is language and code page as 8 hex digits
+  auto tableOf = [&](uint16_t lang, uint16_t cp) -> const versionNode * {
+    auto key = bela::StringCat(bela::Hex(lang, bela::kZeroPad4), bela::Hex(cp, bela::kZeroPad4));
+    for (const auto &t : tables) {
+      if (bela::EqualsIgnoreCase(t.key, key)) {
+        return &t;
+      }
+    }
+    return nullptr;
   };
-  for (const auto &lc : langCodepages) {
-    auto block = bela::StringCat(L"\\StringFileInfo\\", bela::Hex(lc.language, bela::kZeroPad4),
-                                 bela::Hex(lc.codePage, bela::kZeroPad4), L"\\", name);
-    LPVOID valuePtr = nullptr;
-    uint32_t size;
-    if (VerQueryValueW(buffer.data(), block.data(), (&valuePtr), &size) == TRUE && valuePtr != nullptr && size > 0) {
-      value.assign(cleanupString(valuePtr, size - 1));
+  // the language and code page from the Translation, then Latin code page, then the first table
+  const versionNode *table = nullptr;
+  if (hasTranslation) {
+    if (table = tableOf(language, codePage); table == nullptr) {
+      table = tableOf(language, latinCodePage);
     }
   }
-  return false;
+  if (table == nullptr) {
+    table = &tables.front();
+  }
+  struct {
+    std::wstring_view name;
+    std::wstring *value;
+  } fields[] = {
+      {L"CompanyName", &vi.CompanyName},
+      {L"FileDescription", &vi.FileDescription},
+      {L"FileVersion", &vi.FileVersion},
+      {L"InternalName", &vi.InternalName},
+      {L"LegalCopyright", &vi.LegalCopyright},
+      {L"OriginalFilename", &vi.OriginalFileName},
+      {L"ProductName", &vi.ProductName},
+      {L"ProductVersion", &vi.ProductVersion},
+      {L"Comments", &vi.Comments},
+      {L"LegalTrademarks", &vi.LegalTrademarks},
+      {L"PrivateBuild", &vi.PrivateBuild},
+      {L"SpecialBuild", &vi.SpecialBuild},
+  };
+  walkChildren(table->children, [&](const versionNode &s) {
+    for (auto &f : fields) {
+      if (bela::EqualsIgnoreCase(s.key, f.name)) {
+        decodeText(s.value, *f.value);
+        return;
+      }
+    }
+  });
+  return true;
 }
 
 std::optional<Version> Lookup(std::wstring_view file, bela::error_code &ec) {
-  VersionLoader vl;
-  if (!vl.initialize(file, ec)) {
+  File pe;
+  // mapped: the navigator views .rsrc in place and only the pages of the directory path and VS_VERSIONINFO are read,
+  // a file handle would read and cache the whole section (icons included)
+  if (!pe.NewFile(file, ec, true)) {
     return std::nullopt;
   }
-  Version vi;
-  vl.getValue(L"CompanyName", vi.CompanyName);
-  vl.getValue(L"FileDescription", vi.FileDescription);
-  vl.getValue(L"FileVersion", vi.FileVersion);
-  vl.getValue(L"InternalName", vi.InternalName);
-  vl.getValue(L"LegalCopyright", vi.LegalCopyright);
-  vl.getValue(L"OriginalFileName", vi.OriginalFileName);
-  vl.getValue(L"ProductName", vi.ProductName);
-  vl.getValue(L"ProductVersion", vi.ProductVersion);
-  vl.getValue(L"Comments", vi.Comments);
-  vl.getValue(L"LegalTrademarks", vi.LegalTrademarks);
-  vl.getValue(L"PrivateBuild", vi.PrivateBuild);
-  vl.getValue(L"SpecialBuild", vi.SpecialBuild);
-  return std::make_optional(std::move(vi));
+  return pe.LookupVersion(ec);
 }
-} // namespace bela::pe
\ No newline at end of file
+} // namespace bela::pe
@@ -0,0 +1,300 @@
+///
+#include <hazel/ar.hpp>
+#include <charconv>
+
+namespace hazel::ar {
+constexpr std::string_view arMagic = "!<arch>\n";
+constexpr std::string_view thinMagic = "!<thin>\n";
+constexpr size_t headerSize = 60;
+constexpr std::string_view bsdLongNamePrefix = "#1/";
+
+// header fields are space padded ASCII: name[16] date[12] uid[6] gid[6] mode[8] size[10] fmag[2]
+struct rawHeader {
+  std::string_view name;
+  int64_t time{0};
+  uint32_t mode{0};
+  int64_t size{0};
+};
+
+inline std::string_view trimField(bela::bytes_view bv, size_t pos, size_t len) {
+  auto sv = bv.subview(pos, len).make_string_view();
+  while (!sv.empty() && sv.back() == ' ') {
+    sv.remove_suffix(1);
+  }
+  return sv;
+}
+
+template <typename I> bool parseField(std::string_view sv, I &v, int base = 10) {
+  if (sv.empty()) {
+    v = 0;
+    return true;
+  }
+  auto res = std::from_chars(sv.data(), sv.data() + sv.size(), v, base);
+  return res.ec == std::errc{} && res.ptr == sv.data() + sv.size();
+}
+
+bool readHeader(bela::bytes_view image, int64_t offset, rawHeader &h, bela::error_code &ec) {
+  if (offset < 0 || static_cast<uint64_t>(offset) + headerSize > image.size()) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"ar: member header at ", offset, L" overflow archive");
+    return false;
+  }
+  auto hv = image.subview(static_cast<size_t>(offset), headerSize);
+  if (hv[58] != '`' || hv[59] != '\n') {
+    ec = bela::make_error_code(ErrGeneral, L"ar: bad member header magic at ", offset);
+    return false;
+  }
+  h.name = trimField(hv, 0, 16);
+  if (!parseField(trimField(hv, 16, 12), h.time) || !parseField(trimField(hv, 40, 8), h.mode, 8) ||
+      !parseField(trimField(hv, 48, 10), h.size) || h.size < 0) {
+    ec = bela::make_error_code(ErrGeneral, L"ar: bad member header fields at ", offset);
+    return false;
+  }
+  if (static_cast<uint64_t>(h.size) > image.size() - offset - headerSize) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"ar: member at ", offset, L" overflow archive");
+    return false;
+  }
+  return true;
+}
+
+// members are aligned to 2 bytes
+inline int64_t nextHeader(int64_t offset, int64_t size) {
+  auto end = offset + static_cast<int64_t>(headerSize) + size;
+  return end + (end & 1);
+}
+
+inline bool isSymbolTableName(std::string_view name) {
+  return name == "/" || name == "/SYM64/" || name.starts_with("__.SYMDEF");
+}
+
+bool Archive::NewArchive(std::wstring_view p, bela::error_code &ec) {
+  if (!mv.Map(p, ec)) {
+    return false;
+  }
+  image = mv.as_bytes_view();
+  return parseArchive(ec);
+}
+
+bool Archive::NewArchive(bela::bytes_view image_, bela::error_code &ec) {
+  image = image_;
+  return parseArchive(ec);
+}
+
+bool Archive::parseArchive(bela::error_code &ec) {
+  auto magic = image.subview(0, arMagic.size()).make_string_view();
+  if (magic == thinMagic) {
+    ec = bela::make_error_code(bela::ErrUnimplemented, L"ar: thin archive not supported");
+    return false;
+  }
+  if (magic != arMagic) {
+    ec = bela::make_error_code(ErrGeneral, L"ar: bad archive magic");
+    return false;
+  }
+  // symbol tables and the long name table precede regular members
+  int64_t offset = arMagic.size();
+  while (static_cast<uint64_t>(offset) < image.size()) {
+    rawHeader h;
+    if (!readHeader(image, offset, h, ec)) {
+      return false;
+    }
+    auto data = image.subview(static_cast<size_t>(offset) + headerSize, static_cast<size_t>(h.size));
+    auto name = h.name;
+    if (name.starts_with(bsdLongNamePrefix)) {
+      // BSD: the name is stored at the start of member data
+      size_t length = 0;
+      if (!parseField(name.substr(bsdLongNamePrefix.size()), length) || length > data.size()) {
+        ec = bela::make_error_code(ErrGeneral, L"ar: bad BSD member name at ", offset);
+        return false;
+      }
+      name = data.make_cstring_view(0, length);
+      data = data.subview(length);
+    }
+    if (name == "//") {
+      longNames = data;
+    } else if (name.starts_with("/<") && name.ends_with(">/")) {
+      // COFF /<ECSYMBOLS>/ and /<XFGHASHMAP>/
+    } else if (isSymbolTableName(name)) {
+      if (!parseSymbolTable(name, data, ec)) {
+        return false;
+      }
+    } else {
+      break;
+    }
+    offset = nextHeader(offset, h.size);
+  }
+  firstMember = offset;
+  return true;
+}
+
+bool Archive::parseSymbolTable(std::string_view name, bela::bytes_view data, bela::error_code &ec) {
+  auto bad = [&]() {
+    ec = bela::make_error_code(ErrGeneral, L"ar: bad symbol table '", bela::encode_into<char, wchar_t>(name), L"'");
+    return false;
+  };
+  // addNames names are consecutive null terminated strings
+  auto addNames = [&](bela::bytes_view names, size_t count, auto offsetOf) {
+    size_t pos = 0;
+    for (size_t i = 0; i < count && pos < names.size(); i++) {
+      auto sym = names.make_cstring_view(pos);
+      pos += sym.size() + 1;
+      if (auto offset = offsetOf(i); offset >= 0) {
+        symbols.try_emplace(sym, offset);
+      }
+    }
+  };
+  if (name == "/" && format == SymbolFormat::GNU) {
+    // COFF second linker member: members offsets then 1-based member indexes of sorted symbols, all little endian
+    if (data.size() < 8) {
+      return bad();
+    }
+    auto members = static_cast<size_t>(data.cast_fromle<uint32_t>(0));
+    if (members > (data.size() - 8) / 4) {
+      return bad();
+    }
+    auto indexes = 8 + members * 4;
+    auto count = static_cast<size_t>(data.cast_fromle<uint32_t>(indexes - 4));
+    if (count > (data.size() - indexes) / 2) {
+      return bad();
+    }
+    symbols.clear();
+    format = SymbolFormat::COFF;
+    addNames(data.subview(indexes + count * 2), count, [&](size_t i) -> int64_t {
+      auto index = static_cast<size_t>(data.cast_fromle<uint16_t>(indexes + i * 2));
+      return index == 0 || index > members ? -1 : data.cast_fromle<uint32_t>(4 + (index - 1) * 4);
+    });
+    return true;
+  }
+  if (name == "/") {
+    // big endian count, count member offsets, names
+    if (data.size() < 4) {
+      return bad();
+    }
+    auto count = static_cast<size_t>(data.cast_frombe<uint32_t>(0));
+    if (count > (data.size() - 4) / 4) {
+      return bad();
+    }
+    format = SymbolFormat::GNU;
+    addNames(data.subview(4 + count * 4), count,
+             [&](size_t i) -> int64_t { return data.cast_frombe<uint32_t>(4 + i * 4); });
+    return true;
+  }
+  if (name == "/SYM64/") {
+    if (data.size() < 8) {
+      return bad();
+    }
+    auto count = data.cast_frombe<uint64_t>(0);
+    if (count > (data.size() - 8) / 8) {
+      return bad();
+    }
+    format = SymbolFormat::GNU64;
+    addNames(data.subview(8 + static_cast<size_t>(count) * 8), static_cast<size_t>(count),
+             [&](size_t i) -> int64_t { return static_cast<int64_t>(data.cast_frombe<uint64_t>(8 + i * 8)); });
+    return true;
+  }
+  // BSD ranlib: byte size of ranlib array, ranlib {strx, offset}, byte size of string table, string table. written in
+  // the producer's byte order, little endian on every platform Apple and FreeBSD ship today
+  auto is64 = name.starts_with("__.SYMDEF_64");
+  auto word = static_cast<size_t>(is64 ? 8 : 4);
+  auto readWord = [&](size_t pos) -> uint64_t {
+    return is64 ? data.cast_fromle<uint64_t>(pos) : data.cast_fromle<uint32_t>(pos);
+  };
+  if (data.size() < word) {
+    return bad();
+  }
+  auto ranlibSize = readWord(0);
+  if (ranlibSize > data.size() - word || data.size() - word - ranlibSize < word) {
+    return bad();
+  }
+  auto strtabOffset = word + static_cast<size_t>(ranlibSize) + word;
+  auto strtab = data.subview(strtabOffset, static_cast<size_t>(readWord(strtabOffset - word)));
+  format = is64 ? SymbolFormat::BSD64 : SymbolFormat::BSD;
+  for (size_t pos = word; pos + word * 2 <= word + ranlibSize; pos += word * 2) {
+    auto strx = readWord(pos);
+    if (strx >= strtab.size()) {
+      continue;
+    }
+    symbols.try_emplace(strtab.make_cstring_view(static_cast<size_t>(strx)), static_cast<int64_t>(readWord(pos + word)));
+  }
+  return true;
+}
+
+std::optional<Member> Archive::ReadMember(int64_t headerOffset, bela::error_code &ec) const {
+  rawHeader h;
+  if (!readHeader(image, headerOffset, h, ec)) {
+    return std::nullopt;
+  }
+  Member m;
+  m.HeaderOffset = headerOffset;
+  m.Offset = headerOffset + static_cast<int64_t>(headerSize);
+  m.Size = h.size;
+  m.Time = h.time;
+  m.Mode = h.mode;
+  auto name = h.name;
+  if (name.starts_with(bsdLongNamePrefix)) {
+    size_t length = 0;
+    if (!parseField(name.substr(bsdLongNamePrefix.size()), length) || static_cast<int64_t>(length) > m.Size) {
+      ec = bela::make_error_code(ErrGeneral, L"ar: bad BSD member name at ", headerOffset);
+      return std::nullopt;
+    }
+    m.Name = image.make_cstring_view(static_cast<size_t>(m.Offset), length);
+    m.Offset += static_cast<int64_t>(length);
+    m.Size -= static_cast<int64_t>(length);
+    return std::make_optional(std::move(m));
+  }
+  if (name.size() > 1 && name[0] == '/' && name[1] >= '0' && name[1] <= '9') {
+    // GNU and COFF long name: offset into '//', terminated by "/\n" (GNU) or '\0' (COFF)
+    size_t pos = 0;
+    if (!parseField(name.substr(1), pos) || pos >= longNames.size()) {
+      ec = bela::make_error_code(ErrGeneral, L"ar: bad long name reference at ", headerOffset);
+      return std::nullopt;
+    }
+    auto sv = longNames.subview(pos).make_string_view();
+    sv = sv.substr(0, sv.find_first_of(std::string_view("\0\n", 2)));
+    if (sv.ends_with('/')) {
+      sv.remove_suffix(1);
+    }
+    m.Name = sv;
+    return std::make_optional(std::move(m));
+  }
+  // GNU and COFF short names end with '/', special members ('/', '//', '/SYM64/') are kept as is
+  if (!name.starts_with('/') && name.ends_with('/')) {
+    name.remove_suffix(1);
+  }
+  m.Name = name;
+  return std::make_optional(std::move(m));
+}
+
+std::optional<Member> Archive::LookupSymbol(std::string_view symbol, bela::error_code &ec) const {
+  auto it = symbols.find(symbol);
+  if (it == symbols.end()) {
+    return std::nullopt;
+  }
+  return ReadMember(it->second, ec);
+}
+
+bool Archive::Members(std::vector<Member> &members, bela::error_code &ec) const {
+  for (auto offset = firstMember; static_cast<uint64_t>(offset) < image.size();) {
+    auto m = ReadMember(offset, ec);
+    if (!m) {
+      return false;
+    }
+    offset = nextHeader(offset, m->Offset - offset - static_cast<int64_t>(headerSize) + m->Size);
+    if (m->Name.starts_with('/') || isSymbolTableName(m->Name)) {
+      continue;
+    }
+    members.emplace_back(std::move(*m));
+  }
+  return true;
+}
+
+bool Archive::OpenPE(const Member &m, bela::pe::File &file, bela::error_code &ec) const {
+  auto data = MemberData(m);
+  // IMPORT_OBJECT_HEADER: Sig1 IMAGE_FILE_MACHINE_UNKNOWN, Sig2 0xFFFF
+  if (data.size() >= 4 && data.cast_fromle<uint16_t>(0) == 0 && data.cast_fromle<uint16_t>(2) == 0xFFFF) {
+    ec = bela::make_error_code(ErrGeneral, L"ar: member '", bela::encode_into<char, wchar_t>(m.Name),
+                               L"' is a short import object");
+    return false;
+  }
+  return file.NewFile(data, ec);
+}
+
+} // namespace hazel::ar
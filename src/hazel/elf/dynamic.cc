@@ -12,16 +12,16 @@ bool File::DynString(int tag, std::vector<std::string> &sv, bela::error_code &ec
   if (ds == nullptr) {
     return true;
   }
-  bela::Buffer d;
-  if (!sectionData(*ds, d, ec)) {
+  SectionBytes d;
+  if (!cachedSection(*ds, d, ec)) {
     return false;
   }
-  bela::Buffer str;
+  SectionBytes str;
   if (!stringTable(ds->Link, str, ec)) {
     return false;
   }
-  auto bsv = str.as_bytes_view();
-  auto dv = d.as_bytes_view();
+  auto bsv = str->as_bytes_view();
+  auto dv = d->as_bytes_view();
   if (fh.Class == ELFCLASS32) {
     while (dv.size() >= 8) {
       auto t = cast_from<uint32_t>(dv.data());
@@ -9,16 +9,43 @@ bool File::NewFile(std::wstring_view p, bela::error_code &ec) {
   if (!fd_) {
     return false;
   }
+  reset();
   fd = std::move(*fd_);
   return parseFile(ec);
 }
 
 bool File::NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec) {
+  reset();
   fd.Assgin(fd_, false);
   size = sz;
   return parseFile(ec);
 }
 
+bool File::NewFile(bela::bytes_view image_, bela::error_code &ec) {
+  reset();
+  fd = bela::io::FD();
+  // an empty view has no data pointer, readAt would fall back to the (invalid) fd
+  if (image_.size() == 0) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"elf: empty image");
+    return false;
+  }
+  image = image_;
+  size = static_cast<int64_t>(image.size());
+  return parseFile(ec);
+}
+
+bool File::readAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const {
+  if (image.data() != nullptr) {
+    if (pos < 0 || static_cast<uint64_t>(pos) > image.size() || buffer.size() > image.size() - static_cast<size_t>(pos)) {
+      ec = bela::make_error_code(bela::ErrEOF, L"unexpected EOF");
+      return false;
+    }
+    memcpy(buffer.data(), image.data() + pos, buffer.size());
+    return true;
+  }
+  return fd.ReadAt(buffer, pos, ec);
+}
+
 bool File::parseFile(bela::error_code &ec) {
   if (size == bela::SizeUnInitialized) {
     if (size = fd.Size(ec); size == bela::SizeUnInitialized) {
@@ -26,7 +53,7 @@ bool File::parseFile(bela::error_code &ec) {
     }
   }
   uint8_t ident[16];
-  if (!fd.ReadAt(ident, 0, ec)) {
+  if (!readAt(ident, 0, ec)) {
     return false;
   }
   constexpr uint8_t elfmagic[4] = {'\x7f', 'E', 'L', 'F'};
@@ -77,7 +104,7 @@ bool File::parseFile(bela::error_code &ec) {
     wantPhentsize = 8 * 4;
     wantShentsize = 10 * 4;
     Elf32_Ehdr hdr;
-    if (!fd.ReadAt(hdr, 0, ec)) {
+    if (!readAt(hdr, 0, ec)) {
       return false;
     }
     fh.Type = endian_cast(hdr.e_type);
@@ -100,7 +127,7 @@ bool File::parseFile(bela::error_code &ec) {
     wantPhentsize = 2 * 4 + 6 * 8;
     wantShentsize = 4 * 4 + 6 * 8;
     Elf64_Ehdr hdr;
-    if (!fd.ReadAt(hdr, 0, ec)) {
+    if (!readAt(hdr, 0, ec)) {
       return false;
     }
     fh.Type = endian_cast(hdr.e_type);
@@ -145,7 +172,7 @@ bool File::parseFile(bela::error_code &ec) {
     auto p = &progs[i];
     if (fh.Class == ELFCLASS32) {
       Elf32_Phdr ph;
-      if (!fd.ReadAt(ph, off, ec)) {
+      if (!readAt(ph, off, ec)) {
         return false;
       }
       p->Type = endian_cast(ph.p_type);
@@ -158,7 +185,7 @@ bool File::parseFile(bela::error_code &ec) {
       p->Align = endian_cast(ph.p_align);
     } else {
       Elf64_Phdr ph;
-      if (!fd.ReadAt(ph, off, ec)) {
+      if (!readAt(ph, off, ec)) {
         return false;
       }
       p->Type = endian_cast(ph.p_type);
@@ -189,7 +216,7 @@ bool File::parseFile(bela::error_code &ec) {
     auto p = &sections[i];
     if (fh.Class == ELFCLASS32) {
       Elf32_Shdr sh;
-      if (!fd.ReadAt(sh, off, ec)) {
+      if (!readAt(sh, off, ec)) {
         return false;
       }
       p->Type = endian_cast(sh.sh_type);
@@ -205,7 +232,7 @@ bool File::parseFile(bela::error_code &ec) {
     } else {
       Elf64_Shdr sh;
       // constexpr auto n=sizeof(Elf64_Shdr);
-      if (!fd.ReadAt(sh, off, ec)) {
+      if (!readAt(sh, off, ec)) {
         return false;
       }
       p->Type = endian_cast(sh.sh_type);
@@ -223,9 +250,14 @@ bool File::parseFile(bela::error_code &ec) {
       p->Size = p->FileSize;
       continue;
     }
+    // compression header is at the start of the section data
     if (fh.Class == ELFCLASS32) {
       Elf32_Chdr ch;
-      if (!fd.ReadAt(ch, off, ec)) {
+      if (p->FileSize < sizeof(ch)) {
+        ec = bela::make_error_code(ErrGeneral, L"invalid ELF compressed section ", i);
+        return false;
+      }
+      if (!readAt(ch, p->Offset, ec)) {
         return false;
       }
       p->compressionType = endian_cast(ch.ch_type);
@@ -234,7 +266,11 @@ bool File::parseFile(bela::error_code &ec) {
       p->compressionOffset = sizeof(ch);
     } else {
       Elf64_Chdr ch;
-      if (!fd.ReadAt(ch, off, ec)) {
+      if (p->FileSize < sizeof(ch)) {
+        ec = bela::make_error_code(ErrGeneral, L"invalid ELF compressed section ", i);
+        return false;
+      }
+      if (!readAt(ch, p->Offset, ec)) {
         return false;
       }
       p->compressionType = endian_cast(ch.ch_type);
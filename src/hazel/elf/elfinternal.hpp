@@ -0,0 +1,15 @@
+//
+#ifndef HAZEL_ELF_INTERNAL_HPP
+#define HAZEL_ELF_INTERNAL_HPP
+#include <hazel/elf.hpp>
+
+namespace hazel::elf {
+// Reader pulls at most buffer.size() compressed bytes, outlen == 0 means end of input
+using Reader = std::function<bool(std::span<uint8_t> buffer, size_t &outlen, bela::error_code &ec)>;
+// ZlibDecompress decompress RFC1950 (zlib) stream, output is flushed to writer in chunks of at most 32K
+// https://www.rfc-editor.org/rfc/rfc1950
+// https://www.rfc-editor.org/rfc/rfc1951
+bool ZlibDecompress(const Reader &r, const Writer &w, bela::error_code &ec);
+} // namespace hazel::elf
+
+#endif
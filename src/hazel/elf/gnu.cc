@@ -3,21 +3,21 @@
 #include <utility>
 
 namespace hazel::elf {
-bool File::gnuVersionInit(std::span<const uint8_t> str) {
+bool File::gnuVersionInit(bela::bytes_view bv) {
   if (!gnuNeed.empty()) {
     // Already initialized
     return true;
   }
-  bela::bytes_view bv(str);
   auto vn = SectionByType(SHT_GNU_verneed);
   if (vn == nullptr) {
     return false;
   }
   bela::error_code ec;
-  bela::Buffer d;
-  if (!sectionData(*vn, d, ec)) {
+  SectionBytes vd;
+  if (!cachedSection(*vn, vd, ec)) {
     return false;
   }
+  const auto &d = *vd;
   int i = 0;
   auto sz = static_cast<int>(d.size());
   for (;;) {
@@ -62,15 +62,15 @@ bool File::gnuVersionInit(std::span<const uint8_t> str) {
   if (vs == nullptr) {
     return false;
   }
-  return sectionData(*vs, gnuVersym, ec);
+  return cachedSection(*vs, gnuVersym, ec);
 }
 
 bool File::DynamicSymbols(std::vector<Symbol> &syms, bela::error_code &ec) {
-  bela::Buffer strdata;
+  SectionBytes strdata;
   if (!getSymbols(SHT_DYNSYM, syms, strdata, ec)) {
     return false;
   }
-  if (gnuVersionInit(strdata.make_const_span())) {
+  if (gnuVersionInit(strdata->as_bytes_view())) {
     for (int i = 0; std::cmp_less(i, syms.size()); i++) {
       gnuVersion(i, syms[i].Library, syms[i].Version);
     }
@@ -81,12 +81,12 @@ bool File::DynamicSymbols(std::vector<Symbol> &syms, bela::error_code &ec) {
 constexpr int SymBind(int i) { return i >> 4; }
 
 bool File::ImportedSymbols(std::vector<ImportedSymbol> &symbols, bela::error_code &ec) {
-  bela::Buffer strdata;
+  SectionBytes strdata;
   std::vector<Symbol> syms;
   if (!getSymbols(SHT_DYNSYM, syms, strdata, ec)) {
     return false;
   }
-  gnuVersionInit(strdata.make_const_span());
+  gnuVersionInit(strdata->as_bytes_view());
   symbols.reserve(syms.size());
   for (int i = 0; std::cmp_less(i, syms.size()); i++) {
     const auto &s = syms[i];
@@ -0,0 +1,510 @@
+///
+#include "elfinternal.hpp"
+
+namespace hazel::elf {
+// inflate: a small streaming DEFLATE decoder, only used to expand SHF_COMPRESSED sections.
+// The decoder pulls compressed bytes through Reader and keeps a 32K history window, so the memory footprint does not
+// depend on the section size.
+constexpr int maxBits = 15;
+constexpr int fastBits = 9;
+constexpr int maxLitCodes = 288;
+constexpr int maxDistCodes = 30;
+constexpr size_t windowSize = 32768;
+constexpr size_t inputSize = 65536;
+
+constexpr uint16_t lengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                     31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t distBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                   193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+constexpr uint8_t codeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// canonical huffman table, fast[] resolves codes no longer than fastBits with one lookup: (symbol << 4) | length
+struct huffman {
+  uint16_t fast[1 << fastBits];
+  uint16_t count[maxBits + 1];
+  uint16_t symbol[maxLitCodes];
+  bool build(const uint8_t *lengths, int n) {
+    memset(count, 0, sizeof(count));
+    memset(fast, 0, sizeof(fast));
+    for (int i = 0; i < n; i++) {
+      count[lengths[i]]++;
+    }
+    count[0] = 0;
+    int left = 1;
+    for (int len = 1; len <= maxBits; len++) {
+      left <<= 1;
+      left -= count[len];
+      if (left < 0) {
+        return false; // over-subscribed
+      }
+    }
+    uint16_t offs[maxBits + 1] = {0};
+    for (int len = 1; len < maxBits; len++) {
+      offs[len + 1] = offs[len] + count[len];
+    }
+    for (int i = 0; i < n; i++) {
+      if (lengths[i] != 0) {
+        symbol[offs[lengths[i]]++] = static_cast<uint16_t>(i);
+      }
+    }
+    uint32_t code = 0;
+    int index = 0;
+    for (int len = 1; len <= fastBits; len++) {
+      for (int k = 0; k < count[len]; k++, code++) {
+        uint32_t rev = 0;
+        for (int b = 0; b < len; b++) {
+          rev |= ((code >> b) & 1) << (len - 1 - b);
+        }
+        auto e = static_cast<uint16_t>((symbol[index++] << 4) | len);
+        for (uint32_t j = rev; j < (1U << fastBits); j += (1U << len)) {
+          fast[j] = e;
+        }
+      }
+      code <<= 1;
+    }
+    return true;
+  }
+};
+
+class Inflater {
+public:
+  Inflater(const Reader &r, const Writer &w) : reader(r), writer(w) {}
+  Inflater(const Inflater &) = delete;
+  Inflater &operator=(const Inflater &) = delete;
+  bool Decompress(bela::error_code &ec);
+
+private:
+  const Reader &reader;
+  const Writer &writer;
+  bela::Buffer input{inputSize};
+  size_t ipos{0};
+  bool eof{false};
+  uint64_t bitbuf{0};
+  int bitcnt{0};
+  // output window: 2 * windowSize, the older half holds history after the first flush
+  bela::Buffer window{windowSize * 2};
+  size_t wpos{0};
+  size_t flushed{0};
+  uint64_t total{0};
+  uint32_t adler{1};
+  huffman lencode;
+  huffman distcode;
+
+  bool fill(bela::error_code &ec) {
+    while (bitcnt <= 56) {
+      if (ipos == input.size()) {
+        if (eof) {
+          break;
+        }
+        size_t n = 0;
+        if (!reader(input.make_span(inputSize), n, ec)) {
+          return false;
+        }
+        input.size() = n;
+        ipos = 0;
+        if (n == 0) {
+          eof = true;
+          break;
+        }
+      }
+      bitbuf |= static_cast<uint64_t>(input[ipos++]) << bitcnt;
+      bitcnt += 8;
+    }
+    return true;
+  }
+  bool bits(int n, uint32_t &v, bela::error_code &ec) {
+    if (bitcnt < n) {
+      if (!fill(ec)) {
+        return false;
+      }
+      if (bitcnt < n) {
+        ec = bela::make_error_code(bela::ErrEOF, L"inflate: unexpected end of compressed data");
+        return false;
+      }
+    }
+    v = static_cast<uint32_t>(bitbuf & ((1ULL << n) - 1));
+    bitbuf >>= n;
+    bitcnt -= n;
+    return true;
+  }
+  bool decode(const huffman &h, int &sym, bela::error_code &ec) {
+    if (bitcnt < maxBits && !fill(ec)) {
+      return false;
+    }
+    if (auto e = h.fast[bitbuf & ((1U << fastBits) - 1)]; e != 0) {
+      auto len = e & 15;
+      if (len > bitcnt) {
+        ec = bela::make_error_code(bela::ErrEOF, L"inflate: unexpected end of compressed data");
+        return false;
+      }
+      bitbuf >>= len;
+      bitcnt -= len;
+      sym = e >> 4;
+      return true;
+    }
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= maxBits && len <= bitcnt; len++) {
+      code |= static_cast<int>((bitbuf >> (len - 1)) & 1);
+      int count = h.count[len];
+      if (code - count < first) {
+        bitbuf >>= len;
+        bitcnt -= len;
+        sym = h.symbol[index + (code - first)];
+        return true;
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+    }
+    ec = bela::make_error_code(ErrGeneral, L"inflate: invalid huffman code");
+    return false;
+  }
+  bool flush(bela::error_code &ec) {
+    if (wpos == flushed) {
+      return true;
+    }
+    auto p = window.data() + flushed;
+    auto n = wpos - flushed;
+    adler = adler32(adler, p, n);
+    if (!writer(p, n)) {
+      ec = bela::make_error_code(bela::ErrCanceled, L"inflate: writer canceled");
+      return false;
+    }
+    flushed = wpos;
+    return true;
+  }
+  // keep the last windowSize bytes as history
+  bool slide(bela::error_code &ec) {
+    if (!flush(ec)) {
+      return false;
+    }
+    memmove(window.data(), window.data() + windowSize, windowSize);
+    wpos = windowSize;
+    flushed = windowSize;
+    return true;
+  }
+  bool put(uint8_t c, bela::error_code &ec) {
+    if (wpos == window.capacity() && !slide(ec)) {
+      return false;
+    }
+    window.data()[wpos++] = c;
+    total++;
+    return true;
+  }
+  bool copy(size_t dist, size_t len, bela::error_code &ec) {
+    if (dist > total || dist > windowSize) {
+      ec = bela::make_error_code(ErrGeneral, L"inflate: invalid distance too far back");
+      return false;
+    }
+    while (len != 0) {
+      if (wpos == window.capacity() && !slide(ec)) {
+        return false;
+      }
+      auto n = (std::min)(len, window.capacity() - wpos);
+      auto dst = window.data() + wpos;
+      auto src = dst - dist;
+      for (size_t i = 0; i < n; i++) {
+        dst[i] = src[i]; // overlapped copy is intended
+      }
+      wpos += n;
+      total += n;
+      len -= n;
+    }
+    return true;
+  }
+  bool stored(bela::error_code &ec);
+  bool codes(bela::error_code &ec);
+  bool fixed(bela::error_code &ec);
+  bool dynamic(bela::error_code &ec);
+  static uint32_t adler32(uint32_t a, const uint8_t *p, size_t n) {
+    constexpr uint32_t base = 65521;
+    constexpr size_t nmax = 5552;
+    uint32_t s1 = a & 0xffff;
+    uint32_t s2 = a >> 16;
+    while (n != 0) {
+      auto k = (std::min)(n, nmax);
+      n -= k;
+      for (size_t i = 0; i < k; i++) {
+        s1 += p[i];
+        s2 += s1;
+      }
+      p += k;
+      s1 %= base;
+      s2 %= base;
+    }
+    return (s2 << 16) | s1;
+  }
+};
+
+bool Inflater::stored(bela::error_code &ec) {
+  // discard remaining bits of current byte
+  bitbuf >>= (bitcnt & 7);
+  bitcnt -= (bitcnt & 7);
+  uint32_t len = 0;
+  uint32_t nlen = 0;
+  if (!bits(16, len, ec) || !bits(16, nlen, ec)) {
+    return false;
+  }
+  if (len != (~nlen & 0xffff)) {
+    ec = bela::make_error_code(ErrGeneral, L"inflate: stored block length did not match one's complement");
+    return false;
+  }
+  // bytes still buffered in bitbuf
+  while (len != 0 && bitcnt >= 8) {
+    if (!put(static_cast<uint8_t>(bitbuf & 0xff), ec)) {
+      return false;
+    }
+    bitbuf >>= 8;
+    bitcnt -= 8;
+    len--;
+  }
+  while (len != 0) {
+    if (ipos == input.size()) {
+      if (!fill(ec)) {
+        return false;
+      }
+      // fill() consumed bytes into bitbuf, drain them first
+      while (len != 0 && bitcnt >= 8) {
+        if (!put(static_cast<uint8_t>(bitbuf & 0xff), ec)) {
+          return false;
+        }
+        bitbuf >>= 8;
+        bitcnt -= 8;
+        len--;
+      }
+      if (len != 0 && eof && ipos == input.size()) {
+        ec = bela::make_error_code(bela::ErrEOF, L"inflate: unexpected end of stored block");
+        return false;
+      }
+      continue;
+    }
+    if (wpos == window.capacity() && !slide(ec)) {
+      return false;
+    }
+    auto n = (std::min)({static_cast<size_t>(len), input.size() - ipos, window.capacity() - wpos});
+    memcpy(window.data() + wpos, input.data() + ipos, n);
+    ipos += n;
+    wpos += n;
+    total += n;
+    len -= static_cast<uint32_t>(n);
+  }
+  return true;
+}
+
+bool Inflater::codes(bela::error_code &ec) {
+  for (;;) {
+    int sym = 0;
+    if (!decode(lencode, sym, ec)) {
+      return false;
+    }
+    if (sym < 256) {
+      if (!put(static_cast<uint8_t>(sym), ec)) {
+        return false;
+      }
+      continue;
+    }
+    if (sym == 256) {
+      return true;
+    }
+    sym -= 257;
+    if (sym >= 29) {
+      ec = bela::make_error_code(ErrGeneral, L"inflate: invalid literal/length symbol");
+      return false;
+    }
+    uint32_t extra = 0;
+    if (!bits(lengthExtra[sym], extra, ec)) {
+      return false;
+    }
+    auto len = static_cast<size_t>(lengthBase[sym]) + extra;
+    int dsym = 0;
+    if (!decode(distcode, dsym, ec)) {
+      return false;
+    }
+    if (dsym >= maxDistCodes) {
+      ec = bela::make_error_code(ErrGeneral, L"inflate: invalid distance symbol");
+      return false;
+    }
+    if (!bits(distExtra[dsym], extra, ec)) {
+      return false;
+    }
+    if (!copy(static_cast<size_t>(distBase[dsym]) + extra, len, ec)) {
+      return false;
+    }
+  }
+}
+
+bool Inflater::fixed(bela::error_code &ec) {
+  uint8_t lengths[maxLitCodes + maxDistCodes];
+  int i = 0;
+  for (; i < 144; i++) {
+    lengths[i] = 8;
+  }
+  for (; i < 256; i++) {
+    lengths[i] = 9;
+  }
+  for (; i < 280; i++) {
+    lengths[i] = 7;
+  }
+  for (; i < maxLitCodes; i++) {
+    lengths[i] = 8;
+  }
+  for (; i < maxLitCodes + maxDistCodes; i++) {
+    lengths[i] = 5;
+  }
+  lencode.build(lengths, maxLitCodes);
+  distcode.build(lengths + maxLitCodes, maxDistCodes);
+  return codes(ec);
+}
+
+bool Inflater::dynamic(bela::error_code &ec) {
+  uint32_t nlen = 0;
+  uint32_t ndist = 0;
+  uint32_t ncode = 0;
+  if (!bits(5, nlen, ec) || !bits(5, ndist, ec) || !bits(4, ncode, ec)) {
+    return false;
+  }
+  nlen += 257;
+  ndist += 1;
+  ncode += 4;
+  if (nlen > maxLitCodes || ndist > maxDistCodes) {
+    ec = bela::make_error_code(ErrGeneral, L"inflate: too many length or distance symbols");
+    return false;
+  }
+  uint8_t lengths[maxLitCodes + maxDistCodes] = {0};
+  for (uint32_t i = 0; i < ncode; i++) {
+    uint32_t v = 0;
+    if (!bits(3, v, ec)) {
+      return false;
+    }
+    lengths[codeLengthOrder[i]] = static_cast<uint8_t>(v);
+  }
+  if (!lencode.build(lengths, 19)) {
+    ec = bela::make_error_code(ErrGeneral, L"inflate: invalid code lengths set");
+    return false;
+  }
+  uint32_t index = 0;
+  while (index < nlen + ndist) {
+    int sym = 0;
+    if (!decode(lencode, sym, ec)) {
+      return false;
+    }
+    if (sym < 16) {
+      lengths[index++] = static_cast<uint8_t>(sym);
+      continue;
+    }
+    uint8_t len = 0;
+    uint32_t rep = 0;
+    if (sym == 16) {
+      if (index == 0) {
+        ec = bela::make_error_code(ErrGeneral, L"inflate: invalid bit length repeat");
+        return false;
+      }
+      len = lengths[index - 1];
+      if (!bits(2, rep, ec)) {
+        return false;
+      }
+      rep += 3;
+    } else if (sym == 17) {
+      if (!bits(3, rep, ec)) {
+        return false;
+      }
+      rep += 3;
+    } else {
+      if (!bits(7, rep, ec)) {
+        return false;
+      }
+      rep += 11;
+    }
+    if (index + rep > nlen + ndist) {
+      ec = bela::make_error_code(ErrGeneral, L"inflate: invalid bit length repeat");
+      return false;
+    }
+    while (rep-- != 0) {
+      lengths[index++] = len;
+    }
+  }
+  if (lengths[256] == 0) {
+    ec = bela::make_error_code(ErrGeneral, L"inflate: invalid code -- missing end-of-block");
+    return false;
+  }
+  if (!lencode.build(lengths, static_cast<int>(nlen)) ||
+      !distcode.build(lengths + nlen, static_cast<int>(ndist))) {
+    ec = bela::make_error_code(ErrGeneral, L"inflate: invalid literal/lengths or distances set");
+    return false;
+  }
+  return codes(ec);
+}
+
+bool Inflater::Decompress(bela::error_code &ec) {
+  uint32_t cmf = 0;
+  uint32_t flg = 0;
+  if (!bits(8, cmf, ec) || !bits(8, flg, ec)) {
+    return false;
+  }
+  if ((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0) {
+    ec = bela::make_error_code(ErrGeneral, L"zlib: invalid header");
+    return false;
+  }
+  if ((flg & 0x20) != 0) {
+    ec = bela::make_error_code(ErrGeneral, L"zlib: preset dictionary not supported");
+    return false;
+  }
+  for (;;) {
+    uint32_t last = 0;
+    uint32_t type = 0;
+    if (!bits(1, last, ec) || !bits(2, type, ec)) {
+      return false;
+    }
+    bool result = false;
+    switch (type) {
+    case 0:
+      result = stored(ec);
+      break;
+    case 1:
+      result = fixed(ec);
+      break;
+    case 2:
+      result = dynamic(ec);
+      break;
+    default:
+      ec = bela::make_error_code(ErrGeneral, L"inflate: invalid block type");
+      return false;
+    }
+    if (!result) {
+      return false;
+    }
+    if (last != 0) {
+      break;
+    }
+  }
+  if (!flush(ec)) {
+    return false;
+  }
+  bitbuf >>= (bitcnt & 7);
+  bitcnt -= (bitcnt & 7);
+  uint32_t checksum = 0;
+  for (int i = 0; i < 4; i++) {
+    uint32_t b = 0;
+    if (!bits(8, b, ec)) {
+      return false;
+    }
+    checksum = (checksum << 8) | b;
+  }
+  if (checksum != adler) {
+    ec = bela::make_error_code(ErrGeneral, L"zlib: invalid checksum");
+    return false;
+  }
+  return true;
+}
+
+bool ZlibDecompress(const Reader &r, const Writer &w, bela::error_code &ec) {
+  auto inflater = std::make_unique<Inflater>(r, w);
+  return inflater->Decompress(ec);
+}
+
+} // namespace hazel::elf
@@ -0,0 +1,530 @@
+///
+#include <hazel/elf.hpp>
+#include <bela/fs.hpp>
+#include <bela/fnmatch.hpp>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+
+namespace hazel::elf {
+// (volume serial number, file index) same as (st_dev, st_ino)
+using FileKey = std::pair<uint64_t, uint64_t>;
+
+struct Library {
+  std::string SoName;
+  std::vector<std::string> Needed;
+  std::vector<std::string> Rpath;
+  std::vector<std::string> Runpath;
+  uint16_t Machine{0};
+  uint8_t Class{0};
+  uint8_t Data{0};
+  bool Compatible(const Library &o) const { return Class == o.Class && Data == o.Data && Machine == o.Machine; }
+};
+using LibraryPtr = std::shared_ptr<const Library>;
+
+struct DependencyCache {
+  std::mutex mu;
+  bela::flat_hash_map<FileKey, LibraryPtr> libraries;
+  // normalized path --> library, nullptr: not exists or not ELF
+  bela::flat_hash_map<std::string, LibraryPtr> paths;
+  std::vector<std::string> ldconfig;
+  std::once_flag ldconfigOnce;
+};
+
+namespace {
+constexpr size_t maxIncludeDepth = 8;
+
+inline std::vector<std::string_view> splitPaths(std::string_view sv, std::string_view delims) {
+  std::vector<std::string_view> pv;
+  while (!sv.empty()) {
+    auto pos = sv.find_first_of(delims);
+    auto s = sv.substr(0, pos);
+    if (!s.empty()) {
+      pv.emplace_back(s);
+    }
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    sv.remove_prefix(pos + 1);
+  }
+  return pv;
+}
+
+inline std::string_view trimSpace(std::string_view sv) {
+  constexpr std::string_view spaces = " \t\r\n";
+  auto first = sv.find_first_not_of(spaces);
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return sv.substr(first, sv.find_last_not_of(spaces) - first + 1);
+}
+
+// cleanPath lexical clean POSIX path, '..' cannot escape '/' so the result always stays inside sysroot
+std::string cleanPath(std::string_view p) {
+  std::vector<std::string_view> elems;
+  for (auto e : splitPaths(p, "/")) {
+    if (e == ".") {
+      continue;
+    }
+    if (e == "..") {
+      if (!elems.empty()) {
+        elems.pop_back();
+      }
+      continue;
+    }
+    elems.emplace_back(e);
+  }
+  std::string s;
+  for (auto e : elems) {
+    s.push_back('/');
+    s.append(e);
+  }
+  if (s.empty()) {
+    s.push_back('/');
+  }
+  return s;
+}
+
+inline std::string_view dirName(std::string_view p) {
+  auto pos = p.rfind('/');
+  if (pos == std::string_view::npos || pos == 0) {
+    return "/";
+  }
+  return p.substr(0, pos);
+}
+
+inline std::string joinPath(std::string_view dir, std::string_view name) {
+  std::string s(dir);
+  s.push_back('/');
+  s.append(name);
+  return cleanPath(s);
+}
+
+// expandToken expand $ORIGIN ${ORIGIN} $LIB ${LIB}, $PLATFORM is unknown for sysroot, keep as is
+std::string expandToken(std::string_view sv, std::string_view origin, bool is64bit) {
+  constexpr std::string_view tokens[] = {"${ORIGIN}", "$ORIGIN", "${LIB}", "$LIB"};
+  std::string s;
+  while (!sv.empty()) {
+    auto pos = sv.find('$');
+    if (pos == std::string_view::npos) {
+      s.append(sv);
+      break;
+    }
+    s.append(sv.substr(0, pos));
+    sv.remove_prefix(pos);
+    auto matched = false;
+    for (auto k : tokens) {
+      if (sv.starts_with(k)) {
+        s.append(k.find("ORIGIN") != std::string_view::npos ? origin : (is64bit ? "lib64" : "lib"));
+        sv.remove_prefix(k.size());
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) {
+      s.push_back('$');
+      sv.remove_prefix(1);
+    }
+  }
+  return s;
+}
+
+inline std::vector<std::string> dynPaths(const File &file, int tag) {
+  std::vector<std::string> sv;
+  std::vector<std::string> paths;
+  bela::error_code ec;
+  if (!file.DynString(tag, sv, ec)) {
+    return paths;
+  }
+  for (const auto &s : sv) {
+    for (auto p : splitPaths(s, ":")) {
+      paths.emplace_back(p);
+    }
+  }
+  return paths;
+}
+
+struct Task {
+  size_t job{0};
+  int node{-1}; // -1 load root
+};
+
+struct Job {
+  std::vector<LibraryPtr> libraries; // same index as graph.Nodes
+  bela::flat_hash_map<const Library *, int> index;
+  bela::flat_hash_set<std::string> missing;
+  std::vector<std::string> rpath; // executable DT_RPATH, inherited by loaded objects without DT_RUNPATH
+};
+} // namespace
+
+class Searcher {
+public:
+  Searcher(std::wstring_view sysroot_, DependencyCache &cache_) : sysroot(sysroot_), cache(cache_) {}
+  std::wstring SysPath(std::string_view p) const {
+    auto w = bela::StringCat(sysroot, bela::encode_into<char, wchar_t>(p));
+    std::replace(w.begin() + sysroot.size(), w.end(), L'/', L'\\');
+    return w;
+  }
+  void LoadLdConfig() {
+    std::call_once(cache.ldconfigOnce, [&] {
+      parseLdConfig("/etc/ld.so.conf", 0);
+      bela::flat_hash_set<std::string> seen;
+      std::erase_if(cache.ldconfig, [&](const std::string &d) { return !seen.emplace(d).second; });
+    });
+  }
+  LibraryPtr Load(std::string_view path, bela::error_code &ec);
+  LibraryPtr Search(const Library &requester, std::string_view origin, const Library &root, const Job &job,
+                    std::string_view name, std::string &resolved);
+
+private:
+  std::wstring_view sysroot;
+  DependencyCache &cache;
+  void parseLdConfig(std::string_view confPath, size_t depth);
+  void expandInclude(std::string_view pattern, size_t depth);
+  LibraryPtr tryLoad(std::string_view path, const Library &root) {
+    bela::error_code ec;
+    if (auto lib = Load(path, ec); lib && lib->Compatible(root)) {
+      return lib;
+    }
+    return nullptr;
+  }
+};
+
+// https://man7.org/linux/man-pages/man8/ldconfig.8.html
+void Searcher::parseLdConfig(std::string_view confPath, size_t depth) {
+  if (depth > maxIncludeDepth) {
+    return;
+  }
+  std::string content;
+  bela::error_code ec;
+  if (!bela::io::ReadFile(SysPath(confPath), content, ec)) {
+    return;
+  }
+  for (auto line : splitPaths(content, "\n")) {
+    if (auto pos = line.find('#'); pos != std::string_view::npos) {
+      line = line.substr(0, pos);
+    }
+    line = trimSpace(line);
+    if (line.empty()) {
+      continue;
+    }
+    if (line.starts_with("include") && line.size() > 7 && (line[7] == ' ' || line[7] == '\t')) {
+      for (auto pattern : splitPaths(line.substr(8), " \t")) {
+        expandInclude(pattern.front() == '/' ? cleanPath(pattern) : joinPath(dirName(confPath), pattern), depth + 1);
+      }
+      continue;
+    }
+    if (line.starts_with("hwcap")) {
+      continue;
+    }
+    for (auto d : splitPaths(line, " \t,:=")) {
+      if (d.front() == '/') {
+        cache.ldconfig.emplace_back(cleanPath(d));
+      }
+    }
+  }
+}
+
+void Searcher::expandInclude(std::string_view pattern, size_t depth) {
+  auto dir = dirName(pattern);
+  auto name = pattern.substr(pattern.rfind('/') + 1);
+  if (name.find_first_of("*?[") == std::string_view::npos) {
+    parseLdConfig(pattern, depth);
+    return;
+  }
+  bela::error_code ec;
+  bela::fs::Finder finder;
+  if (!finder.First(SysPath(dir), L"*", ec)) {
+    return;
+  }
+  std::vector<std::string> files;
+  do {
+    if (finder.Ignore() || finder.IsDir()) {
+      continue;
+    }
+    auto fileName = bela::encode_into<wchar_t, char>(finder.Name());
+    if (bela::FnMatch(name, fileName)) {
+      files.emplace_back(joinPath(dir, fileName));
+    }
+  } while (finder.Next());
+  // glob(3) results are sorted
+  std::sort(files.begin(), files.end());
+  for (const auto &f : files) {
+    parseLdConfig(f, depth);
+  }
+}
+
+LibraryPtr Searcher::Load(std::string_view path, bela::error_code &ec) {
+  auto key = std::string(path);
+  {
+    std::scoped_lock lock(cache.mu);
+    if (auto it = cache.paths.find(key); it != cache.paths.end()) {
+      if (!it->second) {
+        ec = bela::make_error_code(ErrGeneral, L"'", bela::encode_into<char, wchar_t>(path),
+                                   L"' not found or not ELF file");
+      }
+      return it->second;
+    }
+  }
+  auto remember = [&](LibraryPtr lib) -> LibraryPtr {
+    std::scoped_lock lock(cache.mu);
+    cache.paths.try_emplace(key, lib);
+    return lib;
+  };
+  auto fd = bela::io::NewFile(SysPath(path), ec);
+  if (!fd) {
+    return remember(nullptr);
+  }
+  BY_HANDLE_FILE_INFORMATION bi;
+  if (GetFileInformationByHandle(fd->NativeFD(), &bi) != TRUE) {
+    ec = bela::make_system_error_code(L"GetFileInformationByHandle(): ");
+    return nullptr;
+  }
+  FileKey fk{bi.dwVolumeSerialNumber,
+             (static_cast<uint64_t>(bi.nFileIndexHigh) << 32) | static_cast<uint64_t>(bi.nFileIndexLow)};
+  {
+    std::scoped_lock lock(cache.mu);
+    if (auto it = cache.libraries.find(fk); it != cache.libraries.end()) {
+      cache.paths.try_emplace(key, it->second);
+      return it->second;
+    }
+  }
+  auto size = (static_cast<int64_t>(bi.nFileSizeHigh) << 32) | static_cast<int64_t>(bi.nFileSizeLow);
+  File file;
+  if (!file.NewFile(fd->NativeFD(), size, ec)) {
+    return remember(nullptr);
+  }
+  auto lib = std::make_shared<Library>();
+  lib->Class = file.Fh().Class;
+  lib->Data = file.Fh().Data;
+  lib->Machine = file.Fh().Machine;
+  if (!file.Depends(lib->Needed, ec)) {
+    return remember(nullptr);
+  }
+  std::vector<std::string> soname;
+  if (file.DynString(DT_SONAME, soname, ec) && !soname.empty()) {
+    lib->SoName = std::move(soname.front());
+  }
+  lib->Rpath = dynPaths(file, DT_RPATH);
+  lib->Runpath = dynPaths(file, DT_RUNPATH);
+  std::scoped_lock lock(cache.mu);
+  // another worker may parse the same inode concurrently, keep the first one
+  auto it = cache.libraries.try_emplace(fk, std::move(lib)).first;
+  cache.paths.try_emplace(key, it->second);
+  return it->second;
+}
+
+// https://man7.org/linux/man-pages/man8/ld.so.8.html
+LibraryPtr Searcher::Search(const Library &requester, std::string_view origin, const Library &root, const Job &job,
+                            std::string_view name, std::string &resolved) {
+  auto is64bit = root.Class == ELFCLASS64;
+  auto originDir = dirName(origin);
+  if (name.find('/') != std::string_view::npos) {
+    auto p = expandToken(name, originDir, is64bit);
+    resolved = p.front() == '/' ? cleanPath(p) : joinPath(originDir, p);
+    return tryLoad(resolved, root);
+  }
+  auto searchDirs = [&](const std::vector<std::string> &dirs, bool expand) -> LibraryPtr {
+    for (const auto &d : dirs) {
+      auto dir = expand ? expandToken(d, originDir, is64bit) : d;
+      // relative entries are relative to the working directory of ld.so, use $ORIGIN instead
+      resolved = dir.starts_with('/') ? joinPath(dir, name) : joinPath(std::string(originDir).append("/").append(dir), name);
+      if (auto lib = tryLoad(resolved, root); lib) {
+        return lib;
+      }
+    }
+    return nullptr;
+  };
+  // DT_RPATH is ignored when DT_RUNPATH exists. the full loader chain is approximated by requester and executable
+  if (requester.Runpath.empty()) {
+    if (auto lib = searchDirs(requester.Rpath, true); lib) {
+      return lib;
+    }
+    if (&requester != &root) {
+      if (auto lib = searchDirs(job.rpath, true); lib) {
+        return lib;
+      }
+    }
+  }
+  if (auto lib = searchDirs(requester.Runpath, true); lib) {
+    return lib;
+  }
+  if (auto lib = searchDirs(cache.ldconfig, false); lib) {
+    return lib;
+  }
+  static const std::vector<std::string> defaultDirs64 = {"/lib64", "/usr/lib64", "/lib", "/usr/lib"};
+  static const std::vector<std::string> defaultDirs = {"/lib", "/usr/lib"};
+  if (auto lib = searchDirs(is64bit ? defaultDirs64 : defaultDirs, false); lib) {
+    return lib;
+  }
+  resolved.clear();
+  return nullptr;
+}
+
+DependencyResolver::DependencyResolver(std::wstring_view sysroot_, uint32_t concurrency_)
+    : sysroot(sysroot_), concurrency(concurrency_), cache(std::make_unique<DependencyCache>()) {
+  while (!sysroot.empty() && bela::IsPathSeparator(sysroot.back())) {
+    sysroot.pop_back();
+  }
+  if (concurrency == 0) {
+    concurrency = (std::max)(std::thread::hardware_concurrency(), 1u);
+  }
+}
+
+DependencyResolver::~DependencyResolver() = default;
+
+bool DependencyResolver::Resolve(std::string_view path, DependencyGraph &graph, bela::error_code &ec) {
+  std::vector<DependencyGraph> graphs;
+  if (!Resolve({std::string(path)}, graphs, ec)) {
+    return false;
+  }
+  graph = std::move(graphs.front());
+  if (graph.Error) {
+    ec = graph.Error;
+    return false;
+  }
+  return true;
+}
+
+bool DependencyResolver::Resolve(const std::vector<std::string> &paths, std::vector<DependencyGraph> &graphs,
+                                 bela::error_code &ec) {
+  if (paths.empty()) {
+    ec = bela::make_error_code(ErrGeneral, L"no file to resolve");
+    return false;
+  }
+  Searcher searcher(sysroot, *cache);
+  searcher.LoadLdConfig();
+  graphs.clear();
+  graphs.resize(paths.size());
+  std::vector<Job> jobs(paths.size());
+  std::deque<Task> tasks;
+  for (size_t i = 0; i < paths.size(); i++) {
+    tasks.emplace_back(Task{.job = i, .node = -1});
+  }
+  std::mutex mu;
+  std::condition_variable cv;
+  size_t active = 0;
+  // every task only touch its own job, lock is only held while modifying graph
+  auto process = [&](const Task &t) {
+    auto &job = jobs[t.job];
+    auto &graph = graphs[t.job];
+    if (t.node == -1) {
+      auto p = cleanPath(paths[t.job]);
+      bela::error_code rec;
+      auto lib = searcher.Load(p, rec);
+      std::scoped_lock lock(mu);
+      if (!lib) {
+        graph.Error = std::move(rec);
+        return;
+      }
+      if (lib->Runpath.empty()) {
+        job.rpath = lib->Rpath;
+      }
+      job.libraries.emplace_back(lib);
+      job.index.emplace(lib.get(), 0);
+      auto &node = graph.Nodes.emplace_back();
+      node.Name = paths[t.job];
+      node.Path = std::move(p);
+      node.SoName = lib->SoName;
+      node.Needed = lib->Needed;
+      tasks.emplace_back(Task{.job = t.job, .node = 0});
+      cv.notify_one();
+      return;
+    }
+    LibraryPtr lib;
+    LibraryPtr root;
+    std::string origin;
+    {
+      std::scoped_lock lock(mu);
+      lib = job.libraries[t.node];
+      root = job.libraries.front();
+      origin = graph.Nodes[t.node].Path;
+    }
+    std::vector<std::pair<LibraryPtr, std::string>> found;
+    for (const auto &name : lib->Needed) {
+      std::string resolved;
+      auto dep = searcher.Search(*lib, origin, *root, job, name, resolved);
+      found.emplace_back(std::move(dep), std::move(resolved));
+    }
+    std::scoped_lock lock(mu);
+    std::vector<int> edges;
+    for (size_t i = 0; i < found.size(); i++) {
+      auto &[dep, resolved] = found[i];
+      if (!dep) {
+        job.missing.emplace(lib->Needed[i]);
+        edges.emplace_back(-1);
+        continue;
+      }
+      auto [it, inserted] = job.index.try_emplace(dep.get(), static_cast<int>(graph.Nodes.size()));
+      edges.emplace_back(it->second);
+      if (!inserted) {
+        continue;
+      }
+      job.libraries.emplace_back(dep);
+      auto &node = graph.Nodes.emplace_back();
+      node.Name = lib->Needed[i];
+      node.Path = std::move(resolved);
+      node.SoName = dep->SoName;
+      node.Needed = dep->Needed;
+      tasks.emplace_back(Task{.job = t.job, .node = it->second});
+      cv.notify_one();
+    }
+    graph.Nodes[t.node].Edges = std::move(edges);
+  };
+  // first exception thrown by a task, every worker stops and it is rethrown on the caller after join
+  std::exception_ptr failure;
+  auto worker = [&] {
+    std::unique_lock lock(mu);
+    for (;;) {
+      cv.wait(lock, [&] { return !tasks.empty() || active == 0 || failure; });
+      if (tasks.empty() || failure) {
+        cv.notify_all();
+        return;
+      }
+      auto t = tasks.front();
+      tasks.pop_front();
+      active++;
+      lock.unlock();
+      std::exception_ptr e;
+      try {
+        process(t);
+      } catch (...) {
+        e = std::current_exception();
+      }
+      lock.lock();
+      active--;
+      if (e && !failure) {
+        failure = std::move(e);
+        cv.notify_all();
+      }
+      if (tasks.empty() && active == 0) {
+        cv.notify_all();
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  try {
+    for (uint32_t i = 1; i < concurrency; i++) {
+      workers.emplace_back(worker);
+    }
+  } catch (...) {
+    // fewer threads, the caller drains the queue with whatever started
+  }
+  worker();
+  for (auto &w : workers) {
+    w.join();
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+  for (size_t i = 0; i < graphs.size(); i++) {
+    graphs[i].Missing.assign(jobs[i].missing.begin(), jobs[i].missing.end());
+    std::sort(graphs[i].Missing.begin(), graphs[i].Missing.end());
+  }
+  return true;
+}
+
+} // namespace hazel::elf
@@ -0,0 +1,170 @@
+///
+#include "elfinternal.hpp"
+
+namespace hazel::elf {
+constexpr size_t sectionChunkSize = 64 * 1024;
+
+// readRawSection reads the on-disk bytes of section (after the compression header when SHF_COMPRESSED)
+bool File::readRawSection(const Section &sec, const Writer &w, bela::error_code &ec) const {
+  if (sec.Type == SHT_NOBITS) {
+    return true;
+  }
+  if (bela::narrow_cast<int64_t>(sec.Offset + sec.FileSize) > size) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"corrupted ELF file, section overflow file: ", size,
+                               L" section end: ", sec.Offset + sec.FileSize);
+    return false;
+  }
+  auto offset = static_cast<int64_t>(sec.Offset) + sec.compressionOffset;
+  auto remaining = sec.FileSize - static_cast<uint64_t>(sec.compressionOffset);
+  bela::Buffer buffer(static_cast<size_t>((std::min)(remaining, static_cast<uint64_t>(sectionChunkSize))));
+  while (remaining != 0) {
+    auto n = static_cast<size_t>((std::min)(remaining, static_cast<uint64_t>(buffer.capacity())));
+    if (!readAt(buffer, n, offset, ec)) {
+      return false;
+    }
+    if (!w(buffer.data(), n)) {
+      ec = bela::make_error_code(bela::ErrCanceled, L"section reader canceled");
+      return false;
+    }
+    offset += n;
+    remaining -= n;
+  }
+  return true;
+}
+
+bool File::SectionStream(const Section &sec, const Writer &w, bela::error_code &ec) const {
+  if ((sec.Flags & SHF_COMPRESSED) == 0) {
+    return readRawSection(sec, w, ec);
+  }
+  switch (sec.compressionType) {
+  case COMPRESS_ZLIB:
+    break;
+  case COMPRESS_ZSTD:
+    ec = bela::make_error_code(bela::ErrUnimplemented, L"section '", bela::encode_into<char, wchar_t>(sec.Name),
+                               L"' zstd compression not supported");
+    return false;
+  default:
+    ec = bela::make_error_code(ErrGeneral, L"section '", bela::encode_into<char, wchar_t>(sec.Name),
+                               L"' unknown compression type ", sec.compressionType);
+    return false;
+  }
+  if (bela::narrow_cast<int64_t>(sec.Offset + sec.FileSize) > size) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"corrupted ELF file, section overflow file: ", size,
+                               L" section end: ", sec.Offset + sec.FileSize);
+    return false;
+  }
+  auto offset = static_cast<int64_t>(sec.Offset) + sec.compressionOffset;
+  auto remaining = sec.FileSize - static_cast<uint64_t>(sec.compressionOffset);
+  return ZlibDecompress(
+      [&](std::span<uint8_t> buffer, size_t &outlen, bela::error_code &ec_) -> bool {
+        outlen = static_cast<size_t>((std::min)(remaining, static_cast<uint64_t>(buffer.size())));
+        if (outlen == 0) {
+          return true;
+        }
+        if (!readAt(buffer.subspan(0, outlen), offset, ec_)) {
+          return false;
+        }
+        offset += outlen;
+        remaining -= outlen;
+        return true;
+      },
+      w, ec);
+}
+
+bool File::sectionData(const Section &sec, bela::Buffer &buffer, bela::error_code &ec) const {
+  if (sec.Type == SHT_NOBITS) {
+    buffer.size() = 0;
+    return true;
+  }
+  if ((sec.Flags & SHF_COMPRESSED) == 0) {
+    if (bela::narrow_cast<int64_t>(sec.Offset + sec.Size) > size) {
+      ec = bela::make_error_code(bela::ErrFileTooSmall, L"corrupted ELF file, section overflow file: ", size,
+                                 L" section end: ", sec.Offset + sec.Size);
+      return false;
+    }
+    buffer.grow(static_cast<size_t>(sec.Size));
+    return readAt(buffer, static_cast<size_t>(sec.Size), sec.Offset, ec);
+  }
+  // ch_size comes from the file, it only bounds the output. the buffer grows with the data that actually arrives, a
+  // crafted ch_size cannot make us allocate much more than the decompressed bytes
+  auto capacity = static_cast<size_t>(sec.Size);
+  buffer.size() = 0;
+  buffer.grow((std::min)(capacity, size_t{256 * 1024}));
+  auto overflow = false;
+  if (!SectionStream(
+          sec,
+          [&](const void *data, size_t len) -> bool {
+            if (buffer.size() + len > capacity) {
+              overflow = true;
+              return false;
+            }
+            if (buffer.size() + len > buffer.capacity()) {
+              buffer.grow((std::min)(capacity, (std::max)(buffer.size() + len, buffer.capacity() * 2)));
+            }
+            memcpy(buffer.data() + buffer.size(), data, len);
+            buffer.size() += len;
+            return true;
+          },
+          ec)) {
+    if (overflow) {
+      ec = bela::make_error_code(ErrGeneral, L"section '", bela::encode_into<char, wchar_t>(sec.Name),
+                                 L"' decompressed data larger than ch_size ", sec.Size);
+    }
+    return false;
+  }
+  if (buffer.size() != capacity) {
+    ec = bela::make_error_code(ErrGeneral, L"section '", bela::encode_into<char, wchar_t>(sec.Name),
+                               L"' decompressed size ", buffer.size(), L" does not match ch_size ", sec.Size);
+    return false;
+  }
+  return true;
+}
+
+void File::SetCacheLimit(size_t limit) {
+  cacheLimit = limit;
+  if (cacheLimit == 0) {
+    return;
+  }
+  size_t i = 0;
+  for (; i < cacheOrder.size() && cacheBytes > cacheLimit; i++) {
+    auto &v = sectionCache[cacheOrder[i]];
+    cacheBytes -= v->size();
+    v.reset();
+  }
+  cacheOrder.erase(cacheOrder.begin(), cacheOrder.begin() + i);
+}
+
+bool File::cachedSection(const Section &sec, SectionBytes &view, bela::error_code &ec) const {
+  // only sections owned by this File are cached, copies of Section are read directly
+  auto cacheable = !std::less<>{}(&sec, sections.data()) && std::less<>{}(&sec, sections.data() + sections.size());
+  auto index = cacheable ? static_cast<size_t>(&sec - sections.data()) : 0;
+  if (cacheable && index < sectionCache.size() && sectionCache[index]) {
+    view = sectionCache[index];
+    return true;
+  }
+  bela::Buffer buffer;
+  if (!sectionData(sec, buffer, ec)) {
+    return false;
+  }
+  view = std::make_shared<const bela::Buffer>(std::move(buffer));
+  if (!cacheable || (cacheLimit != 0 && view->size() > cacheLimit)) {
+    return true;
+  }
+  // evict oldest sections until the new one fits
+  size_t i = 0;
+  for (; cacheLimit != 0 && i < cacheOrder.size() && cacheBytes + view->size() > cacheLimit; i++) {
+    auto &v = sectionCache[cacheOrder[i]];
+    cacheBytes -= v->size();
+    v.reset();
+  }
+  cacheOrder.erase(cacheOrder.begin(), cacheOrder.begin() + i);
+  if (sectionCache.size() < sections.size()) {
+    sectionCache.resize(sections.size());
+  }
+  sectionCache[index] = view;
+  cacheOrder.emplace_back(index);
+  cacheBytes += view->size();
+  return true;
+}
+
+} // namespace hazel::elf
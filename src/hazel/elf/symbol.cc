@@ -6,16 +6,17 @@ namespace hazel::elf {
 constexpr size_t Sym64Size = sizeof(Elf64_Sym);
 constexpr size_t Sym32Size = sizeof(Elf32_Sym);
 
-bool File::getSymbols32(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &strdata, bela::error_code &ec) const {
+bool File::getSymbols32(uint32_t st, std::vector<Symbol> &syms, SectionBytes &strdata, bela::error_code &ec) const {
   auto symSec = SectionByType(st);
   if (symSec == nullptr) {
     ec = bela::make_error_code(L"no symbol section");
     return false;
   }
-  bela::Buffer buffer;
-  if (!sectionData(*symSec, buffer, ec)) {
+  SectionBytes symdata;
+  if (!cachedSection(*symSec, symdata, ec)) {
     return false;
   }
+  const auto &buffer = *symdata;
   if (buffer.size() % Sym32Size != 0) {
     ec = bela::make_error_code(L"length of symbol section is not a multiple of SymSize");
     return false;
@@ -23,7 +24,7 @@ bool File::getSymbols32(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &st
   if (!stringTable(symSec->Link, strdata, ec)) {
     return false;
   }
-  auto bv = strdata.as_bytes_view();
+  auto bv = strdata->as_bytes_view();
   auto bsv = buffer.as_bytes_view();
   if (bsv.size() > Sym32Size) {
     bsv.remove_prefix(Sym32Size);
@@ -35,22 +36,24 @@ bool File::getSymbols32(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &st
     symbol.Name = bv.make_cstring_view(endian_cast(sym->st_name));
     symbol.Info = endian_cast(sym->st_info);
     symbol.Other = endian_cast(sym->st_other);
-    symbol.Value = endian_cast(sym->st_shndx);
+    symbol.SectionIndex = static_cast<int>(endian_cast(sym->st_shndx));
+    symbol.Value = endian_cast(sym->st_value);
     symbol.Size = endian_cast(sym->st_size);
   }
   return true;
 }
 
-bool File::getSymbols64(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &strdata, bela::error_code &ec) const {
+bool File::getSymbols64(uint32_t st, std::vector<Symbol> &syms, SectionBytes &strdata, bela::error_code &ec) const {
   auto symSec = SectionByType(st);
   if (symSec == nullptr) {
     ec = bela::make_error_code(L"no symbol section");
     return false;
   }
-  bela::Buffer buffer;
-  if (!sectionData(*symSec, buffer, ec)) {
+  SectionBytes symdata;
+  if (!cachedSection(*symSec, symdata, ec)) {
     return false;
   }
+  const auto &buffer = *symdata;
   if (buffer.size() % Sym64Size != 0) {
     ec = bela::make_error_code(L"length of symbol section is not a multiple of SymSize");
     return false;
@@ -58,20 +61,20 @@ bool File::getSymbols64(uint32_t st, std::vector<Symbol> &syms, bela::Buffer &st
   if (!stringTable(symSec->Link, strdata, ec)) {
     return false;
   }
-  auto bv = strdata.as_bytes_view();
+  auto bv = strdata->as_bytes_view();
   auto bsv = buffer.as_bytes_view();
-  std::string_view symtab{reinterpret_cast<const char *>(buffer.data()), buffer.size()};
-  if (symtab.size() > Sym64Size) {
-    symtab.remove_prefix(Sym64Size);
+  if (bsv.size() > Sym64Size) {
+    bsv.remove_prefix(Sym64Size);
   }
-  syms.resize(symtab.size() / Sym64Size);
+  syms.resize(bsv.size() / Sym64Size);
   for (auto &symbol : syms) {
     auto sym = bsv.unchecked_cast<Elf64_Sym>();
     bsv.remove_prefix(Sym64Size);
     symbol.Name = bv.make_cstring_view(endian_cast(sym->st_name));
     symbol.Info = endian_cast(sym->st_info);
     symbol.Other = endian_cast(sym->st_other);
-    symbol.Value = endian_cast(sym->st_shndx);
+    symbol.SectionIndex = static_cast<int>(endian_cast(sym->st_shndx));
+    symbol.Value = endian_cast(sym->st_value);
     symbol.Size = endian_cast(sym->st_size);
   }
   return true;
@@ -0,0 +1,181 @@
+///
+#include <hazel/macho.hpp>
+#include <algorithm>
+
+namespace hazel::macho {
+// https://github.com/apple-oss-distributions/dyld/blob/main/common/MachOLoaded.cpp trieWalk
+namespace {
+inline bool readUleb128(std::string_view trie, size_t &pos, uint64_t &value) {
+  value = 0;
+  for (uint32_t shift = 0; pos < trie.size(); shift += 7) {
+    auto b = static_cast<uint8_t>(trie[pos++]);
+    if (shift >= 64) {
+      return false;
+    }
+    value |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool readCString(std::string_view trie, size_t &pos, std::string_view &s) {
+  auto end = trie.find('\0', pos);
+  if (end == std::string_view::npos) {
+    return false;
+  }
+  s = trie.substr(pos, end - pos);
+  pos = end + 1;
+  return true;
+}
+
+// decodeTerminal decode terminal info of node, terminalSize == 0 means not terminal
+bool decodeTerminal(std::string_view trie, size_t node, ExportInfo &info, size_t &children, bool &terminal) {
+  auto pos = node;
+  uint64_t terminalSize = 0;
+  if (!readUleb128(trie, pos, terminalSize) || terminalSize > trie.size() - pos) {
+    return false;
+  }
+  children = pos + static_cast<size_t>(terminalSize);
+  terminal = terminalSize != 0;
+  if (!terminal) {
+    return true;
+  }
+  info = ExportInfo{};
+  if (!readUleb128(trie, pos, info.Flags)) {
+    return false;
+  }
+  if ((info.Flags & EXPORT_SYMBOL_FLAGS_REEXPORT) != 0) {
+    return readUleb128(trie, pos, info.Other) && readCString(trie, pos, info.ImportName);
+  }
+  if (!readUleb128(trie, pos, info.Address)) {
+    return false;
+  }
+  if ((info.Flags & EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER) != 0) {
+    return readUleb128(trie, pos, info.Other);
+  }
+  return true;
+}
+} // namespace
+
+bool File::loadExportTrie(uint32_t off, uint32_t len, bela::error_code &ec) {
+  if (len == 0) {
+    return true;
+  }
+  // LC_DYLD_INFO_ONLY and LC_DYLD_EXPORTS_TRIE never coexist, keep the first one
+  if (!exportTrie.empty()) {
+    return true;
+  }
+  return viewAt(off, len, exportHolder, exportTrie, ec);
+}
+
+bool File::LookupExport(std::string_view name, ExportInfo &info, bela::error_code &ec) const {
+  if (exportTrie.empty()) {
+    ec = bela::make_error_code(ErrGeneral, L"missing export trie");
+    return false;
+  }
+  auto trie = exportTrie;
+  size_t node = 0;
+  // every edge consumes at least one byte of name, so a valid walk takes at most len(name) + 1 steps
+  for (size_t steps = 0, limit = name.size(); steps <= limit; steps++) {
+    size_t children = 0;
+    bool terminal = false;
+    ExportInfo ei;
+    if (!decodeTerminal(trie, node, ei, children, terminal)) {
+      ec = bela::make_error_code(ErrGeneral, L"malformed export trie node at ", node);
+      return false;
+    }
+    if (name.empty()) {
+      if (!terminal) {
+        break;
+      }
+      info = ei;
+      return true;
+    }
+    if (children >= trie.size()) {
+      break;
+    }
+    auto pos = children;
+    auto childCount = static_cast<uint8_t>(trie[pos++]);
+    auto matched = false;
+    for (uint8_t i = 0; i < childCount; i++) {
+      std::string_view edge;
+      uint64_t childOffset = 0;
+      if (!readCString(trie, pos, edge) || !readUleb128(trie, pos, childOffset) || edge.empty() ||
+          childOffset >= trie.size()) {
+        ec = bela::make_error_code(ErrGeneral, L"malformed export trie edge at ", pos);
+        return false;
+      }
+      if (name.starts_with(edge)) {
+        name.remove_prefix(edge.size());
+        node = static_cast<size_t>(childOffset);
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) {
+      break;
+    }
+  }
+  ec = bela::make_error_code(ErrGeneral, L"export symbol not found");
+  return false;
+}
+
+bool File::Exports(const ExportWalker &walker, bela::error_code &ec) const {
+  if (exportTrie.empty()) {
+    return true;
+  }
+  auto trie = exportTrie;
+  // depth first with one reused name buffer, a frame keeps the parent name length and a view of its edge. siblings only
+  // rewrite the buffer after the parent name, so the parent prefix is still intact when a frame is popped
+  struct frame {
+    size_t node;
+    size_t prefix;
+    std::string_view edge;
+  };
+  std::string name;
+  std::vector<frame> stack{{0, 0, {}}};
+  // a node occupies at least two bytes, more visits than trie size means the trie has a cycle
+  size_t budget = trie.size();
+  while (!stack.empty()) {
+    auto f = stack.back();
+    stack.pop_back();
+    if (budget-- == 0) {
+      ec = bela::make_error_code(ErrGeneral, L"export trie has a cycle");
+      return false;
+    }
+    name.resize(f.prefix);
+    name.append(f.edge);
+    size_t children = 0;
+    bool terminal = false;
+    ExportInfo info;
+    if (!decodeTerminal(trie, f.node, info, children, terminal)) {
+      ec = bela::make_error_code(ErrGeneral, L"malformed export trie node at ", f.node);
+      return false;
+    }
+    if (terminal && !walker(name, info)) {
+      return true;
+    }
+    if (children >= trie.size()) {
+      continue;
+    }
+    auto pos = children;
+    auto childCount = static_cast<uint8_t>(trie[pos++]);
+    auto first = stack.size();
+    for (uint8_t i = 0; i < childCount; i++) {
+      std::string_view edge;
+      uint64_t childOffset = 0;
+      if (!readCString(trie, pos, edge) || !readUleb128(trie, pos, childOffset) || childOffset >= trie.size()) {
+        ec = bela::make_error_code(ErrGeneral, L"malformed export trie edge at ", pos);
+        return false;
+      }
+      stack.emplace_back(frame{static_cast<size_t>(childOffset), name.size(), edge});
+    }
+    // visit children in trie order
+    std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(first), stack.end());
+  }
+  return true;
+}
+
+} // namespace hazel::macho
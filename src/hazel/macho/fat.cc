@@ -1,9 +1,11 @@
 ///
 #include <hazel/macho.hpp>
+#include <exception>
+#include <thread>
 
 namespace hazel::macho {
 
-bool FatFile::NewFile(std::wstring_view p, bela::error_code &ec) {
+bool FatFile::NewFile(std::wstring_view p, bela::error_code &ec, bool parallel) {
   if (fd) {
     ec = bela::make_error_code(L"The file has been opened, the function cannot be called repeatedly");
     return false;
@@ -13,22 +15,27 @@ bool FatFile::NewFile(std::wstring_view p, bela::error_code &ec) {
     return false;
   }
   fd.Assgin(std::move(*fd_));
-  return parseFile(ec);
+  return parseFile(parallel, ec);
 }
 
-bool FatFile::NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec) {
+bool FatFile::NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec, bool parallel) {
   if (fd) {
     ec = bela::make_error_code(L"The file has been opened, the function cannot be called repeatedly");
     return false;
   }
   fd.Assgin(fd_, false);
   size = sz;
-  return parseFile(ec);
+  return parseFile(parallel, ec);
 }
 
 //
-bool FatFile::parseFile(bela::error_code &ec) {
-  uint8_t ident[4] = {0};
+bool FatFile::parseFile(bool parallel, bela::error_code &ec) {
+  if (size == bela::SizeUnInitialized) {
+    if (size = fd.Size(ec); size == bela::SizeUnInitialized) {
+      return false;
+    }
+  }
+  uint8_t ident[8] = {0};
   if (!fd.ReadAt(ident, 0, ec)) {
     return false;
   }
@@ -45,35 +52,32 @@ bool FatFile::parseFile(bela::error_code &ec) {
                                static_cast<int>(ident[3]), L"']");
     return false;
   }
-  auto offset = 4LL;
-  uint32_t narch{0};
-  if (!fd.ReadFull(narch, ec)) {
-    return false;
-  }
-  narch = bela::frombe(narch);
-  uint32_t mt{0};
-  offset += 4;
+  auto narch = bela::cast_frombe<uint32_t>(ident + 4);
   if (narch < 1) {
     ec = bela::make_error_code(L"file contains no images");
     return false;
   }
+  // fat_arch headers must be inside the file, don't trust narch for allocation
+  if (static_cast<uint64_t>(narch) * sizeof(fat_arch) > static_cast<uint64_t>(size - 8)) {
+    ec = bela::make_error_code(ErrGeneral, L"invalid fat_arch count ", narch);
+    return false;
+  }
+  std::vector<fat_arch> fas(narch);
+  if (!fd.ReadAt(fas, 8, ec)) {
+    ec = bela::make_error_code(ec.code, L"invalid fat_arch header: ", ec.message);
+    return false;
+  }
   bela::flat_hash_map<uint64_t, bool> seenArches;
   arches.resize(narch);
   for (uint32_t i = 0; i < narch; i++) {
-    auto p = &arches[i];
-    fat_arch fa;
-    if (fd.ReadFull(fa, ec)) {
-      ec = bela::make_error_code(ec.code, L"invalid fat_arch header: ", ec.message);
-      return false;
-    }
+    auto &fa = fas[i];
     fa.align = bela::frombe(fa.align);
     fa.cpusubtype = bela::frombe(fa.cpusubtype);
     fa.cputype = bela::frombe(fa.cputype);
     fa.offset = bela::frombe(fa.offset);
     fa.size = bela::frombe(fa.size);
-    offset += sizeof(fa);
-    p->file.baseOffset = fa.offset;
-    if (!p->file.NewFile(fd.NativeFD(), p->file.size, ec)) {
+    if (static_cast<int64_t>(fa.offset) + static_cast<int64_t>(fa.size) > size) {
+      ec = bela::make_error_code(bela::ErrFileTooSmall, L"architecture #", i, L" overflow file size ", size);
       return false;
     }
     auto seenArch = (static_cast<uint64_t>(fa.cputype) << 32) | static_cast<uint64_t>(fa.cpusubtype);
@@ -83,12 +87,21 @@ bool FatFile::parseFile(bela::error_code &ec) {
       return false;
     }
     seenArches[seenArch] = true;
-    auto machoType = p->file.fh.Type;
-    if (i == 0) {
-      mt = machoType;
-      continue;
-    }
-    if (machoType != mt) {
+    auto p = &arches[i];
+    p->fh.Cpu = fa.cputype;
+    p->fh.SubCpu = fa.cpusubtype;
+    p->fh.Offset = fa.offset;
+    p->fh.Size = fa.size;
+    p->fh.Align = fa.align;
+    p->file.baseOffset = fa.offset;
+    p->file.size = fa.size;
+  }
+  if (!parseArches(parallel, ec)) {
+    return false;
+  }
+  auto mt = arches.front().file.fh.Type;
+  for (size_t i = 1; i < arches.size(); i++) {
+    if (auto machoType = arches[i].file.fh.Type; machoType != mt) {
       ec = bela::make_error_code(ErrGeneral, L"Mach-O type for architecture #", i, L" (type=#", bela::Hex(machoType),
                                  L") does not match first (type=#", bela::Hex(mt), L")");
       return false;
@@ -97,4 +110,64 @@ bool FatFile::parseFile(bela::error_code &ec) {
   return true;
 }
 
-} // namespace hazel::macho
\ No newline at end of file
+bool FatFile::parseArches(bool parallel, bela::error_code &ec) {
+  if (!parallel || arches.size() == 1) {
+    for (auto &a : arches) {
+      a.file.fd.Assgin(fd.NativeFD(), false);
+      if (!a.file.parseFile(ec)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // FD::ReadAt is Seek + ReadFile and cannot be shared across threads, map once and let every slice read the mapping
+  auto view = std::make_shared<bela::io::MemView>();
+  if (!view->Map(fd.NativeFD(), size, ec)) {
+    return false;
+  }
+  mv = view;
+  std::vector<bela::error_code> errors(arches.size());
+  // exceptions of a slice are kept and rethrown on the caller after join
+  std::vector<std::exception_ptr> failures(arches.size());
+  auto parse = [&](size_t i) {
+    try {
+      arches[i].file.parseFile(errors[i]);
+    } catch (...) {
+      failures[i] = std::current_exception();
+    }
+  };
+  for (auto &a : arches) {
+    a.file.mv = mv;
+  }
+  std::vector<std::thread> workers;
+  size_t launched = 1;
+  try {
+    workers.reserve(arches.size() - 1);
+    for (; launched < arches.size(); launched++) {
+      workers.emplace_back(parse, launched);
+    }
+  } catch (...) {
+    // no more threads, the caller parses the remaining slices
+  }
+  parse(0);
+  for (auto i = launched; i < arches.size(); i++) {
+    parse(i);
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  for (auto &f : failures) {
+    if (f) {
+      std::rethrow_exception(f);
+    }
+  }
+  for (auto &e : errors) {
+    if (e) {
+      ec = std::move(e);
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace hazel::macho
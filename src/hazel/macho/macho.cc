@@ -18,16 +18,46 @@ bool File::NewFile(HANDLE fd_, int64_t sz, bela::error_code &ec) {
   return parseFile(ec);
 }
 
+bool File::readAt(std::span<uint8_t> buffer, int64_t pos, bela::error_code &ec) const {
+  if (pos < 0 || pos > size || static_cast<int64_t>(buffer.size()) > size - pos) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"macho: read ", buffer.size(), L" bytes at ", pos,
+                               L" overflow file size ", size);
+    return false;
+  }
+  if (mv) {
+    return mv->ReadAt(buffer, baseOffset + pos, ec);
+  }
+  return fd.ReadAt(buffer, baseOffset + pos, ec);
+}
+
+bool File::viewAt(int64_t pos, size_t len, bela::Buffer &holder, std::string_view &sv, bela::error_code &ec) const {
+  if (pos < 0 || pos > size || static_cast<int64_t>(len) > size - pos) {
+    ec = bela::make_error_code(bela::ErrFileTooSmall, L"macho: read ", len, L" bytes at ", pos,
+                               L" overflow file size ", size);
+    return false;
+  }
+  if (mv) {
+    sv = std::string_view{reinterpret_cast<const char *>(mv->data()) + baseOffset + pos, len};
+    return true;
+  }
+  holder.grow(len);
+  if (!fd.ReadAt(holder, len, baseOffset + pos, ec)) {
+    return false;
+  }
+  sv = std::string_view{reinterpret_cast<const char *>(holder.data()), len};
+  return true;
+}
+
 bool File::readFileHeader(int64_t &offset, bela::error_code &ec) {
   uint8_t ident[4] = {0};
-  if (!fd.ReadAt(ident, 0, ec)) {
+  if (!readAt(ident, 0, ec)) {
     return false;
   }
   auto le = bela::cast_fromle<uint32_t>(ident);
   if (le == MH_MAGIC) {
     en = std::endian::little;
     mach_header mh;
-    if (!fd.ReadAt(mh, 0, ec)) {
+    if (!readAt(mh, 0, ec)) {
       return false;
     }
     offset = sizeof(mach_header);
@@ -43,7 +73,7 @@ bool File::readFileHeader(int64_t &offset, bela::error_code &ec) {
   if (le == MH_MAGIC_64) {
     en = std::endian::little;
     mach_header_64 mh;
-    if (!fd.ReadAt(mh, 0, ec)) {
+    if (!readAt(mh, 0, ec)) {
       return false;
     }
     offset = sizeof(mach_header_64);
@@ -57,11 +87,11 @@ bool File::readFileHeader(int64_t &offset, bela::error_code &ec) {
     return true;
   }
 
-  auto be = bela::cast_fromle<uint32_t>(ident);
+  auto be = bela::cast_frombe<uint32_t>(ident);
   if (be == MH_MAGIC) {
     en = std::endian::big;
     mach_header mh;
-    if (!fd.ReadAt(mh, 0, ec)) {
+    if (!readAt(mh, 0, ec)) {
       return false;
     }
     offset = sizeof(mach_header);
@@ -77,7 +107,7 @@ bool File::readFileHeader(int64_t &offset, bela::error_code &ec) {
   if (be == MH_MAGIC_64) {
     en = std::endian::big;
     mach_header_64 mh;
-    if (!fd.ReadAt(mh, 0, ec)) {
+    if (!readAt(mh, 0, ec)) {
       return false;
     }
     offset = sizeof(mach_header_64);
@@ -159,11 +189,11 @@ bool File::parseSymtab(std::string_view symdat, std::string_view strtab, std::st
 // #pragma pack()
 bool File::pushSection(hazel::macho::Section *sh, bela::error_code &ec) {
   if (sh->Nreloc > 0) {
-    bela::Buffer reldat(sh->Nreloc * 8);
-    if (!fd.ReadAt(reldat, sh->Nreloc * 8, sh->Reloff, ec)) {
+    bela::Buffer reldat;
+    std::string_view b;
+    if (!viewAt(sh->Reloff, static_cast<size_t>(sh->Nreloc) * 8, reldat, b, ec)) {
       return false;
     }
-    std::string_view b{reinterpret_cast<const char *>(reldat.data()), reldat.size()};
     sh->Relocs.resize(sh->Nreloc);
     for (uint32_t i = 0; i < sh->Nreloc; i++) {
       auto &rel = (sh->Relocs[i]);
@@ -215,11 +245,11 @@ bool File::parseFile(bela::error_code &ec) {
     return false;
   }
   is64bit = (fh.Magic == Magic64);
-  bela::Buffer buffer(fh.Cmdsz);
-  if (!fd.ReadAt(buffer, fh.Cmdsz, offset, ec)) {
+  bela::Buffer buffer;
+  std::string_view dat;
+  if (!viewAt(offset, fh.Cmdsz, buffer, dat, ec)) {
     return false;
   }
-  std::string_view dat{reinterpret_cast<const char *>(buffer.data()), fh.Cmdsz};
   loads.resize(fh.Ncmd);
   for (auto &load : loads) {
     if (dat.size() < 8) {
@@ -284,21 +314,20 @@ bool File::parseFile(bela::error_code &ec) {
       hdr.Stroff = endian_cast(p->Stroff);
       hdr.Strsize = endian_cast(p->Strsize);
       hdr.Symoff = endian_cast(p->Symoff);
-      bela::Buffer strtab(hdr.Strsize);
-      if (!fd.ReadAt(strtab, hdr.Strsize, hdr.Stroff, ec)) {
+      bela::Buffer strtab;
+      std::string_view strtabsv;
+      if (!viewAt(hdr.Stroff, hdr.Strsize, strtab, strtabsv, ec)) {
         return false;
       }
-      auto symsz = 12;
+      size_t symsz = 12;
       if (fh.Magic == Magic64) {
         symsz = 16;
       }
-      auto symdatsz = hdr.Nsyms * symsz;
-      bela::Buffer symdat(symdatsz);
-      if (!fd.ReadAt(symdat, symdatsz, hdr.Symoff, ec)) {
+      bela::Buffer symdat;
+      std::string_view symdatsv;
+      if (!viewAt(hdr.Symoff, hdr.Nsyms * symsz, symdat, symdatsv, ec)) {
         return false;
       }
-      std::string_view symdatsv{reinterpret_cast<const char *>(symdat.data()), symdat.size()};
-      std::string_view strtabsv{reinterpret_cast<const char *>(strtab.data()), strtab.size()};
       if (!parseSymtab(symdatsv, strtabsv, cmddat, hdr, offset, ec)) {
         return false;
       }
@@ -330,7 +359,8 @@ bool File::parseFile(bela::error_code &ec) {
       dysymtab.Locreloff = endian_cast(p->Locreloff);
       dysymtab.Nlocrel = endian_cast(p->Nlocrel);
       dysymtab.IndirectSyms.resize(dysymtab.Nindirectsyms);
-      if (!fd.ReadAt(dysymtab.IndirectSyms, dysymtab.Indirectsymoff, ec)) {
+      if (!readAt({reinterpret_cast<uint8_t *>(dysymtab.IndirectSyms.data()), dysymtab.IndirectSyms.size() * 4},
+                  dysymtab.Indirectsymoff, ec)) {
         return false;
       }
       for (uint32_t j = 0; j < dysymtab.Nindirectsyms; j++) {
@@ -358,7 +388,8 @@ bool File::parseFile(bela::error_code &ec) {
       s->Nsect = endian_cast(p->Nsect);
       s->Flag = endian_cast(p->Flag);
       auto b = cmddat.substr(sizeof(Segment32));
-      sections.resize(s->Nsect);
+      auto first = sections.size();
+      sections.resize(first + s->Nsect);
       for (uint32_t k = 0; k < s->Nsect; k++) {
         if (b.size() < sizeof(Section32)) {
           ec = bela::make_error_code(L"invalid block in Section32 data");
@@ -366,7 +397,7 @@ bool File::parseFile(bela::error_code &ec) {
         }
         auto se = reinterpret_cast<const Section32 *>(b.data());
         b.remove_prefix(sizeof(Section32));
-        auto sh = &(sections[k]);
+        auto sh = &(sections[first + k]);
         sh->Name = bela::cstring_view(se->Name);
         sh->Seg = bela::cstring_view(se->Seg);
         sh->Addr = endian_cast(se->Addr);
@@ -402,7 +433,8 @@ bool File::parseFile(bela::error_code &ec) {
       s->Nsect = endian_cast(p->Nsect);
       s->Flag = endian_cast(p->Flag);
       auto b = cmddat.substr(sizeof(Segment64));
-      sections.resize(s->Nsect);
+      auto first = sections.size();
+      sections.resize(first + s->Nsect);
       for (uint32_t j = 0; j < s->Nsect; j++) {
         if (b.size() < sizeof(Section64)) {
           ec = bela::make_error_code(L"invalid block in Section64 data");
@@ -410,7 +442,7 @@ bool File::parseFile(bela::error_code &ec) {
         }
         auto se = reinterpret_cast<const Section64 *>(b.data());
         b.remove_prefix(sizeof(Section64));
-        auto sh = &(sections[j]);
+        auto sh = &(sections[first + j]);
         sh->Name = bela::cstring_view(se->Name);
         sh->Seg = bela::cstring_view(se->Seg);
         sh->Addr = endian_cast(se->Addr);
@@ -425,6 +457,30 @@ bool File::parseFile(bela::error_code &ec) {
         }
       }
     } break;
+    case LC_DYLD_INFO:
+      [[fallthrough]];
+    case LC_DYLD_INFO_ONLY: {
+      load.bytes = cmddat;
+      if (cmddat.size() < sizeof(dyld_info_command)) {
+        ec = bela::make_error_code(L"invalid block in dyld info command");
+        return false;
+      }
+      auto p = reinterpret_cast<const dyld_info_command *>(cmddat.data());
+      if (!loadExportTrie(endian_cast(p->export_off), endian_cast(p->export_size), ec)) {
+        return false;
+      }
+    } break;
+    case LC_DYLD_EXPORTS_TRIE: {
+      load.bytes = cmddat;
+      if (cmddat.size() < sizeof(linkedit_data_command)) {
+        ec = bela::make_error_code(L"invalid block in exports trie command");
+        return false;
+      }
+      auto p = reinterpret_cast<const linkedit_data_command *>(cmddat.data());
+      if (!loadExportTrie(endian_cast(p->dataoff), endian_cast(p->datasize), ec)) {
+        return false;
+      }
+    } break;
     default:
       load.bytes = cmddat;
       break;
@@ -0,0 +1,140 @@
+// hasher state round trip, corrupted states must be rejected before they reach the hash code
+#include <bela/terminal.hpp>
+#include <bela/hash.hpp>
+#include <random>
+
+namespace {
+// round trip a state taken after every split of several lengths
+template <typename Hasher, typename... Args> int roundTrip(const std::vector<uint8_t> &buf, Args... args) {
+  int failed = 0;
+  for (size_t n : {0, 1, 63, 64, 65, 1023, 1024, 1025, 4097, 5000, 70000}) {
+    for (size_t split : {size_t{0}, n / 2, n}) {
+      Hasher full;
+      full.Initialize(args...);
+      full.Update(buf.data(), n);
+      uint8_t want[64] = {0};
+      full.Finalize(want, sizeof(want));
+      Hasher h;
+      h.Initialize(args...);
+      h.Update(buf.data(), split);
+      auto state = h.MarshalBinary();
+      Hasher r;
+      bela::error_code ec;
+      if (!r.UnmarshalBinary(state, ec)) {
+        bela::FPrintF(stderr, L"length %d split %d: %s\n", n, split, ec);
+        failed++;
+        continue;
+      }
+      r.Update(buf.data() + split, n - split);
+      uint8_t got[64] = {0};
+      r.Finalize(got, sizeof(got));
+      if (memcmp(want, got, sizeof(want)) != 0) {
+        bela::FPrintF(stderr, L"length %d split %d: digest mismatch\n", n, split);
+        failed++;
+      }
+      state.pop_back();
+      if (Hasher t; t.UnmarshalBinary(state, ec)) {
+        bela::FPrintF(stderr, L"length %d split %d: truncated state accepted\n", n, split);
+        failed++;
+      }
+    }
+  }
+  return failed;
+}
+
+// blake3 state layout: header 4, key 32, cv 32, chunk_counter 8, blocks_compressed, flags, buf_len, buf, cv_stack_len
+constexpr size_t blake3CounterOffset = 4 + 32 + 32;
+constexpr size_t blake3BufLenOffset = blake3CounterOffset + 8 + 2;
+
+std::vector<uint8_t> blake3State(const std::vector<uint8_t> &buf, size_t n) {
+  bela::hash::blake3::Hasher h;
+  h.Initialize();
+  h.Update(buf.data(), n);
+  return h.MarshalBinary();
+}
+
+void setCounter(std::vector<uint8_t> &state, uint64_t counter) {
+  for (size_t i = 0; i < 8; i++) {
+    state[blake3CounterOffset + i] = static_cast<uint8_t>(counter >> (i * 8));
+  }
+}
+
+size_t stackLenOffset(const std::vector<uint8_t> &state) { return blake3BufLenOffset + 1 + state[blake3BufLenOffset]; }
+
+bool rejected(const std::vector<uint8_t> &state) {
+  bela::hash::blake3::Hasher h;
+  bela::error_code ec;
+  return !h.UnmarshalBinary(state, ec);
+}
+
+int corruptedBlake3(const std::vector<uint8_t> &buf) {
+  int failed = 0;
+  auto expect = [&](const wchar_t *name, const std::vector<uint8_t> &state) {
+    if (!rejected(state)) {
+      bela::FPrintF(stderr, L"blake3 %s: corrupted state accepted\n", name);
+      failed++;
+    }
+  };
+  // one stack entry but no chunk pushed: the next update merges below the stack
+  auto s = blake3State(buf, 100);
+  s[stackLenOffset(s)] = 1;
+  s.insert(s.end(), BLAKE3_OUT_LEN, 0);
+  expect(L"cv_stack_len 1, chunk_counter 0", s);
+  // a full stack and a counter that keeps it full: the next push overflows
+  s = blake3State(buf, 100);
+  setCounter(s, (uint64_t{1} << 55) - 1);
+  s[stackLenOffset(s)] = 55;
+  s.insert(s.end(), 55 * BLAKE3_OUT_LEN, 0);
+  expect(L"cv_stack_len 55, chunk_counter 2^55-1", s);
+  // stack and counter disagree
+  s = blake3State(buf, 5000);
+  setCounter(s, 7);
+  expect(L"cv_stack_len 2, chunk_counter 7", s);
+  // an empty chunk after pushed chunks: finalize reads two stack entries
+  s = blake3State(buf, 4096 + 100);
+  s[blake3BufLenOffset - 2] = 0;
+  s.erase(s.begin() + blake3BufLenOffset + 1, s.begin() + stackLenOffset(s));
+  s[blake3BufLenOffset] = 0;
+  expect(L"empty chunk, chunk_counter 4", s);
+  // every single byte change of the counter and stack length either decodes to a consistent state or is rejected,
+  // a consistent one must hash without touching memory outside the stack
+  for (size_t n : {size_t{100}, size_t{5000}, size_t{70000}}) {
+    auto base = blake3State(buf, n);
+    for (size_t i = blake3CounterOffset; i < blake3CounterOffset + 8; i++) {
+      for (int bit = 0; bit < 8; bit++) {
+        auto t = base;
+        t[i] ^= static_cast<uint8_t>(1 << bit);
+        bela::hash::blake3::Hasher h;
+        bela::error_code ec;
+        if (h.UnmarshalBinary(t, ec)) {
+          h.Update(buf.data(), 3000);
+          uint8_t out[32];
+          h.Finalize(out, sizeof(out));
+        }
+      }
+    }
+  }
+  return failed;
+}
+} // namespace
+
+int wmain() {
+  std::mt19937 r(47);
+  std::vector<uint8_t> buf(70000);
+  for (auto &b : buf) {
+    b = static_cast<uint8_t>(r());
+  }
+  using namespace bela::hash;
+  int failed = 0;
+  failed += roundTrip<sha256::Hasher>(buf, sha256::HashBits::SHA224);
+  failed += roundTrip<sha256::Hasher>(buf, sha256::HashBits::SHA256);
+  failed += roundTrip<sha512::Hasher>(buf, sha512::HashBits::SHA384);
+  failed += roundTrip<sha512::Hasher>(buf, sha512::HashBits::SHA512);
+  failed += roundTrip<sha3::Hasher>(buf, sha3::HashBits::SHA3224);
+  failed += roundTrip<sha3::Hasher>(buf, sha3::HashBits::SHA3512);
+  failed += roundTrip<sm3::Hasher>(buf);
+  failed += roundTrip<blake3::Hasher>(buf);
+  failed += corruptedBlake3(buf);
+  bela::FPrintF(stdout, L"hash state: %d failures\n", failed);
+  return failed == 0 ? 0 : 1;
+}
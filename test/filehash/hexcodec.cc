@@ -0,0 +1,104 @@
+// hex codec: encode/decode round trip across the vector and scalar paths, Checksum::Parse of narrow and wide strings
+#include <bela/terminal.hpp>
+#include <bela/hash.hpp>
+#include <algorithm>
+#include <random>
+
+namespace {
+template <typename CharT> int roundTrip(const std::vector<uint8_t> &buf) {
+  int failed = 0;
+  // 16-byte groups go through AVX2 when available, the rest through the table
+  for (size_t n = 0; n <= 80; n++) {
+    std::basic_string<CharT> s(n * 2, CharT('x'));
+    bela::hash::HexEncode(buf.data(), n, s.data());
+    std::vector<uint8_t> out(n);
+    if (!bela::hash::HexDecode(s.data(), n, out.data()) || !std::equal(out.begin(), out.end(), buf.begin())) {
+      bela::FPrintF(stderr, L"length %d: round trip mismatch (char size %d)\n", n, sizeof(CharT));
+      failed++;
+    }
+    // every other digit upper case
+    for (size_t i = 0; i < s.size(); i += 2) {
+      if (s[i] >= 'a' && s[i] <= 'f') {
+        s[i] = static_cast<CharT>(s[i] - 'a' + 'A');
+      }
+    }
+    if (!bela::hash::HexDecode(s.data(), n, out.data()) || !std::equal(out.begin(), out.end(), buf.begin())) {
+      bela::FPrintF(stderr, L"length %d: mixed case mismatch (char size %d)\n", n, sizeof(CharT));
+      failed++;
+    }
+  }
+  return failed;
+}
+
+// every position of a 40-byte value: the first 64 digits sit in two 16-byte groups, the last 16 after them
+template <typename CharT> int rejectAt(const std::vector<uint8_t> &buf, std::initializer_list<uint32_t> bad) {
+  constexpr size_t n = 40;
+  int failed = 0;
+  std::basic_string<CharT> s(n * 2, CharT('0'));
+  bela::hash::HexEncode(buf.data(), n, s.data());
+  for (size_t i = 0; i < s.size(); i++) {
+    for (auto b : bad) {
+      auto t = s;
+      t[i] = static_cast<CharT>(b);
+      uint8_t out[n];
+      if (bela::hash::HexDecode(t.data(), n, out)) {
+        bela::FPrintF(stderr, L"digit U+%04X at %d accepted (char size %d)\n", b, i, sizeof(CharT));
+        failed++;
+      }
+    }
+  }
+  return failed;
+}
+
+int checksum(const std::vector<uint8_t> &buf) {
+  int failed = 0;
+  bela::hash::sha256::Hasher h;
+  h.Initialize();
+  h.Update(buf.data(), buf.size());
+  auto sum = bela::hash::Sum<32>(h);
+  auto narrow = sum.Hex();
+  auto wide = sum.Hex<wchar_t>();
+  bela::hash::SHA256Checksum a;
+  bela::hash::SHA256Checksum b;
+  if (!bela::hash::SHA256Checksum::Parse(narrow, a) || a != sum) {
+    bela::FPrintF(stderr, L"Parse(std::string) %s failed\n", narrow);
+    failed++;
+  }
+  if (!bela::hash::SHA256Checksum::Parse(wide, b) || b != sum) {
+    bela::FPrintF(stderr, L"Parse(std::wstring) %s failed\n", wide);
+    failed++;
+  }
+  bela::hash::SHA256Checksum empty;
+  constexpr auto emptyHex = "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855";
+  if (!bela::hash::SHA256Checksum::Parse(emptyHex, empty) ||
+      empty.Hex<wchar_t>() != L"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855") {
+    bela::FPrintF(stderr, L"Parse(literal) %s failed\n", emptyHex);
+    failed++;
+  }
+  if (bela::hash::SHA256Checksum::Parse(narrow.substr(1), a) || bela::hash::SHA256Checksum::Parse(wide + L"0", b)) {
+    bela::FPrintF(stderr, L"Parse accepted a digest of the wrong length\n");
+    failed++;
+  }
+  return failed;
+}
+} // namespace
+
+int wmain() {
+  std::vector<uint8_t> buf(1024);
+  std::mt19937 gen(1337);
+  for (auto &b : buf) {
+    b = static_cast<uint8_t>(gen());
+  }
+  int failed = roundTrip<char>(buf) + roundTrip<wchar_t>(buf);
+  // neighbours of the digit ranges
+  failed += rejectAt<char>(buf, {'/', ':', '@', 'G', '`', 'g', ' ', 0, 0x80, 0xB0, 0xE1});
+  // outside Latin-1 with a hex digit in the low byte, and the saturation edges of the narrowing pack
+  failed += rejectAt<wchar_t>(buf, {'g', 0x0130, 0x0161, 0x0441, 0x3030, 0x8030, 0xFF10, 0xFF41, 0xFFFF, 0x00B0});
+  failed += checksum(buf);
+  if (failed != 0) {
+    bela::FPrintF(stderr, L"hex: %d checks failed\n", failed);
+    return 1;
+  }
+  bela::FPrintF(stdout, L"hex: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,58 @@
+// flip every byte of Bao slices, SliceDecoder must reject each of them
+#include <bela/terminal.hpp>
+#include <bela/hashtree.hpp>
+#include <random>
+
+namespace {
+bool decodeSlice(const uint8_t root[bela::hash::blake3::tree_hash_size], uint64_t start, uint64_t len,
+                 const std::vector<uint8_t> &slice, std::vector<uint8_t> &out) {
+  bela::hash::blake3::SliceDecoder decoder(root, start, len);
+  bela::error_code ec;
+  out.clear();
+  return decoder.Write(slice.data(), slice.size(), out, ec) && decoder.Finish(ec);
+}
+
+int tamperSlices(std::span<const uint8_t> content, uint64_t start, uint64_t len) {
+  std::vector<uint8_t> outboard;
+  uint8_t root[bela::hash::blake3::tree_hash_size];
+  bela::hash::blake3::EncodeOutboard(content, outboard, root);
+  std::vector<uint8_t> slice;
+  bela::error_code ec;
+  if (!bela::hash::blake3::ExtractSlice(content, outboard, start, len, slice, ec)) {
+    bela::FPrintF(stderr, L"extract slice %d+%d: %s\n", start, len, ec);
+    return 1;
+  }
+  std::vector<uint8_t> out;
+  if (!decodeSlice(root, start, len, slice, out)) {
+    bela::FPrintF(stderr, L"slice %d+%d of %d bytes rejected\n", start, len, content.size());
+    return 1;
+  }
+  int accepted = 0;
+  for (size_t i = 0; i < slice.size(); i++) {
+    slice[i] ^= 0x01;
+    if (decodeSlice(root, start, len, slice, out)) {
+      bela::FPrintF(stderr, L"slice %d+%d: flipped byte %d accepted\n", start, len, i);
+      accepted++;
+    }
+    slice[i] ^= 0x01;
+  }
+  bela::FPrintF(stdout, L"slice %d+%d of %d bytes: %d bytes flipped, %d accepted\n", start, len, content.size(),
+                slice.size(), accepted);
+  return accepted;
+}
+} // namespace
+
+int wmain() {
+  std::mt19937 r(49);
+  // 66 chunks: a full 64-chunk subtree on the left, a partial chunk at the end
+  std::vector<uint8_t> content(66 * 1024 + 300);
+  for (auto &b : content) {
+    b = static_cast<uint8_t>(r());
+  }
+  int failed = 0;
+  failed += tamperSlices(content, 0, content.size());
+  failed += tamperSlices(content, 5000, 40000);
+  failed += tamperSlices(content, 65 * 1024 + 10, 100);
+  failed += tamperSlices({content.data(), 3000}, 0, 3000);
+  return failed == 0 ? 0 : 1;
+}
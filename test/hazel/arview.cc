@@ -0,0 +1,278 @@
+// ar reader: list archives given on the command line, without arguments check the symbol table flavours on archives
+// built in memory
+#include <hazel/ar.hpp>
+#include <bela/terminal.hpp>
+#include <bela/str_cat.hpp>
+#include <algorithm>
+
+namespace {
+struct object {
+  std::string name;
+  std::string data;
+  std::vector<std::string> symbols;
+};
+
+std::wstring_view FormatName(hazel::ar::SymbolFormat f) {
+  switch (f) {
+  case hazel::ar::SymbolFormat::GNU:
+    return L"GNU";
+  case hazel::ar::SymbolFormat::GNU64:
+    return L"GNU64";
+  case hazel::ar::SymbolFormat::BSD:
+    return L"BSD";
+  case hazel::ar::SymbolFormat::BSD64:
+    return L"BSD64";
+  case hazel::ar::SymbolFormat::COFF:
+    return L"COFF";
+  default:
+    break;
+  }
+  return L"None";
+}
+
+template <typename T> void putbe(std::string &s, T v) {
+  for (size_t i = sizeof(T); i > 0; i--) {
+    s.push_back(static_cast<char>(v >> ((i - 1) * 8)));
+  }
+}
+
+template <typename T> void putle(std::string &s, T v) {
+  for (size_t i = 0; i < sizeof(T); i++) {
+    s.push_back(static_cast<char>(v >> (i * 8)));
+  }
+}
+
+std::string field(std::string_view v, size_t width) {
+  std::string s(v);
+  s.resize(width, ' ');
+  return s;
+}
+
+// member append header and data, BSD long names (#1/N) are stored in front of data
+void member(std::string &out, std::string_view name, std::string_view data, std::string_view bsdName = {}) {
+  out += field(name, 16);
+  out += field("0", 12);
+  out += field("0", 6);
+  out += field("0", 6);
+  out += field("644", 8);
+  out += field(std::to_string(bsdName.size() + data.size()), 10);
+  out += "`\n";
+  out += bsdName;
+  out += data;
+  if (out.size() % 2 != 0) {
+    out += '\n';
+  }
+}
+
+// buildArchive lay out symbol tables, long name table and members of one flavour. symbol tables hold member header
+// offsets, so the archive is built twice: the first pass only measures
+std::string buildArchive(hazel::ar::SymbolFormat f, const std::vector<object> &objects) {
+  using hazel::ar::SymbolFormat;
+  std::vector<std::pair<std::string, size_t>> syms; // symbol, object index
+  for (size_t i = 0; i < objects.size(); i++) {
+    for (const auto &s : objects[i].symbols) {
+      syms.emplace_back(s, i);
+    }
+  }
+  std::vector<uint64_t> offsets(objects.size(), 0);
+  std::string out;
+  for (int pass = 0; pass < 2; pass++) {
+    out = "!<arch>\n";
+    std::string names;
+    for (const auto &[s, _] : syms) {
+      names += s;
+      names += '\0';
+    }
+    switch (f) {
+    case SymbolFormat::GNU:
+    case SymbolFormat::COFF: {
+      std::string data;
+      putbe(data, static_cast<uint32_t>(syms.size()));
+      for (const auto &[_, i] : syms) {
+        putbe(data, static_cast<uint32_t>(offsets[i]));
+      }
+      member(out, "/", data + names);
+      if (f == SymbolFormat::GNU) {
+        break;
+      }
+      // second linker member: little endian, names sorted, 1-based member indexes
+      auto sorted = syms;
+      std::sort(sorted.begin(), sorted.end());
+      std::string second;
+      putle(second, static_cast<uint32_t>(objects.size()));
+      for (auto o : offsets) {
+        putle(second, static_cast<uint32_t>(o));
+      }
+      putle(second, static_cast<uint32_t>(sorted.size()));
+      for (const auto &[_, i] : sorted) {
+        putle(second, static_cast<uint16_t>(i + 1));
+      }
+      for (const auto &[s, _] : sorted) {
+        second += s;
+        second += '\0';
+      }
+      member(out, "/", second);
+    } break;
+    case SymbolFormat::GNU64: {
+      std::string data;
+      putbe(data, static_cast<uint64_t>(syms.size()));
+      for (const auto &[_, i] : syms) {
+        putbe(data, offsets[i]);
+      }
+      member(out, "/SYM64/", data + names);
+    } break;
+    case SymbolFormat::BSD:
+    case SymbolFormat::BSD64: {
+      auto is64 = f == SymbolFormat::BSD64;
+      auto word = [&](std::string &s, uint64_t v) {
+        if (is64) {
+          putle(s, v);
+          return;
+        }
+        putle(s, static_cast<uint32_t>(v));
+      };
+      std::string data;
+      word(data, syms.size() * (is64 ? 16 : 8));
+      size_t strx = 0;
+      for (const auto &[s, i] : syms) {
+        word(data, strx);
+        word(data, offsets[i]);
+        strx += s.size() + 1;
+      }
+      word(data, names.size());
+      data += names;
+      if (is64) {
+        member(out, "__.SYMDEF_64", data);
+        break;
+      }
+      std::string symdef("__.SYMDEF SORTED");
+      symdef.resize(20, '\0');
+      member(out, "#1/20", data, symdef);
+    } break;
+    default:
+      break;
+    }
+    // long names: GNU '/\n' terminated, COFF null terminated, BSD in front of data
+    auto isBSD = f == SymbolFormat::BSD || f == SymbolFormat::BSD64;
+    std::string longNames;
+    std::vector<std::string> headerNames;
+    for (const auto &o : objects) {
+      if (isBSD) {
+        headerNames.emplace_back("#1/" + std::to_string(o.name.size()));
+        continue;
+      }
+      if (o.name.size() < 16) {
+        headerNames.emplace_back(o.name + "/");
+        continue;
+      }
+      headerNames.emplace_back("/" + std::to_string(longNames.size()));
+      longNames += o.name;
+      longNames += f == SymbolFormat::COFF ? std::string_view("\0", 1) : std::string_view("/\n");
+    }
+    if (!longNames.empty()) {
+      member(out, "//", longNames);
+    }
+    for (size_t i = 0; i < objects.size(); i++) {
+      offsets[i] = out.size();
+      member(out, headerNames[i], objects[i].data, isBSD ? std::string_view(objects[i].name) : std::string_view());
+    }
+  }
+  return out;
+}
+
+int checkFormat(hazel::ar::SymbolFormat f) {
+  // odd sizes exercise the 2 byte member alignment, 'foo' defined twice: the first definition wins
+  std::vector<object> objects = {
+      {"alpha.o", "\x7f" "ELF alpha", {"foo", "bar"}},
+      {"very_long_object_file_name_1.o", "long member data", {"baz", "_ZN4bela4hash6sha2566HasherE"}},
+      {"c.o", "c", {"qux", "foo"}},
+  };
+  auto image = buildArchive(f, objects);
+  int failed = 0;
+  auto fail = [&](std::wstring_view what) {
+    bela::FPrintF(stderr, L"%s: %s\n", FormatName(f), what);
+    failed++;
+  };
+  hazel::ar::Archive ar;
+  bela::error_code ec;
+  if (!ar.NewArchive(bela::bytes_view(image.data(), image.size()), ec)) {
+    bela::FPrintF(stderr, L"%s: open archive: %s\n", FormatName(f), ec);
+    return 1;
+  }
+  if (ar.Format() != f) {
+    fail(bela::StringCat(L"format detected as ", FormatName(ar.Format())));
+  }
+  for (size_t i = 0; i < objects.size(); i++) {
+    for (const auto &s : objects[i].symbols) {
+      auto want = s == "foo" ? objects[0].name : objects[i].name;
+      auto m = ar.LookupSymbol(s, ec);
+      if (!m) {
+        fail(bela::StringCat(L"symbol ", bela::encode_into<char, wchar_t>(s), L" not found ", ec.message));
+        continue;
+      }
+      if (m->Name != want || ar.MemberData(*m).make_string_view() != objects[s == "foo" ? 0 : i].data) {
+        fail(bela::StringCat(L"symbol ", bela::encode_into<char, wchar_t>(s), L" resolved to ",
+                             bela::encode_into<char, wchar_t>(m->Name)));
+      }
+    }
+  }
+  if (auto m = ar.LookupSymbol("missing", ec); m || ec) {
+    fail(L"missing symbol found");
+  }
+  std::vector<hazel::ar::Member> members;
+  if (!ar.Members(members, ec)) {
+    fail(bela::StringCat(L"members: ", ec.message));
+    return failed;
+  }
+  if (members.size() != objects.size()) {
+    fail(bela::StringCat(L"members ", members.size(), L" want ", objects.size()));
+    return failed;
+  }
+  for (size_t i = 0; i < members.size(); i++) {
+    if (members[i].Name != objects[i].name || ar.MemberData(members[i]).make_string_view() != objects[i].data) {
+      fail(bela::StringCat(L"member ", i, L" is ", bela::encode_into<char, wchar_t>(members[i].Name)));
+    }
+  }
+  return failed;
+}
+
+int listArchive(std::wstring_view path) {
+  hazel::ar::Archive ar;
+  bela::error_code ec;
+  if (!ar.NewArchive(path, ec)) {
+    bela::FPrintF(stderr, L"open archive: %s error %s\n", path, ec);
+    return 1;
+  }
+  bela::FPrintF(stdout, L"%s: %s symbol table, %d symbols\n", path, FormatName(ar.Format()), ar.SymbolCount());
+  std::vector<hazel::ar::Member> members;
+  if (!ar.Members(members, ec)) {
+    bela::FPrintF(stderr, L"list members: %s error %s\n", path, ec);
+    return 1;
+  }
+  for (const auto &m : members) {
+    bela::FPrintF(stdout, L"%08o\t%d\t%s\n", m.Mode, m.Size, m.Name);
+  }
+  return 0;
+}
+} // namespace
+
+int wmain(int argc, wchar_t **argv) {
+  if (argc > 1) {
+    int ret = 0;
+    for (int i = 1; i < argc; i++) {
+      ret |= listArchive(argv[i]);
+    }
+    return ret;
+  }
+  using hazel::ar::SymbolFormat;
+  int failed = 0;
+  for (auto f : {SymbolFormat::GNU, SymbolFormat::GNU64, SymbolFormat::BSD, SymbolFormat::BSD64, SymbolFormat::COFF}) {
+    failed += checkFormat(f);
+  }
+  if (failed != 0) {
+    bela::FPrintF(stderr, L"ar: %d checks failed\n", failed);
+    return 1;
+  }
+  bela::FPrintF(stdout, L"ar: GNU, GNU64, BSD, BSD64 and COFF symbol tables ok\n");
+  return 0;
+}
@@ -393,6 +393,9 @@ int wmain(int argc, wchar_t **argv) {
   if (auto dm = file.LookupDotNetMetadata(ec); dm) {
     bela::FPrintF(stdout, L"CRL Version: %s\n", dm->version);
     bela::FPrintF(stdout, L"Flags: %s\n", dm->flags);
+    for (const auto &a : dm->imports) {
+      bela::FPrintF(stdout, L"AssemblyRef: %s\n", a);
+    }
   }
   auto overlayLen = file.OverlayLength();
   bela::FPrintF(stderr, L"Overlay offset 0x%08x, length: %d\n", file.OverlayOffset(), file.OverlayLength());